@@ -0,0 +1,76 @@
+#ifndef CYCAMORE_BENCH_BENCH_HELPERS_H_
+#define CYCAMORE_BENCH_BENCH_HELPERS_H_
+
+#include "cyclus.h"
+
+namespace cycamore {
+namespace bench {
+
+/// Returns a fixed (mass based) composition of depleted uranium.
+inline cyclus::Composition::Ptr DepletedU() {
+  cyclus::CompMap m;
+  m[922350000] = 0.0025;
+  m[922380000] = 0.9975;
+  return cyclus::Composition::CreateFromMass(m);
+}
+
+/// Returns a fixed (mass based) composition of natural uranium.
+inline cyclus::Composition::Ptr NaturalU() {
+  cyclus::CompMap m;
+  m[922350000] = 0.0072;
+  m[922380000] = 0.9928;
+  return cyclus::Composition::CreateFromMass(m);
+}
+
+/// Returns a (mass based) composition of low enriched uranium of the given
+/// U-235 mass fraction.
+inline cyclus::Composition::Ptr EnrichedU(double enr) {
+  cyclus::CompMap m;
+  m[922350000] = enr;
+  m[922380000] = 1 - enr;
+  return cyclus::Composition::CreateFromMass(m);
+}
+
+/// Returns a fixed (mass based) composition of reactor grade plutonium.
+inline cyclus::Composition::Ptr Plutonium() {
+  cyclus::CompMap m;
+  m[942380000] = 0.02;
+  m[942390000] = 0.53;
+  m[942400000] = 0.25;
+  m[942410000] = 0.13;
+  m[942420000] = 0.07;
+  return cyclus::Composition::CreateFromMass(m);
+}
+
+/// Returns a new (mass based) composition resembling LWR spent fuel at about
+/// 50 MWd/kgHM.  Every call creates a composition with a new id; scale
+/// slightly perturbs the plutonium vector so that compositions differ.
+inline cyclus::Composition::Ptr SpentFuel(double scale = 1) {
+  cyclus::CompMap m;
+  m[922340000] = 0.0002;
+  m[922350000] = 0.0080;
+  m[922360000] = 0.0055;
+  m[922380000] = 0.9190;
+  m[932370000] = 0.0007;
+  m[942380000] = 0.0003 * scale;
+  m[942390000] = 0.0060 * scale;
+  m[942400000] = 0.0026 * scale;
+  m[942410000] = 0.0015 * scale;
+  m[942420000] = 0.0007 * scale;
+  m[952410000] = 0.0006;
+  m[952430000] = 0.0002;
+  m[962440000] = 0.0001;
+  m[551370000] = 0.0018;
+  m[380900000] = 0.0008;
+  m[541360000] = 0.0030;
+  m[601440000] = 0.0040;
+  m[430990000] = 0.0011;
+  m[10010000] = 0.0001;
+  m[80160000] = 0.0010;
+  return cyclus::Composition::CreateFromMass(m);
+}
+
+}  // namespace bench
+}  // namespace cycamore
+
+#endif  // CYCAMORE_BENCH_BENCH_HELPERS_H_
@@ -0,0 +1,99 @@
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "enrichment_tests.h"
+
+#include "bench_helpers.h"
+
+namespace cycamore {
+namespace bench {
+
+/// EnrichmentBench sets up an Enrichment facility the way the unit tests do,
+/// through the EnrichmentTest fixture, with a large feed inventory and SWU
+/// capacity so that any request can be filled.
+class EnrichmentBench : public EnrichmentTest {
+ public:
+  EnrichmentBench() {
+    SetUp();
+    src_facility->SetMaxInventorySize(1e9);
+    src_facility->SwuCapacity(1e9);
+    DoAddMat(GetMat(1000));
+  }
+
+  virtual ~EnrichmentBench() { TearDown(); }
+
+  virtual void TestBody() {}
+
+  Enrichment* facility() { return src_facility; }
+
+  TestFacility* requester() { return trader; }
+
+  const std::string& product() const { return product_commod; }
+
+  /// Calls Enrichment::Enrich_ through the fixture.
+  cyclus::Material::Ptr Enrich(cyclus::Material::Ptr mat, double qty) {
+    return DoEnrich(mat, qty);
+  }
+
+  /// Adds qty kg of feed to the inventory.
+  void AddFeed(double qty) { DoAddMat(GetMat(qty)); }
+
+  /// Returns the natural uranium feed needed for qty kg of product of the
+  /// given enrichment.
+  double FeedQty(double qty, double enr) {
+    cyclus::toolkit::Assays assays(feed_assay, enr, tails_assay);
+    return cyclus::toolkit::FeedQty(qty, assays);
+  }
+};
+
+// One Enrich_ call for 10 kg of 4% LEU.  The feed used is topped up (and the
+// time step's records flushed every 1000 calls) outside of the timed region.
+static void BM_Enrich(benchmark::State& state) {
+  EnrichmentBench b;
+  double qty = 10;
+  cyclus::Material::Ptr prod =
+      cyclus::Material::CreateUntracked(qty, EnrichedU(0.04));
+  double feed = b.FeedQty(qty, 0.04);
+
+  int n = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b.Enrich(prod, qty));
+    state.PauseTiming();
+    b.AddFeed(feed);
+    if (++n % 1000 == 0) {
+      b.facility()->Tock();
+    }
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_Enrich);
+
+// GetMatlBids for state.range(0) product requests of a few different
+// enrichments.
+static void BM_EnrichmentGetMatlBids(benchmark::State& state) {
+  using cyclus::Material;
+  using cyclus::Request;
+
+  EnrichmentBench b;
+  cyclus::ExchangeContext<Material> ec;
+  std::vector<cyclus::Composition::Ptr> comps;
+  for (int i = 0; i < 4; i++) {
+    comps.push_back(EnrichedU(0.03 + 0.01 * i));
+  }
+  for (int i = 0; i < state.range(0); i++) {
+    Material::Ptr target =
+        Material::CreateUntracked(1, comps[i % comps.size()]);
+    ec.AddRequest(Request<Material>::Create(target, b.requester(),
+                                            b.product()));
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b.facility()->GetMatlBids(ec.commod_requests));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EnrichmentGetMatlBids)->RangeMultiplier(8)->Range(1, 4096);
+
+}  // namespace bench
+}  // namespace cycamore
@@ -0,0 +1,276 @@
+#include <sstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "source_tests.h"
+
+#include "bench_helpers.h"
+
+namespace cycamore {
+namespace bench {
+
+// Full request/bid/trade cycles: each iteration runs a short MockSim of one
+// archetype trading with state.range(0) synthetic partners, including
+// setting up and tearing down the simulation and its database.
+
+static const int kSimDur = 10;
+
+// one Source supplying N sinks
+static void BM_SourceExchange(benchmark::State& state) {
+  std::string config =
+      "<outcommod>fuel</outcommod>"
+      "<outrecipe>leu</outrecipe>";
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Source"), config,
+                        kSimDur);
+    sim.AddRecipe("leu", EnrichedU(0.04));
+    for (int i = 0; i < state.range(0); i++) {
+      sim.AddSink("fuel").capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_SourceExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+// one Sink supplied by N sources
+static void BM_SinkExchange(benchmark::State& state) {
+  std::string config =
+      "<in_commods><val>fuel</val></in_commods>"
+      "<capacity>1e6</capacity>";
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Sink"), config, kSimDur);
+    sim.AddRecipe("leu", EnrichedU(0.04));
+    for (int i = 0; i < state.range(0); i++) {
+      sim.AddSource("fuel").recipe("leu").capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_SinkExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+// one Enrichment facility filling N product requests of a few enrichments
+static void BM_EnrichmentExchange(benchmark::State& state) {
+  std::string config =
+      "<feed_commod>natu</feed_commod>"
+      "<feed_recipe>natu</feed_recipe>"
+      "<product_commod>enr_u</product_commod>"
+      "<tails_commod>tails</tails_commod>"
+      "<tails_assay>0.003</tails_assay>"
+      "<initial_feed>1e6</initial_feed>"
+      "<swu_capacity>1e6</swu_capacity>";
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Enrichment"), config,
+                        kSimDur);
+    sim.AddRecipe("natu", NaturalU());
+    for (int i = 0; i < 4; i++) {
+      std::stringstream name;
+      name << "leu" << i;
+      sim.AddRecipe(name.str(), EnrichedU(0.03 + 0.01 * i));
+    }
+    for (int i = 0; i < state.range(0); i++) {
+      std::stringstream name;
+      name << "leu" << i % 4;
+      sim.AddSink("enr_u").recipe(name.str()).capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_EnrichmentExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+// one Reactor with a core of N assemblies, reloaded every time step from N
+// sources and discharging to N sinks
+static void BM_ReactorExchange(benchmark::State& state) {
+  std::stringstream config;
+  config << "<fuel_inrecipes>  <val>fresh</val>  </fuel_inrecipes>"
+         << "<fuel_outrecipes> <val>spent</val>  </fuel_outrecipes>"
+         << "<fuel_incommods>  <val>fuel</val>   </fuel_incommods>"
+         << "<fuel_outcommods> <val>waste</val>  </fuel_outcommods>"
+         << "<cycle_time>1</cycle_time>"
+         << "<refuel_time>0</refuel_time>"
+         << "<assem_size>1</assem_size>"
+         << "<n_assem_core>" << state.range(0) << "</n_assem_core>"
+         << "<n_assem_batch>" << state.range(0) << "</n_assem_batch>";
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config.str(),
+                        kSimDur);
+    sim.AddRecipe("fresh", EnrichedU(0.04));
+    sim.AddRecipe("spent", SpentFuel());
+    for (int i = 0; i < state.range(0); i++) {
+      sim.AddSource("fuel").recipe("fresh").capacity(1).Finalize();
+      sim.AddSink("waste").capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_ReactorExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+// one Separations facility fed by N sources, its uranium and plutonium
+// streams and its leftovers going to N sinks
+static void BM_SeparationsExchange(benchmark::State& state) {
+  std::string config =
+      "<streams>"
+      "  <item>"
+      "    <commod>sep_u</commod>"
+      "    <info>"
+      "      <buf_size>-1</buf_size>"
+      "      <efficiencies><item><comp>U</comp><eff>0.999</eff></item>"
+      "      </efficiencies>"
+      "    </info>"
+      "  </item>"
+      "  <item>"
+      "    <commod>sep_pu</commod>"
+      "    <info>"
+      "      <buf_size>-1</buf_size>"
+      "      <efficiencies><item><comp>Pu</comp><eff>0.998</eff></item>"
+      "      </efficiencies>"
+      "    </info>"
+      "  </item>"
+      "</streams>"
+      "<leftover_commod>sep_waste</leftover_commod>"
+      "<throughput>1e6</throughput>"
+      "<feedbuf_size>1e6</feedbuf_size>"
+      "<feed_commods><val>spent</val></feed_commods>";
+  const char* outs[] = {"sep_u", "sep_pu", "sep_waste"};
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), config,
+                        kSimDur);
+    sim.AddRecipe("spent", SpentFuel());
+    for (int i = 0; i < state.range(0); i++) {
+      sim.AddSource("spent").recipe("spent").capacity(1).Finalize();
+      sim.AddSink(outs[i % 3]).capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_SeparationsExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+// one FuelFab mixing natural uranium and plutonium for N sinks requesting
+// fuel of a few enrichments
+static void BM_FuelFabExchange(benchmark::State& state) {
+  std::string config =
+      "<fill_commods><val>natu</val></fill_commods>"
+      "<fill_recipe>natu</fill_recipe>"
+      "<fill_size>1e6</fill_size>"
+      "<fiss_commods><val>pu</val></fiss_commods>"
+      "<fiss_recipe>pu</fiss_recipe>"
+      "<fiss_size>1e6</fiss_size>"
+      "<outcommod>fuel</outcommod>"
+      "<spectrum>thermal</spectrum>"
+      "<throughput>1e6</throughput>";
+  cyclus::Env::SetNucDataPath();
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:FuelFab"), config,
+                        kSimDur);
+    sim.AddRecipe("natu", NaturalU());
+    sim.AddRecipe("pu", Plutonium());
+    for (int i = 0; i < 4; i++) {
+      std::stringstream name;
+      name << "leu" << i;
+      sim.AddRecipe(name.str(), EnrichedU(0.03 + 0.01 * i));
+    }
+    sim.AddSource("natu").recipe("natu").Finalize();
+    sim.AddSource("pu").recipe("pu").Finalize();
+    for (int i = 0; i < state.range(0); i++) {
+      std::stringstream name;
+      name << "leu" << i % 4;
+      sim.AddSink("fuel").recipe(name.str()).capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_FuelFabExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+// one Mixer mixing two streams, each fed by N sources, for N sinks
+static void BM_MixerExchange(benchmark::State& state) {
+  std::string config =
+      "<in_streams>"
+      "  <stream>"
+      "    <info><mixing_ratio>0.9</mixing_ratio><buf_size>1e6</buf_size>"
+      "    </info>"
+      "    <commodities><item><commodity>natu</commodity><pref>1</pref>"
+      "    </item></commodities>"
+      "  </stream>"
+      "  <stream>"
+      "    <info><mixing_ratio>0.1</mixing_ratio><buf_size>1e6</buf_size>"
+      "    </info>"
+      "    <commodities><item><commodity>pu</commodity><pref>1</pref>"
+      "    </item></commodities>"
+      "  </stream>"
+      "</in_streams>"
+      "<out_commod>mixed</out_commod>"
+      "<outputbuf_size>1e6</outputbuf_size>"
+      "<throughput>1e6</throughput>";
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Mixer"), config,
+                        kSimDur);
+    sim.AddRecipe("natu", NaturalU());
+    sim.AddRecipe("pu", Plutonium());
+    for (int i = 0; i < state.range(0); i++) {
+      sim.AddSource("natu").recipe("natu").capacity(0.9).Finalize();
+      sim.AddSource("pu").recipe("pu").capacity(0.1).Finalize();
+      sim.AddSink("mixed").capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_MixerExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+// one Storage facility holding material from N sources for a time step
+// before passing it on to N sinks
+static void BM_StorageExchange(benchmark::State& state) {
+  std::string config =
+      "<in_commods><val>spent</val></in_commods>"
+      "<out_commods><val>stored</val></out_commods>"
+      "<residence_time>1</residence_time>";
+  for (auto _ : state) {
+    cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Storage"), config,
+                        kSimDur);
+    sim.AddRecipe("spent", SpentFuel());
+    for (int i = 0; i < state.range(0); i++) {
+      sim.AddSource("spent").recipe("spent").capacity(1).Finalize();
+      sim.AddSink("stored").capacity(1).Finalize();
+    }
+    benchmark::DoNotOptimize(sim.Run());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSimDur);
+}
+BENCHMARK(BM_StorageExchange)
+    ->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond);
+
+/// SourceBench sets up a Source facility through the SourceTest fixture.
+class SourceBench : public SourceTest {
+ public:
+  SourceBench() { SetUp(); }
+  virtual ~SourceBench() { TearDown(); }
+  virtual void TestBody() {}
+};
+
+// Source::GetMatlBids alone for N requests of the same quantity
+static void BM_SourceGetMatlBids(benchmark::State& state) {
+  SourceBench b;
+  boost::shared_ptr<cyclus::ExchangeContext<cyclus::Material> > ec =
+      b.GetContext(state.range(0), b.commod);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(b.src_facility->GetMatlBids(ec->commod_requests));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SourceGetMatlBids)->RangeMultiplier(8)->Range(1, 4096);
+
+}  // namespace bench
+}  // namespace cycamore
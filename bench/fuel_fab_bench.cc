@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+
+#include "fuel_fab.h"
+
+#include "bench_helpers.h"
+
+namespace cycamore {
+namespace bench {
+
+// CosiWeight on a composition seen before - the per-spectrum nuclide table is
+// warm, so this measures the merge-join against the atom fractions.
+static void BM_CosiWeight(benchmark::State& state) {
+  cyclus::Composition::Ptr c = SpentFuel();
+  CosiWeight(c, "thermal");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(CosiWeight(c, "thermal"));
+  }
+}
+BENCHMARK(BM_CosiWeight);
+
+// CosiWeight on a new composition every iteration, as for freshly mixed
+// fuel.  Includes building the composition.
+static void BM_CosiWeightNewComp(benchmark::State& state) {
+  double scale = 1;
+  for (auto _ : state) {
+    scale += 1e-6;
+    benchmark::DoNotOptimize(CosiWeight(SpentFuel(scale), "thermal"));
+  }
+}
+BENCHMARK(BM_CosiWeightNewComp);
+
+// The memoized CosiWeight lookup used by FuelFab's converters.
+static void BM_CosiWeightCache(benchmark::State& state) {
+  CosiWeightCache::Clear();
+  cyclus::Composition::Ptr c = SpentFuel();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(CosiWeightCache::Get(c, "thermal"));
+  }
+  CosiWeightCache::Clear();
+}
+BENCHMARK(BM_CosiWeightCache);
+
+static void BM_AtomToMassFrac(benchmark::State& state) {
+  cyclus::Composition::Ptr fiss = SpentFuel();
+  cyclus::Composition::Ptr fill = DepletedU();
+  double frac = 0;
+  for (auto _ : state) {
+    frac = frac < 0.9 ? frac + 1e-3 : 0;
+    benchmark::DoNotOptimize(AtomToMassFrac(frac, fiss, fill));
+  }
+}
+BENCHMARK(BM_AtomToMassFrac);
+
+}  // namespace bench
+}  // namespace cycamore
@@ -0,0 +1,64 @@
+#include <map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "separations.h"
+
+#include "bench_helpers.h"
+
+namespace cycamore {
+namespace bench {
+
+// element efficiencies of a typical three stream reprocessing plant
+static std::vector<std::map<int, double> > StreamEffs() {
+  std::vector<std::map<int, double> > effs(3);
+  effs[0][920000000] = 0.999;  // uranium
+  effs[1][940000000] = 0.998;  // plutonium
+  effs[2][930000000] = 0.95;  // minor actinides
+  effs[2][950000000] = 0.95;
+  effs[2][960000000] = 0.95;
+  return effs;
+}
+
+// SepMaterial for every stream of one feed material.
+static void BM_SepMaterial(benchmark::State& state) {
+  std::vector<std::map<int, double> > effs = StreamEffs();
+  cyclus::Material::Ptr feed =
+      cyclus::Material::CreateUntracked(1000, SpentFuel());
+  for (auto _ : state) {
+    for (int i = 0; i < effs.size(); i++) {
+      benchmark::DoNotOptimize(SepMaterial(effs[i], feed));
+    }
+  }
+}
+BENCHMARK(BM_SepMaterial);
+
+// SepEffTable::Separate over a cycle of state.range(0) distinct feed
+// compositions with an LRU cache of state.range(1) entries - a cache smaller
+// than the cycle misses every time.
+static void BM_SepEffTable(benchmark::State& state) {
+  SepEffTable table;
+  table.Init(StreamEffs());
+  table.cache_size(state.range(1));
+  std::vector<cyclus::Composition::Ptr> comps;
+  for (int i = 0; i < state.range(0); i++) {
+    comps.push_back(SpentFuel(1 + 0.01 * i));
+  }
+
+  int i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.Separate(comps[i]));
+    i = (i + 1) % comps.size();
+  }
+  state.counters["hit_rate"] =
+      table.hits() / static_cast<double>(table.hits() + table.misses());
+}
+BENCHMARK(BM_SepEffTable)
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Args({16, 8})
+    ->Args({16, 16});
+
+}  // namespace bench
+}  // namespace cycamore
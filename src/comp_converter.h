@@ -0,0 +1,45 @@
+#ifndef CYCAMORE_SRC_COMP_CONVERTER_H_
+#define CYCAMORE_SRC_COMP_CONVERTER_H_
+
+#include "cyclus.h"
+
+namespace cycamore {
+
+/// CompConverter counts the quantity of the offers of a single composition
+/// toward a capacity constraint and ignores all other offers.  A bid
+/// portfolio offering several groups of materials (e.g. spent fuel grouped by
+/// composition) can so cap each group at the quantity it holds, in addition
+/// to the portfolio's overall capacity.
+///
+///   cyclus::Converter<cyclus::Material>::Ptr conv(new CompConverter(comp));
+///   port->AddConstraint(
+///       cyclus::CapacityConstraint<cyclus::Material>(qty, conv));
+class CompConverter : public cyclus::Converter<cyclus::Material> {
+ public:
+  /// @param c the composition whose offers are counted
+  explicit CompConverter(cyclus::Composition::Ptr c) : comp_(c) {}
+  virtual ~CompConverter() {}
+
+  /// @return the offer's quantity if it has the converter's composition,
+  /// zero otherwise
+  virtual double convert(
+      cyclus::Material::Ptr m,
+      cyclus::Arc const * a = NULL,
+      cyclus::ExchangeTranslationContext<cyclus::Material>
+          const * ctx = NULL) const {
+    return m->comp()->id() == comp_->id() ? m->quantity() : 0;
+  }
+
+  /// @returns true if Converter is a CompConverter of the same composition
+  virtual bool operator==(Converter& other) const {
+    CompConverter* cast = dynamic_cast<CompConverter*>(&other);
+    return cast != NULL && cast->comp_->id() == comp_->id();
+  }
+
+ private:
+  cyclus::Composition::Ptr comp_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_COMP_CONVERTER_H_
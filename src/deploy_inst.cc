@@ -1,10 +1,18 @@
 // Implements the DeployInst class
 #include "deploy_inst.h"
 
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
 namespace cycamore {
 
 DeployInst::DeployInst(cyclus::Context* ctx)
     : cyclus::Institution(ctx),
+      schedule_window(0),
+      schedule_lines(0),
+      sched_lineno_(0),
+      has_next_(false),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {}
@@ -13,37 +21,128 @@ DeployInst::~DeployInst() {}
 
 void DeployInst::Build(cyclus::Agent* parent) {
   cyclus::Institution::Build(parent);
-  BuildSched::iterator it;
-  std::set<std::string> protos;
+  bool has_lifetimes = lifetimes.size() == prototypes.size();
   for (int i = 0; i < prototypes.size(); i++) {
-    std::string proto = prototypes[i];
+    Schedule_(prototypes[i], build_times[i], n_build[i], has_lifetimes,
+              has_lifetimes ? lifetimes[i] : 0);
+  }
+
+  if (!schedule_file.empty()) {
+    ScheduleFile_(context()->time() + 1 + schedule_window);
+  }
+}
+
+void DeployInst::Tick() {
+  CYCAMORE_PERF_SCOPE("Tick");
+  if (!schedule_file.empty()) {
+    ScheduleFile_(context()->time() + 1 + schedule_window);
+  }
+}
 
+void DeployInst::Schedule_(std::string proto, int t, int n, bool has_lifetime,
+                           int lifetime) {
+  if (has_lifetime && BaseLifetime_(proto) != lifetime) {
     std::stringstream ss;
     ss << proto;
-
-    if (lifetimes.size() == prototypes.size()) {
+    if (lifetime == -1) {
+      ss << "_life_forever";
+    } else {
+      ss << "_life_" << lifetime;
+    }
+    std::string name = ss.str();
+    if (lifetime_protos.count(name) == 0) {
       cyclus::Agent* a = context()->CreateAgent<Agent>(proto);
-      if (a->lifetime() != lifetimes[i]) {
-        a->lifetime(lifetimes[i]);
-
-        if (lifetimes[i] == -1) {
-          ss << "_life_forever";
-        } else {
-          ss << "_life_" << lifetimes[i];
-        }
-        proto = ss.str();
-        if (protos.count(proto) == 0) {
-          protos.insert(proto);
-          context()->AddPrototype(proto, a);
-        }
-      }
+      a->lifetime(lifetime);
+      context()->AddPrototype(name, a);
+      lifetime_protos.insert(name);
+    }
+    proto = name;
+  }
+
+  for (int j = 0; j < n; j++) {
+    context()->SchedBuild(this, proto, t);
+  }
+}
+
+int DeployInst::BaseLifetime_(const std::string& proto) {
+  std::map<std::string, int>::iterator it = base_lifetimes_.find(proto);
+  if (it == base_lifetimes_.end()) {
+    // the clone is only needed to read the prototype's lifetime
+    cyclus::Agent* a = context()->CreateAgent<Agent>(proto);
+    it = base_lifetimes_.insert(std::make_pair(proto, a->lifetime())).first;
+    context()->DelAgent(a);
+  }
+  return it->second;
+}
+
+void DeployInst::ScheduleFile_(int until) {
+  if (!sched_in_.is_open()) {
+    sched_in_.open(schedule_file.c_str());
+    if (!sched_in_.is_open()) {
+      throw cyclus::IOError("prototype '" + prototype() + "' could not open "
+                            "schedule_file '" + schedule_file + "'");
+    }
+    sched_lineno_ = 0;
+    next_.time = 0;
+    // entries scheduled before a restart are already in the build queue
+    for (int i = 0; i < schedule_lines && ReadEntry_(); i++) {}
+    has_next_ = ReadEntry_();
+  }
+
+  while (has_next_ && next_.time <= until) {
+    Schedule_(next_.prototype, next_.time, next_.n, next_.has_lifetime,
+              next_.lifetime);
+    schedule_lines++;
+    has_next_ = ReadEntry_();
+  }
+}
+
+bool DeployInst::ReadEntry_() {
+  std::string line;
+  while (std::getline(sched_in_, line)) {
+    sched_lineno_++;
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == std::string::npos || line[start] == '#') {
+      continue;
     }
 
-    int t = build_times[i];
-    for (int j = 0; j < n_build[i]; j++) {
-      context()->SchedBuild(this, proto, t);
+    std::vector<std::string> fields;
+    std::stringstream fs(line);
+    std::string field;
+    while (std::getline(fs, field, ',')) {
+      size_t b = field.find_first_not_of(" \t\r");
+      size_t e = field.find_last_not_of(" \t\r");
+      fields.push_back(b == std::string::npos ? "" :
+                       field.substr(b, e - b + 1));
     }
+
+    std::stringstream ss;
+    ss << "prototype '" << prototype() << "' schedule_file '" << schedule_file
+       << "' line " << sched_lineno_ << ": ";
+    if (fields.size() < 3 || fields.size() > 4) {
+      ss << "expected 3 or 4 fields, got " << fields.size();
+      throw cyclus::ValueError(ss.str());
+    }
+
+    int prev_time = next_.time;
+    try {
+      next_.prototype = fields[0];
+      next_.time = boost::lexical_cast<int>(fields[1]);
+      next_.n = boost::lexical_cast<int>(fields[2]);
+      next_.has_lifetime = fields.size() == 4;
+      next_.lifetime = next_.has_lifetime ?
+                       boost::lexical_cast<int>(fields[3]) : 0;
+    } catch (boost::bad_lexical_cast& e) {
+      ss << "build time, number and lifetime must be integers";
+      throw cyclus::ValueError(ss.str());
+    }
+    if (next_.time < prev_time) {
+      ss << "entries must be sorted by build time";
+      throw cyclus::ValueError(ss.str());
+    }
+    return true;
   }
+  return false;
 }
 
 void DeployInst::EnterNotify() {
@@ -64,6 +163,10 @@ void DeployInst::EnterNotify() {
     ss << "prototype '" << prototype() << "' has " << lifetimes.size()
        << " lifetimes vals, expected " << n;
     throw cyclus::ValueError(ss.str());
+  } else if (schedule_window < 0) {
+    std::stringstream ss;
+    ss << "prototype '" << prototype() << "' has a negative schedule_window";
+    throw cyclus::ValueError(ss.str());
   }
   RecordPosition();
 }
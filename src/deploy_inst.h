@@ -1,12 +1,14 @@
 #ifndef CYCAMORE_SRC_DEPLOY_INST_H_
 #define CYCAMORE_SRC_DEPLOY_INST_H_
 
+#include <fstream>
 #include <utility>
 #include <set>
 #include <map>
 
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
 
 namespace cycamore {
 
@@ -45,11 +47,16 @@ class DeployInst : public cyclus::Institution,
 
   virtual void EnterNotify();
 
+  /// schedules the builds of schedule_file entering within the schedule
+  /// window
+  virtual void Tick();
+
  protected:
   #pragma cyclus var { \
     "doc": "Ordered list of prototypes to build.", \
     "uitype": ("oneormore", "prototype"), \
     "uilabel": "Prototypes to deploy", \
+    "default": [], \
   }
   std::vector<std::string> prototypes;
 
@@ -57,6 +64,7 @@ class DeployInst : public cyclus::Institution,
     "doc": "Time step on which to deploy agents given in prototype list " \
            "(same order).",						\
     "uilabel": "Deployment times",					\
+    "default": [], \
   }
   std::vector<int> build_times;
 
@@ -64,6 +72,7 @@ class DeployInst : public cyclus::Institution,
     "doc": "Number of each prototype given in prototype list that should be " \
            "deployed (same order).", \
     "uilabel": "Number to deploy", \
+    "default": [], \
   }
   std::vector<int> n_build;
 
@@ -83,7 +92,69 @@ class DeployInst : public cyclus::Institution,
   }
   std::vector<int> lifetimes;
 
+  #pragma cyclus var { \
+    "default": "", \
+    "uilabel": "Deployment schedule file", \
+    "doc": "Path of a CSV file with further builds, one entry per line as " \
+           "'prototype,build time,number to build[,lifetime]'. Entries must " \
+           "be sorted by build time; empty lines and lines starting with " \
+           "'#' are skipped. The file is read incrementally and builds are " \
+           "only scheduled schedule_window time steps ahead, so large " \
+           "schedules are neither held in memory nor queued in full.", \
+  }
+  std::string schedule_file;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Deployment schedule window", \
+    "units": "time steps", \
+    "doc": "How many time steps ahead (beyond the next one) builds read " \
+           "from schedule_file are scheduled.", \
+  }
+  int schedule_window;
+
+  /// the number of schedule_file entries already scheduled
+  #pragma cyclus var {"default": 0, "internal": True}
+  int schedule_lines;
+
+  /// lifetime-modified prototypes already added to the context
+  #pragma cyclus var {"default": [], "internal": True}
+  std::set<std::string> lifetime_protos;
+
  private:
+  /// a build entry of the schedule file
+  struct Entry {
+    std::string prototype;
+    int time;
+    int n;
+    bool has_lifetime;
+    int lifetime;
+  };
+
+  /// schedules n builds of proto at t, overriding the prototype's lifetime
+  /// if has_lifetime is set
+  void Schedule_(std::string proto, int t, int n, bool has_lifetime,
+                 int lifetime);
+
+  /// schedules the entries of schedule_file with build times up to until,
+  /// opening the file (and skipping the entries already scheduled) if needed
+  void ScheduleFile_(int until);
+
+  /// reads the next schedule_file entry into next_
+  /// @return false at the end of the file
+  bool ReadEntry_();
+
+  std::ifstream sched_in_;
+  int sched_lineno_;
+  bool has_next_;
+  Entry next_;
+
+  /// @return the lifetime of prototype proto
+  int BaseLifetime_(const std::string& proto);
+
+  /// the lifetime of each prototype scheduled with a lifetime
+  std::map<std::string, int> base_lifetimes_;
+
   #pragma cyclus var { \
     "default": 0.0, \
     "uilabel": "Geographical latitude in degrees as a double", \
@@ -104,6 +175,11 @@ class DeployInst : public cyclus::Institution,
 
   /// Records an agent's latitude and longitude to the output db
   void RecordPosition();
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 }  // namespace cycamore
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+
 #include "context.h"
 #include "deploy_inst.h"
 #include "institution_tests.h"
@@ -177,6 +180,95 @@ TEST(DeployInstTests, PositionInitialize2) {
   EXPECT_EQ(qr.GetVal<double>("Longitude"), -20.0);
 }
 
+// builds read from a schedule file are deployed just like inline ones
+TEST(DeployInstTests, RepeatedLifetimes) {
+  std::string config =
+     "<prototypes>  <val>foobar</val> <val>foobar</val> <val>foobar</val> </prototypes>"
+     "<build_times> <val>1</val>      <val>2</val>      <val>3</val>      </build_times>"
+     "<n_build>     <val>2</val>      <val>1</val>      <val>3</val>      </n_build>"
+     "<lifetimes>   <val>2</val>      <val>2</val>      <val>2</val>      </lifetimes>"
+     ;
+
+  int simdur = 5;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:DeployInst"), config, simdur);
+  sim.DummyProto("foobar");
+  int id = sim.Run();
+
+  // a lifetime repeated over several build times adds a single prototype
+  cyclus::SqlStatement::Ptr stmt = sim.db().db().Prepare(
+      "SELECT COUNT(*) FROM Prototypes WHERE Prototype = 'foobar_life_2';"
+      );
+  stmt->Step();
+  EXPECT_EQ(1, stmt->GetInt(0));
+
+  stmt = sim.db().db().Prepare(
+      "SELECT COUNT(*) FROM AgentEntry WHERE Prototype = 'foobar' AND Lifetime = 2;"
+      );
+  stmt->Step();
+  EXPECT_EQ(6, stmt->GetInt(0));
+}
+
+TEST(DeployInstTests, ScheduleFile) {
+  std::string fname = "deploy_inst_schedule.csv";
+  std::ofstream f(fname.c_str());
+  f << "# prototype,build time,number[,lifetime]\n"
+    << "foobar, 1, 2\n"
+    << "\n"
+    << "foobar, 3, 4, 2\n"
+    << "foobar, 4, 1\n";
+  f.close();
+
+  std::string config =
+     "<prototypes>  <val>foobar</val> </prototypes>"
+     "<build_times> <val>1</val>      </build_times>"
+     "<n_build>     <val>1</val>      </n_build>"
+     "<schedule_file>" + fname + "</schedule_file>"
+     ;
+
+  int simdur = 5;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:DeployInst"), config, simdur);
+  sim.DummyProto("foobar");
+  int id = sim.Run();
+
+  cyclus::SqlStatement::Ptr stmt = sim.db().db().Prepare(
+      "SELECT COUNT(*) FROM AgentEntry WHERE Prototype = 'foobar' AND EnterTime = 1;"
+      );
+  stmt->Step();
+  EXPECT_EQ(3, stmt->GetInt(0));
+
+  stmt = sim.db().db().Prepare(
+      "SELECT COUNT(*) FROM AgentEntry WHERE Prototype = 'foobar' AND EnterTime = 3 AND Lifetime = 2;"
+      );
+  stmt->Step();
+  EXPECT_EQ(4, stmt->GetInt(0));
+
+  stmt = sim.db().db().Prepare(
+      "SELECT COUNT(*) FROM AgentEntry WHERE Prototype = 'foobar' AND EnterTime = 4;"
+      );
+  stmt->Step();
+  EXPECT_EQ(1, stmt->GetInt(0));
+  std::remove(fname.c_str());
+}
+
+TEST(DeployInstTests, UnsortedScheduleFile) {
+  std::string fname = "deploy_inst_unsorted.csv";
+  std::ofstream f(fname.c_str());
+  f << "foobar,3,1\n"
+    << "foobar,1,1\n";
+  f.close();
+
+  std::string config =
+     "<schedule_file>" + fname + "</schedule_file>"
+     "<schedule_window>5</schedule_window>"
+     ;
+
+  int simdur = 5;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:DeployInst"), config, simdur);
+  sim.DummyProto("foobar");
+  EXPECT_THROW(sim.Run(), cyclus::ValueError);
+  std::remove(fname.c_str());
+}
+
 // required to get functionality in cyclus agent unit tests library
 cyclus::Agent* DeployInstitutionConstructor(cyclus::Context* ctx) {
   return new cycamore::DeployInst(ctx);
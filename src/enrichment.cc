@@ -11,18 +11,31 @@
 
 namespace cycamore {
 
+static const char* const kEnrichmentCols[] = {"AgentId", "Time",
+                                              "Natural_Uranium", "SWU"};
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Enrichment::Enrichment(cyclus::Context* ctx)
     : cyclus::Facility(ctx),
-      tails_assay(0),
-      swu_capacity(0),
-      max_enrich(1),
-      initial_feed(0),
       feed_commod(""),
       feed_recipe(""),
       product_commod(""),
       tails_commod(""),
+      tails_assay(0),
+      tails_compact_tol(-1),
+      initial_feed(0),
+      max_enrich(1),
       order_prefs(true),
+      swu_capacity(0),
+      inventory_view_(&inventory),
+      tails_view_(&tails),
+      inv_u235_(0),
+      inv_u238_(0),
+      inv_qty_(-1),
+      enrichments_("Enrichments", kEnrichmentCols),
+      record_mode("all"),
+      record_interval(1),
+      memory_interval(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {}
@@ -48,8 +61,8 @@ void Enrichment::Build(cyclus::Agent* parent) {
 
   Facility::Build(parent);
   if (initial_feed > 0) {
-    inventory.Push(Material::Create(this, initial_feed,
-                                    context()->GetRecipe(feed_recipe)));
+    inventory_view_.Push(Material::Create(this, initial_feed,
+                                          context()->GetRecipe(feed_recipe)));
   }
 
   LOG(cyclus::LEV_DEBUG2, "EnrFac") << "Enrichment "
@@ -58,27 +71,49 @@ void Enrichment::Build(cyclus::Agent* parent) {
   RecordPosition();
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Enrichment::EnterNotify() {
+  cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  memory_.Init(memory_interval);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Enrichment::Tick() {
+  CYCAMORE_PERF_SCOPE("Tick");
   current_swu_capacity = SwuCapacity();
 
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Enrichment::Tock() {
-  using cyclus::toolkit::RecordTimeSeries;
+  CYCAMORE_PERF_SCOPE("Tock");
   LOG(cyclus::LEV_INFO4, "EnrFac") << prototype() << " used "
                                    << intra_timestep_swu_ << " SWU";
-  RecordTimeSeries<cyclus::toolkit::ENRICH_SWU>(this, intra_timestep_swu_);
+  record_policy_.TimeSeries<cyclus::toolkit::ENRICH_SWU>(
+      this, intra_timestep_swu_);
   LOG(cyclus::LEV_INFO4, "EnrFac") << prototype() << " used "
                                    << intra_timestep_feed_ << " feed";
-  RecordTimeSeries<cyclus::toolkit::ENRICH_FEED>(this, intra_timestep_feed_);
-  RecordTimeSeries<double>("demand"+feed_commod, this, intra_timestep_feed_);
+  record_policy_.TimeSeries<cyclus::toolkit::ENRICH_FEED>(
+      this, intra_timestep_feed_);
+  record_policy_.TimeSeries("demand"+feed_commod, this, intra_timestep_feed_);
+  record_policy_.Flush(this);
+  if (tails_compact_tol >= 0) {
+    tails_view_.Compact(tails_compact_tol);
+  }
+  if (memory_.Due(context()->time())) {
+    memory_.Add("inventory", inventory);
+    memory_.Add("tails", tails);
+    memory_.Flush(this);
+  }
+  enrichments_.Flush(context());
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
 Enrichment::GetMatlRequests() {
+  CYCAMORE_PERF_SCOPE("GetMatlRequests");
   using cyclus::Material;
   using cyclus::RequestPortfolio;
   using cyclus::Request;
@@ -99,23 +134,12 @@ Enrichment::GetMatlRequests() {
   return ports;
 }
 
-// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-bool SortBids(cyclus::Bid<cyclus::Material>* i,
-              cyclus::Bid<cyclus::Material>* j) {
-  cyclus::Material::Ptr mat_i = i->offer();
-  cyclus::Material::Ptr mat_j = j->offer();
-
-  cyclus::toolkit::MatQuery mq_i(mat_i);
-  cyclus::toolkit::MatQuery mq_j(mat_j);
-
-  return ((mq_i.mass(922350000) / mq_i.qty()) <=
-          (mq_j.mass(922350000) / mq_j.qty()));
-}
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // Sort offers of input material to have higher preference for more
 //  U-235 content
 void Enrichment::AdjustMatlPrefs(
     cyclus::PrefMap<cyclus::Material>::type& prefs) {
+  CYCAMORE_PERF_SCOPE("AdjustMatlPrefs");
   using cyclus::Bid;
   using cyclus::Material;
   using cyclus::Request;
@@ -124,44 +148,77 @@ void Enrichment::AdjustMatlPrefs(
     return;
   }
 
+  // U-235 mass fraction of each bid offer - computed once per exchange no
+  // matter how many requests see the bid.
+  std::map<Bid<Material>*, double> u235_fracs;
+
+  // Requests frequently see exactly the same set of bids (e.g. all of the
+  // feed sources for a commodity), so the preferences assigned to a bid set
+  // are reused.  They are stored by position in the bid set, which is ordered
+  // by bid pointer just like the PrefMap entries.
+  std::map<std::vector<Bid<Material>*>, std::vector<double> > orders;
+
   cyclus::PrefMap<cyclus::Material>::type::iterator reqit;
+  std::map<Bid<Material>*, double>::iterator mit;
 
   // Loop over all requests
   for (reqit = prefs.begin(); reqit != prefs.end(); ++reqit) {
-    std::vector<Bid<Material>*> bids_vector;
-    std::map<Bid<Material>*, double>::iterator mit;
+    std::vector<Bid<Material>*> bids;
+    bids.reserve(reqit->second.size());
     for (mit = reqit->second.begin(); mit != reqit->second.end(); ++mit) {
-      Bid<Material>* bid = mit->first;
-      bids_vector.push_back(bid);
+      bids.push_back(mit->first);
     }
-    std::sort(bids_vector.begin(), bids_vector.end(), SortBids);
-
-    // Assign preferences to the sorted vector
-    double n_bids = bids_vector.size();
-    bool u235_mass = 0;
-
-    for (int bidit = 0; bidit < bids_vector.size(); bidit++) {
-      int new_pref = bidit + 1;
-
-      // For any bids with U-235 qty=0, set pref to zero.
-      if (!u235_mass) {
-        cyclus::Material::Ptr mat = bids_vector[bidit]->offer();
-        cyclus::toolkit::MatQuery mq(mat);
-        if (mq.mass(922350000) == 0) {
-          new_pref = -1;
-        } else {
-          u235_mass = true;
+
+    std::map<std::vector<Bid<Material>*>, std::vector<double> >::iterator ord =
+        orders.find(bids);
+    if (ord == orders.end()) {
+      // decorate with (U-235 fraction, position), sort, and undecorate into
+      // preferences by position
+      std::vector<std::pair<double, int> > keyed;
+      keyed.reserve(bids.size());
+      for (int i = 0; i < bids.size(); i++) {
+        std::map<Bid<Material>*, double>::iterator f = u235_fracs.find(bids[i]);
+        if (f == u235_fracs.end()) {
+          cyclus::toolkit::MatQuery mq(bids[i]->offer());
+          double qty = mq.qty();
+          double frac = qty > 0 ? mq.mass(922350000) / qty : 0;
+          f = u235_fracs.insert(std::make_pair(bids[i], frac)).first;
+        }
+        keyed.push_back(std::make_pair(f->second, i));
+      }
+      std::sort(keyed.begin(), keyed.end());
+
+      // Assign preferences in the sorted order.  Bids with no U-235 at all
+      // sort first and get a negative preference.
+      std::vector<double> ranked(bids.size());
+      bool u235_mass = false;
+      for (int rank = 0; rank < keyed.size(); rank++) {
+        double new_pref = rank + 1;
+        if (!u235_mass) {
+          if (keyed[rank].first == 0) {
+            new_pref = -1;
+          } else {
+            u235_mass = true;
+          }
         }
+        ranked[keyed[rank].second] = new_pref;
       }
-      (reqit->second)[bids_vector[bidit]] = new_pref;
-    }  // each bid
-  }    // each Material Request
+      ord = orders.insert(std::make_pair(bids, ranked)).first;
+    }
+
+    const std::vector<double>& ranked = ord->second;
+    int i = 0;
+    for (mit = reqit->second.begin(); mit != reqit->second.end(); ++mit) {
+      mit->second = ranked[i++];
+    }
+  }  // each Material Request
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Enrichment::AcceptMatlTrades(
     const std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                                 cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("AcceptMatlTrades");
   // see
   // http://stackoverflow.com/questions/5181183/boostshared-ptr-and-inheritance
   std::vector<std::pair<cyclus::Trade<cyclus::Material>,
@@ -174,6 +231,7 @@ void Enrichment::AcceptMatlTrades(
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
     cyclus::CommodMap<cyclus::Material>::type& out_requests) {
+  CYCAMORE_PERF_SCOPE("GetMatlBids");
   using cyclus::Bid;
   using cyclus::BidPortfolio;
   using cyclus::CapacityConstraint;
@@ -181,23 +239,22 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
   using cyclus::Material;
   using cyclus::Request;
   using cyclus::toolkit::MatVec;
-  using cyclus::toolkit::RecordTimeSeries;
 
   std::set<BidPortfolio<Material>::Ptr> ports;
 
-  RecordTimeSeries<double>("supply" + tails_commod, this, tails.quantity());
-  RecordTimeSeries<double>("supply" + product_commod, this, inventory.quantity());
+  record_policy_.Defer("supply" + tails_commod, tails.quantity());
+  record_policy_.Defer("supply" + product_commod, inventory.quantity());
   if ((out_requests.count(tails_commod) > 0) && (tails.quantity() > 0)) {
     BidPortfolio<Material>::Ptr tails_port(new BidPortfolio<Material>());
 
     std::vector<Request<Material>*>& tails_requests =
         out_requests[tails_commod];
+    const std::deque<Material::Ptr>& mats = tails_view_.contents();
     std::vector<Request<Material>*>::iterator it;
     for (it = tails_requests.begin(); it != tails_requests.end(); ++it) {
       // offer bids for all tails material, keeping discrete quantities
-      // to preserve possible variation in composition
-      MatVec mats = tails.PopN(tails.count());
-      tails.Push(mats);
+      // to preserve possible variation in composition (materials of matching
+      // composition are merged by tails_compact_tol)
       for (int k = 0; k < mats.size(); k++) {
         Material::Ptr m = mats[k];
         Request<Material>* req = *it;
@@ -232,8 +289,11 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Enrichment::GetMatlBids(
       }
     }
 
-    Converter<Material>::Ptr sc(new SWUConverter(FeedAssay(), tails_assay));
-    Converter<Material>::Ptr nc(new NatUConverter(FeedAssay(), tails_assay));
+    // both constraints look up the same per-composition costs
+    boost::shared_ptr<EnrichCosts> costs(
+        new EnrichCosts(FeedAssay(), tails_assay));
+    Converter<Material>::Ptr sc(new SWUConverter(costs));
+    Converter<Material>::Ptr nc(new NatUConverter(costs));
     CapacityConstraint<Material> swu(swu_capacity, sc);
     CapacityConstraint<Material> natu(inventory.quantity(), nc);
     commod_port->AddConstraint(swu);
@@ -261,6 +321,7 @@ void Enrichment::GetMatlTrades(
     const std::vector<cyclus::Trade<cyclus::Material> >& trades,
     std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                           cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("GetMatlTrades");
   using cyclus::Material;
   using cyclus::Trade;
 
@@ -279,7 +340,7 @@ void Enrichment::GetMatlTrades(
           << prototype() << " just received an order"
           << " for " << it->amt << " of " << tails_commod;
       double pop_qty = std::min(qty, tails.quantity());
-      response = tails.Pop(pop_qty, cyclus::eps_rsrc());
+      response = tails_view_.Pop(pop_qty, cyclus::eps_rsrc());
     } else {
       LOG(cyclus::LEV_INFO5, "EnrFac")
           << prototype() << " just received an order"
@@ -331,12 +392,21 @@ void Enrichment::AddMat_(cyclus::Material::Ptr mat) {
   LOG(cyclus::LEV_INFO5, "EnrFac") << prototype() << " is initially holding "
                                    << inventory.quantity() << " total.";
 
+  double prev_qty = inventory.quantity();
   try {
-    inventory.Push(mat);
+    inventory_view_.Push(mat);
   } catch (cyclus::Error& e) {
     e.msg(Agent::InformErrorMsg(e.msg()));
     throw e;
   }
+  TrackUMass_(mat, 1, prev_qty);
+
+  // keep the inventory a single homogeneous material so feed popped for
+  // enrichment always has the inventory's average composition
+  if (inventory.count() > 1) {
+    inventory_view_.Push(
+        cyclus::toolkit::Squash(inventory_view_.PopN(inventory.count())));
+  }
 
   LOG(cyclus::LEV_INFO5, "EnrFac")
       << prototype() << " added " << mat->quantity() << " of " << feed_commod
@@ -347,18 +417,23 @@ void Enrichment::AddMat_(cyclus::Material::Ptr mat) {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 cyclus::Material::Ptr Enrichment::Request_() {
   double qty = std::max(0.0, inventory.capacity() - inventory.quantity());
-  return cyclus::Material::CreateUntracked(qty,
-                                           context()->GetRecipe(feed_recipe));
+  return pool_.Get(context()->time(), qty, context()->GetRecipe(feed_recipe));
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 cyclus::Material::Ptr Enrichment::Offer_(cyclus::Material::Ptr mat) {
   cyclus::toolkit::MatQuery q(mat);
-  cyclus::CompMap comp;
-  comp[922350000] = q.atom_frac(922350000);
-  comp[922380000] = q.atom_frac(922380000);
+  double u235 = q.atom_frac(922350000);
+  double u238 = q.atom_frac(922380000);
+  if (u235 + u238 <= 0) {
+    cyclus::CompMap comp;
+    comp[922350000] = u235;
+    comp[922380000] = u238;
+    return cyclus::Material::CreateUntracked(
+        mat->quantity(), cyclus::Composition::CreateFromAtom(comp));
+  }
   return cyclus::Material::CreateUntracked(
-      mat->quantity(), cyclus::Composition::CreateFromAtom(comp));
+      mat->quantity(), AssayComps::Get(context(), u235 / (u235 + u238)));
 }
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 cyclus::Material::Ptr Enrichment::Enrich_(cyclus::Material::Ptr mat,
@@ -378,25 +453,21 @@ cyclus::Material::Ptr Enrichment::Enrich_(cyclus::Material::Ptr mat,
 
   // Determine the composition of the natural uranium
   // (ie. U-235+U-238/TotalMass)
-  double pop_qty = inventory.quantity();
-  Material::Ptr natu_matl = inventory.Pop(pop_qty, cyclus::eps_rsrc());
-  inventory.Push(natu_matl);
-
-  cyclus::toolkit::MatQuery mq(natu_matl);
-  std::set<cyclus::Nuc> nucs;
-  nucs.insert(922350000);
-  nucs.insert(922380000);
-  double natu_frac = mq.mass_frac(nucs);
+  double u235 = 0;
+  double u238 = 0;
+  InventoryUMass_(&u235, &u238);
+  double natu_frac = (u235 + u238) / inventory.quantity();
   double feed_req = natu_req / natu_frac;
 
   // pop amount from inventory and blob it into one material
   Material::Ptr r;
+  double prev_qty = inventory.quantity();
   try {
     // required so popping doesn't take out too much
     if (cyclus::AlmostEq(feed_req, inventory.quantity())) {
-      r = cyclus::toolkit::Squash(inventory.PopN(inventory.count()));
+      r = cyclus::toolkit::Squash(inventory_view_.PopN(inventory.count()));
     } else {
-      r = inventory.Pop(feed_req, cyclus::eps_rsrc());
+      r = inventory_view_.Pop(feed_req, cyclus::eps_rsrc());
     }
   } catch (cyclus::Error& e) {
     NatUConverter nc(FeedAssay(), tails_assay);
@@ -407,12 +478,13 @@ cyclus::Material::Ptr Enrichment::Enrich_(cyclus::Material::Ptr mat,
        << nc.convert(mat);
     throw cyclus::ValueError(Agent::InformErrorMsg(ss.str()));
   }
+  TrackUMass_(r, -1, prev_qty);
 
   // "enrich" it, but pull out the composition and quantity we require from the
   // blob
   cyclus::Composition::Ptr comp = mat->comp();
   Material::Ptr response = r->ExtractComp(qty, comp);
-  tails.Push(r);
+  tails_view_.Push(r);
 
   current_swu_capacity -= swu_req;
 
@@ -450,12 +522,9 @@ void Enrichment::RecordEnrichment_(double natural_u, double swu) {
   LOG(cyclus::LEV_DEBUG1, "EnrFac") << "  *    SWU: " << swu;
 
   Context* ctx = Agent::context();
-  ctx->NewDatum("Enrichments")
-      ->AddVal("AgentId", id())
-      ->AddVal("Time", ctx->time())
-      ->AddVal("Natural_Uranium", natural_u)
-      ->AddVal("SWU", swu)
-      ->Record();
+  if (record_policy_.RecordsEvents(ctx->time())) {
+    enrichments_.Add(id(), ctx->time(), natural_u, swu);
+  }
 }
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 double Enrichment::FeedAssay() {
@@ -464,11 +533,46 @@ double Enrichment::FeedAssay() {
   if (inventory.empty()) {
     return 0;
   }
-  double pop_qty = inventory.quantity();
-  cyclus::Material::Ptr fission_matl =
-      inventory.Pop(pop_qty, cyclus::eps_rsrc());
-  inventory.Push(fission_matl);
-  return cyclus::toolkit::UraniumAssayMass(fission_matl);
+  double u235 = 0;
+  double u238 = 0;
+  InventoryUMass_(&u235, &u238);
+  if (u235 + u238 == 0) {
+    return 0;
+  }
+  return u235 / (u235 + u238);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Enrichment::InventoryUMass_(double* u235, double* u238) {
+  if (inv_qty_ != inventory.quantity()) {
+    inv_u235_ = 0;
+    inv_u238_ = 0;
+    const std::deque<cyclus::Material::Ptr>& mats = inventory_view_.contents();
+    for (int i = 0; i < mats.size(); i++) {
+      cyclus::toolkit::MatQuery mq(mats[i]);
+      inv_u235_ += mq.mass(922350000);
+      inv_u238_ += mq.mass(922380000);
+    }
+    inv_qty_ = inventory.quantity();
+  }
+  *u235 = inv_u235_;
+  *u238 = inv_u238_;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Enrichment::TrackUMass_(cyclus::Material::Ptr mat, double sign,
+                             double prev_qty) {
+  if (inv_qty_ != prev_qty) {
+    return;  // already stale, the next read sums the inventory
+  } else if (inventory.empty()) {
+    inv_u235_ = 0;
+    inv_u238_ = 0;
+  } else {
+    cyclus::toolkit::MatQuery mq(mat);
+    inv_u235_ = std::max(0.0, inv_u235_ + sign * mq.mass(922350000));
+    inv_u238_ = std::max(0.0, inv_u238_ + sign * mq.mass(922380000));
+  }
+  inv_qty_ = inventory.quantity();
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -484,6 +588,42 @@ void Enrichment::RecordPosition() {
       ->Record();
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+std::map<long, cyclus::Composition::Ptr> AssayComps::comps_;
+boost::uuids::uuid AssayComps::sim_id_;
+std::mutex AssayComps::mutex_;
+
+cyclus::Composition::Ptr AssayComps::Get(cyclus::Context* ctx, double u235) {
+  long key = std::lround(u235 / tol());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ctx->sim_id() != sim_id_) {
+    // compositions are only recorded to the output of the first simulation
+    // they are used in
+    comps_.clear();
+    sim_id_ = ctx->sim_id();
+  }
+  std::map<long, cyclus::Composition::Ptr>::iterator it = comps_.find(key);
+  if (it != comps_.end()) {
+    return it->second;
+  }
+
+  double x = key * tol();
+  cyclus::CompMap comp;
+  comp[922350000] = x;
+  comp[922380000] = 1 - x;
+  return comps_[key] = cyclus::Composition::CreateFromAtom(comp);
+}
+
+int AssayComps::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return comps_.size();
+}
+
+void AssayComps::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  comps_.clear();
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 extern "C" cyclus::Agent* ConstructEnrichment(cyclus::Context* ctx) {
   return new Enrichment(ctx);
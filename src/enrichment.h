@@ -1,21 +1,133 @@
 #ifndef CYCAMORE_SRC_ENRICHMENT_H_
 #define CYCAMORE_SRC_ENRICHMENT_H_
 
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
 
+#include <boost/uuid/uuid.hpp>
+
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "res_buf_view.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
+/// @class EnrichCosts
+///
+/// @brief EnrichCosts tabulates the SWU and natural uranium needed per kg of
+/// product for a fixed feed and tails assay.  Both amounts are linear in the
+/// product quantity and only depend on the product composition, so they are
+/// memoized by composition and a lookup replaces the assay and value function
+/// evaluations.  The feed and tails value function terms are computed once
+/// on construction.
+class EnrichCosts {
+ public:
+  /// per kg of product costs
+  struct Cost {
+    double swu;
+    double natu;
+  };
+
+  EnrichCosts(double feed, double tails) : feed_(feed), tails_(tails),
+    v_feed_(0), v_tails_(0), init_(false) {}
+
+  double feed() const { return feed_; }
+  double tails() const { return tails_; }
+
+  /// @return the SWU and natural uranium required per kg of m (natural
+  /// uranium is scaled by m's U-235 plus U-238 mass fraction)
+  const Cost& PerKg(cyclus::Material::Ptr m) const {
+    int id = m->comp()->id();
+    std::map<int, Cost>::iterator it = costs_.find(id);
+    if (it != costs_.end()) {
+      return it->second;
+    }
+
+    if (!init_) {
+      v_feed_ = cyclus::toolkit::ValueFunc(feed_);
+      v_tails_ = cyclus::toolkit::ValueFunc(tails_);
+      init_ = true;
+    }
+    double product = cyclus::toolkit::UraniumAssayMass(m);
+    double feed_per_kg = (product - tails_) / (feed_ - tails_);
+    double tails_per_kg = feed_per_kg - 1;
+
+    cyclus::toolkit::MatQuery mq(m);
+    std::set<cyclus::Nuc> nucs;
+    nucs.insert(922350000);
+    nucs.insert(922380000);
+
+    Cost c;
+    c.swu = cyclus::toolkit::ValueFunc(product) + tails_per_kg * v_tails_ -
+            feed_per_kg * v_feed_;
+    c.natu = feed_per_kg / mq.mass_frac(nucs);
+    return costs_[id] = c;
+  }
+
+  /// @return the number of tabulated compositions
+  int size() const { return costs_.size(); }
+
+ private:
+  double feed_, tails_;
+  mutable double v_feed_, v_tails_;
+  mutable bool init_;
+  mutable std::map<int, Cost> costs_;
+};
+
+/// @class AssayComps
+///
+/// @brief AssayComps interns the uranium compositions Enrichment offers and
+/// ships as product.  These only consist of U-235 and U-238, so they are
+/// keyed by their U-235 atom fraction rounded to a multiple of tol().  Every
+/// offer and product of the same enrichment level, from any facility or time
+/// step, shares one composition, which keeps composition id keyed caches
+/// (e.g. EnrichCosts) hot and writes each level to the Compositions table
+/// once.  The table only holds the compositions of one simulation: it is
+/// cleared whenever compositions are asked for by another simulation, so that
+/// each simulation run by a process records its own.  The table is guarded
+/// by a mutex and may be used from several threads at once.
+class AssayComps {
+ public:
+  /// @param ctx the context of the simulation asking for the composition
+  /// @param u235 the U-235 atom fraction of the uranium, i.e. U-235 / (U-235 +
+  /// U-238)
+  /// @return the composition of uranium with u235 rounded to a multiple of
+  /// tol()
+  static cyclus::Composition::Ptr Get(cyclus::Context* ctx, double u235);
+
+  /// @return the U-235 atom fraction compositions are rounded to
+  static double tol() { return 1e-9; }
+
+  /// @return the number of interned compositions
+  static int size();
+
+  /// Drops all interned compositions.
+  static void Clear();
+
+ private:
+  // map<rounded U-235 atom fraction / tol(), composition>
+  static std::map<long, cyclus::Composition::Ptr> comps_;
+  // the simulation comps_ belongs to
+  static boost::uuids::uuid sim_id_;
+  static std::mutex mutex_;
+};
+
 /// @class SWUConverter
 ///
 /// @brief The SWUConverter is a simple Converter class for material to
 /// determine the amount of SWU required for their proposed enrichment
 class SWUConverter : public cyclus::Converter<cyclus::Material> {
  public:
-  SWUConverter(double feed_commod, double tails) : feed_(feed_commod),
-    tails_(tails) {}
+  SWUConverter(double feed_commod, double tails)
+    : costs_(new EnrichCosts(feed_commod, tails)) {}
+  /// @param costs a table shared with other converters of the same exchange
+  explicit SWUConverter(boost::shared_ptr<EnrichCosts> costs)
+    : costs_(costs) {}
   virtual ~SWUConverter() {}
 
   /// @brief provides a conversion for the SWU required
@@ -24,21 +136,19 @@ class SWUConverter : public cyclus::Converter<cyclus::Material> {
       cyclus::Arc const * a = NULL,
       cyclus::ExchangeTranslationContext<cyclus::Material>
           const * ctx = NULL) const {
-    cyclus::toolkit::Assays assays(feed_, cyclus::toolkit::UraniumAssayMass(m),
-                                   tails_);
-    return cyclus::toolkit::SwuRequired(m->quantity(), assays);
+    return m->quantity() * costs_->PerKg(m).swu;
   }
 
   /// @returns true if Converter is a SWUConverter and feed and tails equal
   virtual bool operator==(Converter& other) const {
     SWUConverter* cast = dynamic_cast<SWUConverter*>(&other);
     return cast != NULL &&
-    feed_ == cast->feed_ &&
-    tails_ == cast->tails_;
+    costs_->feed() == cast->costs_->feed() &&
+    costs_->tails() == cast->costs_->tails();
   }
 
  private:
-  double feed_, tails_;
+  boost::shared_ptr<EnrichCosts> costs_;
 };
 
 /// @class NatUConverter
@@ -48,8 +158,11 @@ class SWUConverter : public cyclus::Converter<cyclus::Material> {
 /// enrichment
 class NatUConverter : public cyclus::Converter<cyclus::Material> {
  public:
-  NatUConverter(double feed_commod, double tails) : feed_(feed_commod),
-    tails_(tails) {}
+  NatUConverter(double feed_commod, double tails)
+    : costs_(new EnrichCosts(feed_commod, tails)) {}
+  /// @param costs a table shared with other converters of the same exchange
+  explicit NatUConverter(boost::shared_ptr<EnrichCosts> costs)
+    : costs_(costs) {}
   virtual ~NatUConverter() {}
 
   virtual std::string version() { return CYCAMORE_VERSION; }
@@ -60,28 +173,19 @@ class NatUConverter : public cyclus::Converter<cyclus::Material> {
       cyclus::Arc const * a = NULL,
       cyclus::ExchangeTranslationContext<cyclus::Material>
           const * ctx = NULL) const {
-    cyclus::toolkit::Assays assays(feed_, cyclus::toolkit::UraniumAssayMass(m),
-                                   tails_);
-    cyclus::toolkit::MatQuery mq(m);
-    std::set<cyclus::Nuc> nucs;
-    nucs.insert(922350000);
-    nucs.insert(922380000);
-
-    double natu_frac = mq.mass_frac(nucs);
-    double natu_req = cyclus::toolkit::FeedQty(m->quantity(), assays);
-    return natu_req / natu_frac;
+    return m->quantity() * costs_->PerKg(m).natu;
   }
 
   /// @returns true if Converter is a NatUConverter and feed and tails equal
   virtual bool operator==(Converter& other) const {
     NatUConverter* cast = dynamic_cast<NatUConverter*>(&other);
     return cast != NULL &&
-    feed_ == cast->feed_ &&
-    tails_ == cast->tails_;
+    costs_->feed() == cast->costs_->feed() &&
+    costs_->tails() == cast->costs_->tails();
   }
 
  private:
-  double feed_, tails_;
+  boost::shared_ptr<EnrichCosts> costs_;
 };
 
 ///  The Enrichment facility is a simple Agent that enriches natural
@@ -175,6 +279,8 @@ class Enrichment
   // --- Facility Members ---
   /// perform module-specific tasks when entering the simulation
   virtual void Build(cyclus::Agent* parent);
+
+  virtual void EnterNotify();
   // ---
 
   // --- Agent Members ---
@@ -268,6 +374,15 @@ class Enrichment
   ///  @brief calculates the feed assay based on the unenriched inventory
   double FeedAssay();
 
+  ///  @brief gives the U-235 and U-238 mass held in the feed inventory,
+  ///  summing over the inventory only if the running totals are stale
+  void InventoryUMass_(double* u235, double* u238);
+
+  ///  @brief adds (sign 1) or removes (sign -1) the U masses of mat to or
+  ///  from the running inventory totals
+  ///  @param prev_qty the inventory quantity before mat was pushed or popped
+  void TrackUMass_(cyclus::Material::Ptr mat, double sign, double prev_qty);
+
   ///  @brief records and enrichment with the cyclus::Recorder
   void RecordEnrichment_(double natural_u, double swu);
 
@@ -315,6 +430,16 @@ class Enrichment
   }
   double tails_assay;
 
+  #pragma cyclus var {							\
+    "default": -1, "tooltip": "tails compaction tolerance",		\
+    "uilabel": "Tails Compaction Tolerance",				\
+    "doc": "adjacent tails materials whose mass fractions all agree within "	\
+    "this tolerance are merged into one material at the end of every time "	\
+    "step, which reduces the number of tails materials and bids.  A "	\
+    "negative value keeps every tails material separate.",		\
+  }
+  double tails_compact_tol;
+
   #pragma cyclus var {							\
     "default": 0, "tooltip": "initial uranium reserves (kg)",		\
     "uilabel": "Initial Feed Inventory",				\
@@ -379,6 +504,20 @@ class Enrichment
   #pragma cyclus var {}
   cyclus::toolkit::ResBuf<cyclus::Material> tails;  // depleted u
 
+  // read-only access to the buffers without pop/push round trips - all
+  // pushes and pops go through these
+  ResBufView<cyclus::Material> inventory_view_;
+  ResBufView<cyclus::Material> tails_view_;
+
+  // running U-235 and U-238 mass of the inventory, valid while inv_qty_
+  // equals the inventory quantity (so they are rebuilt after a restart)
+  double inv_u235_;
+  double inv_u238_;
+  double inv_qty_;
+
+  // Enrichments rows of the current time step, flushed at the end of the Tock
+  RecordBuffer<int, int, double, double> enrichments_;
+
   // used to total intra-timestep swu and natu usage for meeting requests -
   // these help enable time series generation.
   double intra_timestep_swu_;
@@ -387,6 +526,18 @@ class Enrichment
   friend class EnrichmentTest;
   // ---
 
+  #include "record_policy.cycpp.h"
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
+
   #pragma cyclus var { \
     "default": 0.0, \
     "uilabel": "Geographical latitude in degrees as a double", \
@@ -404,6 +555,20 @@ class Enrichment
   double longitude;
 
   cyclus::toolkit::Position coordinates;
+
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
+  /// request targets shared between requests and time steps
+  UntrackedPool pool_;
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 }  // namespace cycamore
@@ -366,6 +366,47 @@ TEST_F(EnrichmentTest, BidPrefs) {
   }
 
 }
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, BidPrefsEqualAssays) {
+  // Bids with identical U235 content must all rank above lower assay bids
+
+  std::string config =
+    "   <feed_commod>natu</feed_commod> "
+    "   <feed_recipe>natu1</feed_recipe> "
+    "   <product_commod>enr_u</product_commod> "
+    "   <tails_commod>tails</tails_commod> "
+    "   <tails_assay>0.003</tails_assay> "
+    "   <max_feed_inventory>2.0</max_feed_inventory> ";
+
+  int simdur = 1;
+  cyclus::MockSim sim(cyclus::AgentSpec
+          (":cycamore:Enrichment"), config, simdur);
+  sim.AddRecipe("natu1", c_natu1());
+  sim.AddRecipe("natu2", c_natu2());
+
+  sim.AddSource("natu").recipe("natu2").capacity(1).Finalize();
+  sim.AddSource("natu").recipe("natu1").capacity(1).Finalize();
+  sim.AddSource("natu").recipe("natu2").capacity(1).Finalize();
+
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Commodity", "==", std::string("natu")));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+
+  // should trade only with the two higher U235 sources
+  ASSERT_EQ(2, qr.rows.size());
+
+  CompMap want = c_natu2()->mass();
+  cyclus::compmath::Normalize(&want);
+  for (int i = 0; i < qr.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    CompMap got = m->comp()->mass();
+    cyclus::compmath::Normalize(&got);
+    EXPECT_DOUBLE_EQ(want[922350000], got[922350000]);
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   TEST_F(EnrichmentTest, NoBidPrefs) {
   // This tests that preference-ordering for sources
@@ -518,6 +559,16 @@ EnrichmentTest::DoEnrich(cyclus::Material::Ptr mat, double qty) {
   return src_facility->Enrich_(mat, qty);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+double EnrichmentTest::DoFeedAssay() {
+  return src_facility->FeedAssay();
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void EnrichmentTest::SetTailsCompactTol(double tol) {
+  src_facility->tails_compact_tol = tol;
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST_F(EnrichmentTest, Request) {
   // Tests that quantity in material request is accurate
@@ -611,6 +662,124 @@ TEST_F(EnrichmentTest, ValidReq) {
   EXPECT_NEAR(natuc.convert(target) * mass_frac, natuc.convert(offer), 0.001);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, EnrichCosts) {
+  // the tabulated per kg costs match the toolkit's and are shared by all
+  // materials of the same composition
+  using cyclus::CompMap;
+  using cyclus::Composition;
+  using cyclus::Material;
+  using cyclus::toolkit::Assays;
+  using cyclus::toolkit::FeedQty;
+  using cyclus::toolkit::SwuRequired;
+
+  CompMap v;
+  v[922350000] = 0.04;
+  v[922380000] = 0.96;
+  Composition::Ptr leu = Composition::CreateFromMass(v);
+  v[922350000] = 0.2;
+  v[922380000] = 0.8;
+  Composition::Ptr heu = Composition::CreateFromMass(v);
+
+  boost::shared_ptr<EnrichCosts> costs(
+      new EnrichCosts(feed_assay, tails_assay));
+  SWUConverter swuc(costs);
+  NatUConverter natuc(costs);
+
+  double qtys[] = {1, 3.5, 10};
+  for (int i = 0; i < 3; i++) {
+    Material::Ptr m = Material::CreateUntracked(qtys[i], leu);
+    Assays assays(feed_assay, 0.04, tails_assay);
+    EXPECT_NEAR(swuc.convert(m), SwuRequired(qtys[i], assays), 1e-8);
+    EXPECT_NEAR(natuc.convert(m), FeedQty(qtys[i], assays), 1e-8);
+  }
+  EXPECT_EQ(costs->size(), 1);
+
+  Material::Ptr m = Material::CreateUntracked(2, heu);
+  Assays assays(feed_assay, 0.2, tails_assay);
+  EXPECT_NEAR(swuc.convert(m), SwuRequired(2, assays), 1e-8);
+  EXPECT_EQ(costs->size(), 2);
+
+  SWUConverter other(feed_assay, tails_assay);
+  EXPECT_TRUE(swuc == other);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, AssayComps) {
+  // offers for the same enrichment level share one composition, no matter
+  // what else the requested material contains
+  using cyclus::CompMap;
+  using cyclus::Composition;
+  using cyclus::Material;
+  using cyclus::toolkit::MatQuery;
+
+  AssayComps::Clear();
+
+  CompMap v;
+  v[922350000] = 0.04;
+  v[922380000] = 0.96;
+  Material::Ptr leu =
+      Material::CreateUntracked(1, Composition::CreateFromAtom(v));
+  Material::Ptr leu2 =
+      Material::CreateUntracked(3, Composition::CreateFromAtom(v));
+  v[942390000] = 0.5;
+  Material::Ptr mixed =
+      Material::CreateUntracked(2, Composition::CreateFromAtom(v));
+  v.erase(942390000);
+  v[922350000] = 0.2;
+  v[922380000] = 0.8;
+  Material::Ptr heu =
+      Material::CreateUntracked(1, Composition::CreateFromAtom(v));
+
+  Material::Ptr offer = DoOffer(leu);
+  EXPECT_EQ(offer->comp(), DoOffer(leu2)->comp());
+  EXPECT_EQ(offer->comp(), DoOffer(mixed)->comp());
+  EXPECT_NE(offer->comp(), DoOffer(heu)->comp());
+  EXPECT_EQ(2, AssayComps::size());
+
+  MatQuery q(offer);
+  EXPECT_NEAR(0.04, q.atom_frac(922350000), AssayComps::tol());
+  EXPECT_DOUBLE_EQ(1, offer->quantity());
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, AssayCompsPerSimulation) {
+  // simulations run one after the other each record the compositions of
+  // their products, even though they enrich to the same levels
+  std::string config =
+    "   <feed_commod>natu</feed_commod> "
+    "   <feed_recipe>natu1</feed_recipe> "
+    "   <product_commod>enr_u</product_commod> "
+    "   <tails_commod>tails</tails_commod> "
+    "   <tails_assay>0.003</tails_assay> "
+    "   <initial_feed>1000</initial_feed> ";
+
+  for (int i = 0; i < 2; i++) {
+    int simdur = 1;
+    cyclus::MockSim sim(cyclus::AgentSpec
+            (":cycamore:Enrichment"), config, simdur);
+    sim.AddRecipe("natu1", c_natu1());
+    sim.AddRecipe("leu", c_leu());
+    sim.AddSink("enr_u")
+      .recipe("leu")
+      .capacity(1)
+      .Finalize();
+    sim.Run();
+
+    std::vector<Cond> conds;
+    conds.push_back(Cond("Commodity", "==", std::string("enr_u")));
+    QueryResult qr = sim.db().Query("Transactions", &conds);
+    ASSERT_EQ(1, qr.rows.size()) << "simulation " << i;
+
+    conds[0] = Cond("ResourceId", "==", qr.GetVal<int>("ResourceId"));
+    qr = sim.db().Query("Resources", &conds);
+    conds[0] = Cond("QualId", "==", qr.GetVal<int>("QualId"));
+    qr = sim.db().Query("Compositions", &conds);
+    EXPECT_LT(0, qr.rows.size())
+        << "product composition not recorded in simulation " << i;
+  }
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST_F(EnrichmentTest, Enrich) {
   // this test asks the facility to enrich a material that results in an amount
@@ -660,6 +829,68 @@ TEST_F(EnrichmentTest, Enrich) {
   EXPECT_THROW(response = DoEnrich(target, qty), cyclus::Error);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, FeedAssayTracking) {
+  // the inventory's U masses are kept as running totals through adds and
+  // enrichments
+  using cyclus::Material;
+
+  cyclus::CompMap v;
+  v[922350000] = 0.003;
+  v[922380000] = 0.997;
+  Material::Ptr depleted =
+      Material::CreateUntracked(2, cyclus::Composition::CreateFromMass(v));
+
+  EXPECT_DOUBLE_EQ(DoFeedAssay(), 0);
+  DoAddMat(GetMat(2));
+  EXPECT_NEAR(DoFeedAssay(), feed_assay, 1e-10);
+  DoAddMat(depleted);
+  double blend = (2 * feed_assay + 2 * 0.003) / 4;
+  EXPECT_NEAR(DoFeedAssay(), blend, 1e-10);
+
+  cyclus::CompMap p;
+  p[922350000] = 0.035;
+  p[922380000] = 0.965;
+  Material::Ptr target =
+      Material::CreateUntracked(0.1, cyclus::Composition::CreateFromMass(p));
+  DoEnrich(target, 0.1);
+  EXPECT_GT(src_facility->Tails().quantity(), 0);
+  EXPECT_NEAR(DoFeedAssay(), blend, 1e-10);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(EnrichmentTest, CompactTails) {
+  // tails are all at the tails assay, whatever the product, so with a
+  // compaction tolerance they are merged at the end of the time step
+  using cyclus::Material;
+
+  cyclus::CompMap v;
+  v[922350000] = 0.04;
+  v[922380000] = 0.96;
+  Material::Ptr leu =
+      Material::CreateUntracked(1, cyclus::Composition::CreateFromMass(v));
+  v[922350000] = 0.005;
+  v[922380000] = 0.995;
+  Material::Ptr deu =
+      Material::CreateUntracked(1, cyclus::Composition::CreateFromMass(v));
+
+  src_facility->SetMaxInventorySize(100);
+  DoAddMat(GetMat(100));
+  DoEnrich(leu, 0.1);
+  DoEnrich(leu, 0.2);
+  DoEnrich(deu, 0.1);
+  double qty = src_facility->Tails().quantity();
+  ASSERT_EQ(3, src_facility->Tails().count());
+
+  src_facility->Tock();
+  EXPECT_EQ(3, src_facility->Tails().count());
+
+  SetTailsCompactTol(1e-9);
+  src_facility->Tock();
+  EXPECT_EQ(1, src_facility->Tails().count());
+  EXPECT_NEAR(qty, src_facility->Tails().quantity(), 1e-10);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST_F(EnrichmentTest, Response) {
   // this test asks the facility to respond to multiple requests for enriched
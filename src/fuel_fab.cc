@@ -1,5 +1,6 @@
 #include "fuel_fab.h"
 
+#include <algorithm>
 #include <sstream>
 
 using cyclus::Material;
@@ -16,10 +17,10 @@ class FissConverter : public cyclus::Converter<cyclus::Material> {
  public:
   FissConverter(Composition::Ptr c_fill, Composition::Ptr c_fiss,
                 Composition::Ptr c_topup, std::string spectrum)
-      : c_fiss_(c_fiss), c_topup_(c_topup), c_fill_(c_fill), spec_(spectrum) {
-    w_fiss_ = CosiWeight(c_fiss, spectrum);
-    w_fill_ = CosiWeight(c_fill, spectrum);
-    w_topup_ = CosiWeight(c_topup, spectrum);
+      : spec_(spectrum), c_fiss_(c_fiss), c_fill_(c_fill), c_topup_(c_topup) {
+    w_fiss_ = CosiWeightCache::Get(c_fiss, spectrum);
+    w_fill_ = CosiWeightCache::Get(c_fill, spectrum);
+    w_topup_ = CosiWeightCache::Get(c_topup, spectrum);
   }
 
   virtual ~FissConverter() {}
@@ -28,7 +29,7 @@ class FissConverter : public cyclus::Converter<cyclus::Material> {
       cyclus::Material::Ptr m, cyclus::Arc const* a = NULL,
       cyclus::ExchangeTranslationContext<cyclus::Material> const* ctx =
           NULL) const {
-    double w_tgt = CosiWeight(m->comp(), spec_);
+    double w_tgt = CosiWeightCache::Get(m->comp(), spec_);
     if (ValidWeights(w_fill_, w_tgt, w_fiss_)) {
       double frac = HighFrac(w_fill_, w_tgt, w_fiss_);
       return AtomToMassFrac(frac, c_fiss_, c_fill_) * m->quantity();
@@ -56,10 +57,10 @@ class FillConverter : public cyclus::Converter<cyclus::Material> {
  public:
   FillConverter(Composition::Ptr c_fill, Composition::Ptr c_fiss,
                 Composition::Ptr c_topup, std::string spectrum)
-      : c_fiss_(c_fiss), c_topup_(c_topup), c_fill_(c_fill), spec_(spectrum) {
-    w_fiss_ = CosiWeight(c_fiss, spectrum);
-    w_fill_ = CosiWeight(c_fill, spectrum);
-    w_topup_ = CosiWeight(c_topup, spectrum);
+      : spec_(spectrum), c_fiss_(c_fiss), c_fill_(c_fill), c_topup_(c_topup) {
+    w_fiss_ = CosiWeightCache::Get(c_fiss, spectrum);
+    w_fill_ = CosiWeightCache::Get(c_fill, spectrum);
+    w_topup_ = CosiWeightCache::Get(c_topup, spectrum);
   }
 
   virtual ~FillConverter() {}
@@ -68,7 +69,7 @@ class FillConverter : public cyclus::Converter<cyclus::Material> {
       cyclus::Material::Ptr m, cyclus::Arc const* a = NULL,
       cyclus::ExchangeTranslationContext<cyclus::Material> const* ctx =
           NULL) const {
-    double w_tgt = CosiWeight(m->comp(), spec_);
+    double w_tgt = CosiWeightCache::Get(m->comp(), spec_);
     if (ValidWeights(w_fill_, w_tgt, w_fiss_)) {
       double frac = LowFrac(w_fill_, w_tgt, w_fiss_);
       return AtomToMassFrac(frac, c_fill_, c_fiss_) * m->quantity();
@@ -95,10 +96,10 @@ class TopupConverter : public cyclus::Converter<cyclus::Material> {
  public:
   TopupConverter(Composition::Ptr c_fill, Composition::Ptr c_fiss,
                  Composition::Ptr c_topup, std::string spectrum)
-      : c_fiss_(c_fiss), c_topup_(c_topup), c_fill_(c_fill), spec_(spectrum) {
-    w_fiss_ = CosiWeight(c_fiss, spectrum);
-    w_fill_ = CosiWeight(c_fill, spectrum);
-    w_topup_ = CosiWeight(c_topup, spectrum);
+      : spec_(spectrum), c_fiss_(c_fiss), c_fill_(c_fill), c_topup_(c_topup) {
+    w_fiss_ = CosiWeightCache::Get(c_fiss, spectrum);
+    w_fill_ = CosiWeightCache::Get(c_fill, spectrum);
+    w_topup_ = CosiWeightCache::Get(c_topup, spectrum);
   }
 
   virtual ~TopupConverter() {}
@@ -107,7 +108,7 @@ class TopupConverter : public cyclus::Converter<cyclus::Material> {
       cyclus::Material::Ptr m, cyclus::Arc const* a = NULL,
       cyclus::ExchangeTranslationContext<cyclus::Material> const* ctx =
           NULL) const {
-    double w_tgt = CosiWeight(m->comp(), spec_);
+    double w_tgt = CosiWeightCache::Get(m->comp(), spec_);
     if (ValidWeights(w_fill_, w_tgt, w_fiss_)) {
       return 0;
     } else if (ValidWeights(w_fiss_, w_tgt, w_topup_)) {
@@ -135,12 +136,14 @@ FuelFab::FuelFab(cyclus::Context* ctx)
       fill_size(0),
       fiss_size(0),
       throughput(0),
+      memory_interval(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {}
 
 void FuelFab::EnterNotify() {
   cyclus::Facility::EnterNotify();
+  memory_.Init(memory_interval);
 
   if (fiss_commod_prefs.empty()) {
     for (int i = 0; i < fiss_commods.size(); i++) {
@@ -163,10 +166,39 @@ void FuelFab::EnterNotify() {
        << " fill_commod_prefs vals, expected " << fill_commods.size();
     throw cyclus::ValidationError(ss.str());
   }
+
+  // tabulate the recipe nuclides up front so bidding never has to go back to
+  // PyNE for them
+  try {
+    CosiXSTable& xs = CosiXSTable::Get(spectrum);
+    xs.Add(context()->GetRecipe(fill_recipe)->atom());
+    if (!fiss_recipe.empty()) {
+      xs.Add(context()->GetRecipe(fiss_recipe)->atom());
+    }
+    if (!topup_recipe.empty()) {
+      xs.Add(context()->GetRecipe(topup_recipe)->atom());
+    }
+  } catch (pyne::InvalidSimpleXS err) {
+    std::stringstream ss;
+    ss << "prototype '" << prototype() << "' has unknown spectrum '"
+       << spectrum << "'";
+    throw cyclus::ValidationError(ss.str());
+  }
   RecordPosition();
 }
 
+void FuelFab::Tock() {
+  CYCAMORE_PERF_SCOPE("Tock");
+  if (memory_.Due(context()->time())) {
+    memory_.Add("fill", fill);
+    memory_.Add("fiss", fiss);
+    memory_.Add("topup", topup);
+    memory_.Flush(this);
+  }
+}
+
 std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
+  CYCAMORE_PERF_SCOPE("GetMatlRequests");
   using cyclus::RequestPortfolio;
 
   std::set<RequestPortfolio<Material>::Ptr> ports;
@@ -176,11 +208,11 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
   if (fiss.space() > cyclus::eps_rsrc()) {
     RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
 
-    Material::Ptr m = cyclus::NewBlankMaterial(fiss.space());
+    Composition::Ptr c;
     if (!fiss_recipe.empty()) {
-      Composition::Ptr c = context()->GetRecipe(fiss_recipe);
-      m = Material::CreateUntracked(fiss.space(), c);
+      c = context()->GetRecipe(fiss_recipe);
     }
+    Material::Ptr m = pool_.Get(context()->time(), fiss.space(), c);
 
     std::vector<cyclus::Request<Material>*> reqs;
     for (int i = 0; i < fiss_commods.size(); i++) {
@@ -196,11 +228,11 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
   if (fill.space() > cyclus::eps_rsrc()) {
     RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
 
-    Material::Ptr m = cyclus::NewBlankMaterial(fill.space());
+    Composition::Ptr c;
     if (!fill_recipe.empty()) {
-      Composition::Ptr c = context()->GetRecipe(fill_recipe);
-      m = Material::CreateUntracked(fill.space(), c);
+      c = context()->GetRecipe(fill_recipe);
     }
+    Material::Ptr m = pool_.Get(context()->time(), fill.space(), c);
 
     std::vector<cyclus::Request<Material>*> reqs;
     for (int i = 0; i < fill_commods.size(); i++) {
@@ -216,11 +248,11 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> FuelFab::GetMatlRequests() {
   if (topup.space() > cyclus::eps_rsrc()) {
     RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
 
-    Material::Ptr m = cyclus::NewBlankMaterial(topup.space());
+    Composition::Ptr c;
     if (!topup_recipe.empty()) {
-      Composition::Ptr c = context()->GetRecipe(topup_recipe);
-      m = Material::CreateUntracked(topup.space(), c);
+      c = context()->GetRecipe(topup_recipe);
     }
+    Material::Ptr m = pool_.Get(context()->time(), topup.space(), c);
     cyclus::Request<Material>* r =
         port->AddRequest(m, this, topup_commod, topup_pref, exclusive);
     req_inventories_[r] = "topup";
@@ -242,6 +274,7 @@ bool Contains(std::vector<std::string> vec, std::string s) {
 void FuelFab::AcceptMatlTrades(
     const std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
         responses) {
+  CYCAMORE_PERF_SCOPE("AcceptMatlTrades");
   std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                         cyclus::Material::Ptr> >::const_iterator trade;
 
@@ -276,8 +309,19 @@ void FuelFab::AcceptMatlTrades(
   }
 }
 
+// The mass fractions of the two streams mixed to meet a bid target weight.
+struct BidMix {
+  BidMix() : valid(false), frac1(0), frac2(0) {}
+  bool valid;
+  Composition::Ptr c1;
+  Composition::Ptr c2;
+  double frac1;
+  double frac2;
+};
+
 std::set<cyclus::BidPortfolio<Material>::Ptr> FuelFab::GetMatlBids(
     cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_PERF_SCOPE("GetMatlBids");
   using cyclus::BidPortfolio;
 
   std::set<BidPortfolio<Material>::Ptr> ports;
@@ -294,20 +338,20 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> FuelFab::GetMatlBids(
       c_fill;  // no default needed - this is non-optional parameter
   if (fill.count() > 0) {
     c_fill = fill.Peek()->comp();
-    w_fill = CosiWeight(c_fill, spectrum);
+    w_fill = CosiWeightCache::Get(c_fill, spectrum);
   } else {
     c_fill = context()->GetRecipe(fill_recipe);
-    w_fill = CosiWeight(c_fill, spectrum);
+    w_fill = CosiWeightCache::Get(c_fill, spectrum);
   }
 
   double w_topup = 0;
   Composition::Ptr c_topup = c_fill;
   if (topup.count() > 0) {
     c_topup = topup.Peek()->comp();
-    w_topup = CosiWeight(c_topup, spectrum);
+    w_topup = CosiWeightCache::Get(c_topup, spectrum);
   } else if (!topup_recipe.empty()) {
     c_topup = context()->GetRecipe(topup_recipe);
-    w_topup = CosiWeight(c_topup, spectrum);
+    w_topup = CosiWeightCache::Get(c_topup, spectrum);
   }
 
   double w_fiss =
@@ -315,56 +359,80 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> FuelFab::GetMatlBids(
   Composition::Ptr c_fiss = c_fill;
   if (fiss.count() > 0) {
     c_fiss = fiss.Peek()->comp();
-    w_fiss = CosiWeight(c_fiss, spectrum);
+    w_fiss = CosiWeightCache::Get(c_fiss, spectrum);
   } else if (!fiss_recipe.empty()) {
     c_fiss = context()->GetRecipe(fiss_recipe);
-    w_fiss = CosiWeight(c_fiss, spectrum);
+    w_fiss = CosiWeightCache::Get(c_fiss, spectrum);
   }
 
+  // Many requesters ask for the same fuel recipe, so the target weight and
+  // mixing fractions are computed once per target composition.  Requests that
+  // also share a quantity get the very same offer material - offers are only
+  // ever read by the exchange.
+  std::map<int, BidMix> mixes;
+  std::map<std::pair<int, double>, Material::Ptr> offers;
+
   BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
   for (int j = 0; j < reqs.size(); j++) {
     cyclus::Request<Material>* req = reqs[j];
 
     Composition::Ptr tgt = req->target()->comp();
-    double w_tgt = CosiWeight(tgt, spectrum);
     double tgt_qty = req->target()->quantity();
-    if (ValidWeights(w_fill, w_tgt, w_fiss)) {
-      double fiss_frac = HighFrac(w_fill, w_tgt, w_fiss);
-      double fill_frac = 1 - fiss_frac;
-      fiss_frac = AtomToMassFrac(fiss_frac, c_fiss, c_fill);
-      fill_frac = AtomToMassFrac(fill_frac, c_fill, c_fiss);
-      Material::Ptr m1 = Material::CreateUntracked(fiss_frac * tgt_qty, c_fiss);
-      Material::Ptr m2 = Material::CreateUntracked(fill_frac * tgt_qty, c_fill);
-      m1->Absorb(m2);
 
-      bool exclusive = false;
-      port->AddBid(req, m1, this, exclusive);
-    } else if (topup.count() > 0 && ValidWeights(w_fiss, w_tgt, w_topup)) {
-      // only bid with topup if we have filler - otherwise we might be able to
-      // meet target with filler when we get it. we should only use topup
-      // when the fissile has too poor neutronics.
-      double topup_frac = HighFrac(w_fiss, w_tgt, w_topup);
-      double fiss_frac = 1 - topup_frac;
-      fiss_frac = AtomToMassFrac(fiss_frac, c_fiss, c_topup);
-      topup_frac = AtomToMassFrac(topup_frac, c_topup, c_fiss);
-      Material::Ptr m1 =
-          Material::CreateUntracked(topup_frac * tgt_qty, c_topup);
-      Material::Ptr m2 = Material::CreateUntracked(fiss_frac * tgt_qty, c_fiss);
-      m1->Absorb(m2);
+    std::map<int, BidMix>::iterator mix = mixes.find(tgt->id());
+    if (mix == mixes.end()) {
+      BidMix bm;
+      double w_tgt = CosiWeightCache::Get(tgt, spectrum);
+      if (ValidWeights(w_fill, w_tgt, w_fiss)) {
+        double fiss_frac = HighFrac(w_fill, w_tgt, w_fiss);
+        double fill_frac = 1 - fiss_frac;
+        bm.valid = true;
+        bm.c1 = c_fiss;
+        bm.c2 = c_fill;
+        bm.frac1 = AtomToMassFrac(fiss_frac, c_fiss, c_fill);
+        bm.frac2 = AtomToMassFrac(fill_frac, c_fill, c_fiss);
+      } else if (topup.count() > 0 && ValidWeights(w_fiss, w_tgt, w_topup)) {
+        // only bid with topup if we have filler - otherwise we might be able
+        // to meet target with filler when we get it. we should only use topup
+        // when the fissile has too poor neutronics.
+        double topup_frac = HighFrac(w_fiss, w_tgt, w_topup);
+        double fiss_frac = 1 - topup_frac;
+        bm.valid = true;
+        bm.c1 = c_topup;
+        bm.c2 = c_fiss;
+        bm.frac1 = AtomToMassFrac(topup_frac, c_topup, c_fiss);
+        bm.frac2 = AtomToMassFrac(fiss_frac, c_fiss, c_topup);
+      } else if (fiss.count() > 0 && fill.count() > 0 ||
+                 fiss.count() > 0 && topup.count() > 0) {
+        // else can't meet the target weight - don't bid.  Just a plain else
+        // doesn't work because we set w_fiss = w_fill if we don't have any
+        // fiss or fill inventory.
+        std::stringstream ss;
+        ss << "prototype '" << prototype()
+           << "': Input stream weights/reactivity do not span "
+              "the requested material weight.";
+        cyclus::Warn<cyclus::VALUE_WARNING>(ss.str());
+      }
+      mix = mixes.insert(std::make_pair(tgt->id(), bm)).first;
+    }
 
-      bool exclusive = false;
-      port->AddBid(req, m1, this, exclusive);
-    } else if (fiss.count() > 0 && fill.count() > 0 ||
-               fiss.count() > 0 && topup.count() > 0) {
-      // else can't meet the target weight - don't bid.  Just a plain else
-      // doesn't work because we set w_fiss = w_fill if we don't have any fiss
-      // or fill inventory.
-      std::stringstream ss;
-      ss << "prototype '" << prototype()
-         << "': Input stream weights/reactivity do not span "
-            "the requested material weight.";
-      cyclus::Warn<cyclus::VALUE_WARNING>(ss.str());
+    if (!mix->second.valid) {
+      continue;
+    }
+
+    std::pair<int, double> key(tgt->id(), tgt_qty);
+    std::map<std::pair<int, double>, Material::Ptr>::iterator offer =
+        offers.find(key);
+    if (offer == offers.end()) {
+      const BidMix& bm = mix->second;
+      Material::Ptr m1 = Material::CreateUntracked(bm.frac1 * tgt_qty, bm.c1);
+      Material::Ptr m2 = Material::CreateUntracked(bm.frac2 * tgt_qty, bm.c2);
+      m1->Absorb(m2);
+      offer = offers.insert(std::make_pair(key, m1)).first;
     }
+
+    bool exclusive = false;
+    port->AddBid(req, offer->second, this, exclusive);
   }
 
   cyclus::Converter<Material>::Ptr fissconv(
@@ -395,21 +463,22 @@ void FuelFab::GetMatlTrades(
     const std::vector<cyclus::Trade<Material> >& trades,
     std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
         responses) {
+  CYCAMORE_PERF_SCOPE("GetMatlTrades");
   using cyclus::Trade;
 
   // guard against cases where a buffer is empty - this is okay because some
   // trades may not need that particular buffer.
   double w_fill = 0;
   if (fill.count() > 0) {
-    w_fill = CosiWeight(fill.Peek()->comp(), spectrum);
+    w_fill = CosiWeightCache::Get(fill.Peek()->comp(), spectrum);
   }
   double w_topup = 0;
   if (topup.count() > 0) {
-    w_topup = CosiWeight(topup.Peek()->comp(), spectrum);
+    w_topup = CosiWeightCache::Get(topup.Peek()->comp(), spectrum);
   }
   double w_fiss = 0;
   if (fiss.count() > 0) {
-    w_fiss = CosiWeight(fiss.Peek()->comp(), spectrum);
+    w_fiss = CosiWeightCache::Get(fiss.Peek()->comp(), spectrum);
   }
 
   std::vector<cyclus::Trade<cyclus::Material> >::const_iterator it;
@@ -417,7 +486,7 @@ void FuelFab::GetMatlTrades(
   for (int i = 0; i < trades.size(); i++) {
     Material::Ptr tgt = trades[i].request->target();
 
-    double w_tgt = CosiWeight(tgt->comp(), spectrum);
+    double w_tgt = CosiWeightCache::Get(tgt->comp(), spectrum);
     double qty = trades[i].amt;
     double wfiss = w_fiss;
 
@@ -525,174 +594,196 @@ extern "C" cyclus::Agent* ConstructFuelFab(cyclus::Context* ctx) {
 // material/mixing fractions will also be atom-based naturally and will need
 // to be converted to mass-based for actual material object mixing.
 double CosiWeight(cyclus::Composition::Ptr c, const std::string& spectrum) {
-  cyclus::CompMap cm = c->atom();
-  cyclus::compmath::Normalize(&cm);
-
-  if (spectrum == "thermal") {
-    double nu_pu239 = 2.85;
-    double nu_u233 = 2.5;
-    double nu_u235 = 2.43;
-    double nu_u238 = 0;
-    double nu_pu241 = nu_pu239;
-
-    static std::map<int, double> absorb_xs;
-    static std::map<int, double> fiss_xs;
-    static double p_u238 = 0;
-    static double p_pu239 = 0;
-    if (p_u238 == 0) {
-      double fiss_u238 = simple_xs(922380000, "fission", "thermal");
-      double absorb_u238 = simple_xs(922380000, "absorption", "thermal");
-      p_u238 = nu_u238 * fiss_u238 - absorb_u238;
-
-      double fiss_pu239 = simple_xs(942390000, "fission", "thermal");
-      double absorb_pu239 = simple_xs(942390000, "absorption", "thermal");
-      p_pu239 = nu_pu239 * fiss_pu239 - absorb_pu239;
-    }
+  return CosiXSTable::Get(spectrum).Weight(c->atom());
+}
 
-    cyclus::CompMap::iterator it;
-    double w = 0;
-    for (it = cm.begin(); it != cm.end(); ++it) {
-      cyclus::Nuc nuc = it->first;
-      double nu = 0;
-      if (nuc == 922350000) {
-        nu = nu_u235;
-      } else if (nuc == 922330000) {
-        nu = nu_u233;
-      } else if (nuc == 942390000) {
-        nu = nu_pu239;
-      } else if (nuc == 942410000) {
-        nu = nu_pu241;
-      }
+std::map<std::string, CosiXSTable> CosiXSTable::tables_;
+std::mutex CosiXSTable::mutex_;
 
-      double fiss = 0;
-      double absorb = 0;
-      if (absorb_xs.count(nuc) == 0) {
-        try {
-          fiss = simple_xs(nuc, "fission", "thermal");
-          absorb = simple_xs(nuc, "absorption", "thermal");
-          absorb_xs[nuc] = absorb;
-          fiss_xs[nuc] = fiss;
-        } catch (pyne::InvalidSimpleXS err) {
-          fiss = 0;
-          absorb = 0;
-        }
-      } else {
-        fiss = fiss_xs[nuc];
-        absorb = absorb_xs[nuc];
-      }
+CosiXSTable& CosiXSTable::Get(const std::string& spectrum) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<std::string, CosiXSTable>::iterator it = tables_.find(spectrum);
+  if (it == tables_.end()) {
+    it = tables_.insert(std::make_pair(spectrum, CosiXSTable(spectrum))).first;
+  }
+  return it->second;
+}
+
+CosiXSTable::CosiXSTable(const std::string& spectrum) : spectrum_(spectrum) {
+  // these are not guarded by P's InvalidSimpleXS handling - an unknown
+  // spectrum is an error
+  p_u238_ = Nu(922380000) * simple_xs(922380000, "fission", spectrum) -
+            simple_xs(922380000, "absorption", spectrum);
+  p_pu239_ = Nu(942390000) * simple_xs(942390000, "fission", spectrum) -
+             simple_xs(942390000, "absorption", spectrum);
+}
+
+double CosiXSTable::Nu(cyclus::Nuc nuc) const {
+  bool thermal = spectrum_ == "thermal";
+  if (nuc == 922350000) {
+    return thermal ? 2.43 : 2.58;
+  } else if (nuc == 922330000) {
+    return thermal ? 2.5 : 2.63;
+  } else if (nuc == 942390000 || nuc == 942410000) {
+    return thermal ? 2.85 : 3.1;
+  }
+  return 0;
+}
+
+double CosiXSTable::P(cyclus::Nuc nuc) const {
+  try {
+    double fiss = simple_xs(nuc, "fission", spectrum_);
+    double absorb = simple_xs(nuc, "absorption", spectrum_);
+    return Nu(nuc) * fiss - absorb;
+  } catch (pyne::InvalidSimpleXS err) {
+    return 0;
+  }
+}
+
+int CosiXSTable::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return nucs_.size();
+}
 
-      double p = nu * fiss - absorb;
-      w += it->second * (p - p_u238) / (p_pu239 - p_u238);
+void CosiXSTable::Add(const cyclus::CompMap& v) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Add_(v);
+}
+
+void CosiXSTable::Add_(const cyclus::CompMap& v) {
+  std::vector<cyclus::Nuc> missing;
+  cyclus::CompMap::const_iterator it;
+  for (it = v.begin(); it != v.end(); ++it) {
+    if (!std::binary_search(nucs_.begin(), nucs_.end(), it->first)) {
+      missing.push_back(it->first);
     }
-    return w;
-  } else if (spectrum == "fission_spectrum_ave") {
-    double nu_pu239 = 3.1;
-    double nu_u233 = 2.63;
-    double nu_u235 = 2.58;
-    double nu_u238 = 0;
-    double nu_pu241 = nu_pu239;
-
-    static std::map<int, double> absorb_xs;
-    static std::map<int, double> fiss_xs;
-    static double p_u238 = 0;
-    static double p_pu239 = 0;
-    if (p_u238 == 0) {
-      double fiss_u238 =
-          simple_xs(922380000, "fission", "fission_spectrum_ave");
-      double absorb_u238 =
-          simple_xs(922380000, "absorption", "fission_spectrum_ave");
-      p_u238 = nu_u238 * fiss_u238 - absorb_u238;
-
-      double fiss_pu239 =
-          simple_xs(942390000, "fission", "fission_spectrum_ave");
-      double absorb_pu239 =
-          simple_xs(942390000, "absorption", "fission_spectrum_ave");
-      p_pu239 = nu_pu239 * fiss_pu239 - absorb_pu239;
+  }
+  if (missing.empty()) {
+    return;
+  }
+
+  // CompMap iteration order is sorted, so missing is too - merge it in.
+  std::vector<cyclus::Nuc> nucs;
+  std::vector<double> weights;
+  nucs.reserve(nucs_.size() + missing.size());
+  weights.reserve(nucs_.size() + missing.size());
+  int i = 0;
+  int j = 0;
+  while (i < nucs_.size() || j < missing.size()) {
+    if (j == missing.size() || (i < nucs_.size() && nucs_[i] < missing[j])) {
+      nucs.push_back(nucs_[i]);
+      weights.push_back(weights_[i]);
+      i++;
+    } else {
+      nucs.push_back(missing[j]);
+      weights.push_back((P(missing[j]) - p_u238_) / (p_pu239_ - p_u238_));
+      j++;
     }
+  }
+  nucs_.swap(nucs);
+  weights_.swap(weights);
+}
 
-    cyclus::CompMap::iterator it;
-    double w = 0;
-    for (it = cm.begin(); it != cm.end(); ++it) {
-      cyclus::Nuc nuc = it->first;
-      double nu = 0;
-      if (nuc == 922350000) {
-        nu = nu_u235;
-      } else if (nuc == 922330000) {
-        nu = nu_u233;
-      } else if (nuc == 942390000) {
-        nu = nu_pu239;
-      } else if (nuc == 942410000) {
-        nu = nu_pu241;
-      }
+double CosiXSTable::Weight(const cyclus::CompMap& v) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Add_(v);
 
-      double fiss = 0;
-      double absorb = 0;
-      if (absorb_xs.count(nuc) == 0) {
-        try {
-          fiss = simple_xs(nuc, "fission", "fission_spectrum_ave");
-          absorb = simple_xs(nuc, "absorption", "fission_spectrum_ave");
-          absorb_xs[nuc] = absorb;
-          fiss_xs[nuc] = fiss;
-        } catch (pyne::InvalidSimpleXS err) {
-          fiss = 0;
-          absorb = 0;
-        }
-      } else {
-        fiss = fiss_xs[nuc];
-        absorb = absorb_xs[nuc];
-      }
+  double sum = 0;
+  cyclus::CompMap::const_iterator it;
+  for (it = v.begin(); it != v.end(); ++it) {
+    sum += it->second;
+  }
+  // match compmath::Normalize, which leaves zero and unit sums untouched
+  bool norm = sum != 0 && sum != 1;
+
+  // both sides are sorted by nuclide, so one forward pass finds every entry
+  double w = 0;
+  int j = 0;
+  for (it = v.begin(); it != v.end(); ++it) {
+    while (nucs_[j] != it->first) {
+      j++;
+    }
+    double n = norm ? it->second / sum : it->second;
+    w += n * weights_[j];
+  }
+  return w;
+}
 
-      double p = nu * fiss - absorb;
-      w += it->second * (p - p_u238) / (p_pu239 - p_u238);
+CosiWeightCache::WeightList CosiWeightCache::lru_;
+std::map<CosiWeightCache::Key, CosiWeightCache::WeightList::iterator>
+    CosiWeightCache::index_;
+int CosiWeightCache::capacity_ = 10000;
+unsigned long CosiWeightCache::hits_ = 0;
+unsigned long CosiWeightCache::misses_ = 0;
+std::mutex CosiWeightCache::mutex_;
+
+double CosiWeightCache::Get(cyclus::Composition::Ptr c,
+                            const std::string& spectrum) {
+  Key k(spectrum, c->id());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::map<Key, WeightList::iterator>::iterator it = index_.find(k);
+    if (it != index_.end()) {
+      hits_++;
+      lru_.splice(lru_.begin(), lru_, it->second);
+      return it->second->second;
     }
-    return w;
-  } else {
-    double nu_pu239 = 3.1;
-    double nu_u233 = 2.63;
-    double nu_u235 = 2.58;
-    double nu_u238 = 0;
-    double nu_pu241 = nu_pu239;
-
-    double fiss_u238 = simple_xs(922380000, "fission", spectrum);
-    double absorb_u238 = simple_xs(922380000, "absorption", spectrum);
-    double p_u238 = nu_u238 * fiss_u238 - absorb_u238;
-
-    double fiss_pu239 = simple_xs(942390000, "fission", spectrum);
-    double absorb_pu239 = simple_xs(942390000, "absorption", spectrum);
-    double p_pu239 = nu_pu239 * fiss_pu239 - absorb_pu239;
-
-    cyclus::CompMap::iterator it;
-    double w = 0;
-    for (it = cm.begin(); it != cm.end(); ++it) {
-      cyclus::Nuc nuc = it->first;
-      double nu = 0;
-      if (nuc == 922350000) {
-        nu = nu_u235;
-      } else if (nuc == 922330000) {
-        nu = nu_u233;
-      } else if (nuc == 942390000) {
-        nu = nu_pu239;
-      } else if (nuc == 942410000) {
-        nu = nu_pu241;
-      }
+    misses_++;
+  }
 
-      double fiss = 0;
-      double absorb = 0;
-      try {
-        fiss = simple_xs(nuc, "fission", spectrum);
-        absorb = simple_xs(nuc, "absorption", spectrum);
-      } catch (pyne::InvalidSimpleXS err) {
-        fiss = 0;
-        absorb = 0;
-      }
+  // computed unlocked - threads racing on a new composition store the same
+  // weight
+  double w = CosiWeight(c, spectrum);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (index_.count(k) == 0) {
+    lru_.push_front(std::make_pair(k, w));
+    index_[k] = lru_.begin();
+    Evict_();
+  }
+  return w;
+}
 
-      double p = nu * fiss - absorb;
-      w += it->second * (p - p_u238) / (p_pu239 - p_u238);
-    }
-    return w;
+void CosiWeightCache::Evict_() {
+  while (lru_.size() > capacity_) {
+    index_.erase(lru_.back().first);
+    lru_.pop_back();
   }
 }
 
+void CosiWeightCache::capacity(int n) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = std::max(0, n);
+  Evict_();
+}
+
+int CosiWeightCache::capacity() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return capacity_;
+}
+
+int CosiWeightCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return lru_.size();
+}
+
+void CosiWeightCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_.clear();
+  index_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+unsigned long CosiWeightCache::hits() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
+
+unsigned long CosiWeightCache::misses() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return misses_;
+}
+
 // Convert an atom frac (n1/(n1+n2) to a mass frac (m1/(m1+m2) given
 // corresponding compositions c1 and c2.
 double AtomToMassFrac(double atomfrac, Composition::Ptr c1,
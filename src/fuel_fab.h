@@ -1,9 +1,17 @@
 #ifndef CYCAMORE_SRC_FUEL_FAB_H_
 #define CYCAMORE_SRC_FUEL_FAB_H_
 
+#include <list>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -114,7 +122,7 @@ class FuelFab
 #pragma cyclus
 
   virtual void Tick(){};
-  virtual void Tock(){};
+  virtual void Tock();
   virtual void EnterNotify();
 
   virtual std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> GetMatlBids(
@@ -249,6 +257,16 @@ class FuelFab
   }
   std::string spectrum;
 
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
+
   // intra-time-step state - no need to be a state var
   // map<request, inventory name>
   std::map<cyclus::Request<cyclus::Material>*, std::string> req_inventories_;
@@ -273,9 +291,126 @@ class FuelFab
 
   /// Records an agent's latitude and longitude to the output db
   void RecordPosition();
+
+  /// request targets shared between requests and time steps
+  UntrackedPool pool_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 double CosiWeight(cyclus::Composition::Ptr c, const std::string& spectrum);
+
+/// CosiXSTable holds the one group nuclide data needed by CosiWeight for a
+/// single cross section spectrum.  For every nuclide seen it stores the
+/// already normalized per-atom weight
+///
+///     (p_i - p_U238) / (p_Pu239 - p_U238),  p = nu*sigma_f - sigma_a
+///
+/// in flat arrays sorted by nuclide id, so that a composition's weight is a
+/// single merge-join dot product against its atom fractions.  There is one
+/// shared table per spectrum; FuelFab primes its table with its recipe
+/// nuclides on EnterNotify and any nuclide not seen before is added on
+/// demand.  Nuclides without PyNE simple cross section data get p = 0.
+///
+/// All tables are guarded by one mutex, so they may be used from several
+/// threads at once.  This also serializes the PyNE cross section lookups,
+/// which are not thread safe themselves.
+class CosiXSTable {
+ public:
+  /// Returns the shared table for spectrum, building it on first use.  Throws
+  /// pyne::InvalidSimpleXS if the spectrum is not known to PyNE.
+  static CosiXSTable& Get(const std::string& spectrum);
+
+  /// Adds entries for any nuclides in v that are not already in the table.
+  void Add(const cyclus::CompMap& v);
+
+  /// Returns the weight of the (not necessarily normalized) atom vector v.
+  double Weight(const cyclus::CompMap& v);
+
+  /// Number of nuclides currently tabulated.
+  int size() const;
+
+  const std::string& spectrum() const { return spectrum_; }
+
+ private:
+  explicit CosiXSTable(const std::string& spectrum);
+
+  /// Returns the average number of neutrons per fission used for nuc.
+  double Nu(cyclus::Nuc nuc) const;
+
+  /// Returns nu*sigma_f - sigma_a for nuc, or 0 if PyNE has no data for it.
+  double P(cyclus::Nuc nuc) const;
+
+  /// Add without locking mutex_.
+  void Add_(const cyclus::CompMap& v);
+
+  std::string spectrum_;
+  double p_u238_;
+  double p_pu239_;
+
+  // parallel arrays sorted by nuclide id
+  std::vector<cyclus::Nuc> nucs_;
+  std::vector<double> weights_;
+
+  static std::map<std::string, CosiXSTable> tables_;
+  static std::mutex mutex_;
+};
+
+/// CosiWeightCache memoizes CosiWeight results per spectrum, keyed by
+/// composition id.  Compositions are immutable and their ids are never
+/// reused, so a cached weight can never go stale.  The cache is shared by all
+/// FuelFab instances (and their converters) in the process, which means each
+/// recipe's weight is computed only once no matter how many facilities,
+/// requests, trades or constraint conversions reference it.  Every new
+/// composition traded (e.g. each batch of spent fuel) adds an entry, so only
+/// the capacity() most recently used weights are kept.  The cache is guarded
+/// by a mutex and may be used from several threads at once.
+class CosiWeightCache {
+ public:
+  /// Returns the weight of c for the given spectrum, only calling CosiWeight
+  /// if the composition is not cached for that spectrum.
+  static double Get(cyclus::Composition::Ptr c, const std::string& spectrum);
+
+  /// Sets the maximum number of cached weights, dropping the least recently
+  /// used ones beyond it.
+  static void capacity(int n);
+  static int capacity();
+
+  /// Number of weights currently cached.
+  static int size();
+
+  /// Drops all cached weights and resets the hit/miss counters.
+  static void Clear();
+
+  /// Number of lookups answered from the cache.
+  static unsigned long hits();
+
+  /// Number of lookups that required computing a weight.
+  static unsigned long misses();
+
+ private:
+  // (spectrum, composition id)
+  typedef std::pair<std::string, int> Key;
+  typedef std::list<std::pair<Key, double> > WeightList;
+
+  /// Drops the least recently used weights beyond capacity_.
+  static void Evict_();
+
+  // most recently used first, with an index by key
+  static WeightList lru_;
+  static std::map<Key, WeightList::iterator> index_;
+  static int capacity_;
+  static unsigned long hits_;
+  static unsigned long misses_;
+  static std::mutex mutex_;
+};
+
 bool ValidWeights(double w_low, double w_tgt, double w_high);
 double LowFrac(double w_low, double w_tgt, double w_high, double eps = 1e-6);
 double HighFrac(double w_low, double w_tgt, double w_high, double eps = 1e-6);
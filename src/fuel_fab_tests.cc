@@ -2,6 +2,7 @@
 
 #include <gtest/gtest.h>
 #include <sstream>
+#include <thread>
 #include "cyclus.h"
 
 using pyne::nucname::id;
@@ -141,6 +142,135 @@ TEST(FuelFabTests, CosiWeight_Mixed) {
   EXPECT_LT(std::abs((w_target-got)/w_target), 0.00001) << "mixed composition not within 0.001% of target";
 }
 
+TEST(FuelFabTests, CosiWeightCache) {
+  cyclus::Env::SetNucDataPath();
+  CosiWeightCache::Clear();
+  Composition::Ptr c = c_pustream();
+
+  double w = CosiWeightCache::Get(c, "thermal");
+  EXPECT_DOUBLE_EQ(CosiWeight(c, "thermal"), w);
+  EXPECT_EQ(0ul, CosiWeightCache::hits());
+  EXPECT_EQ(1ul, CosiWeightCache::misses());
+
+  EXPECT_DOUBLE_EQ(w, CosiWeightCache::Get(c, "thermal"));
+  EXPECT_EQ(1ul, CosiWeightCache::hits());
+  EXPECT_EQ(1ul, CosiWeightCache::misses());
+
+  // weights are cached separately for each spectrum
+  double w_fast = CosiWeightCache::Get(c, "fission_spectrum_ave");
+  EXPECT_DOUBLE_EQ(CosiWeight(c, "fission_spectrum_ave"), w_fast);
+  EXPECT_EQ(1ul, CosiWeightCache::hits());
+  EXPECT_EQ(2ul, CosiWeightCache::misses());
+
+  // identical nuclide vectors in a different composition object get their
+  // own entry
+  CosiWeightCache::Get(c_pustream(), "thermal");
+  EXPECT_EQ(3ul, CosiWeightCache::misses());
+  EXPECT_EQ(3, CosiWeightCache::size());
+
+  CosiWeightCache::Clear();
+  EXPECT_EQ(0ul, CosiWeightCache::hits());
+  EXPECT_EQ(0ul, CosiWeightCache::misses());
+  EXPECT_EQ(0, CosiWeightCache::size());
+}
+
+TEST(FuelFabTests, CosiWeightCacheCapacity) {
+  cyclus::Env::SetNucDataPath();
+  CosiWeightCache::Clear();
+  int cap = CosiWeightCache::capacity();
+  CosiWeightCache::capacity(2);
+  Composition::Ptr c1 = c_pustream();
+  Composition::Ptr c2 = c_pustream();
+  Composition::Ptr c3 = c_pustream();
+
+  // only the most recently used weights are kept
+  CosiWeightCache::Get(c1, "thermal");
+  CosiWeightCache::Get(c2, "thermal");
+  CosiWeightCache::Get(c1, "thermal");
+  CosiWeightCache::Get(c3, "thermal");
+  EXPECT_EQ(2, CosiWeightCache::size());
+  EXPECT_EQ(1ul, CosiWeightCache::hits());
+  EXPECT_EQ(3ul, CosiWeightCache::misses());
+
+  CosiWeightCache::Get(c1, "thermal");
+  EXPECT_EQ(2ul, CosiWeightCache::hits());
+  CosiWeightCache::Get(c2, "thermal");
+  EXPECT_EQ(4ul, CosiWeightCache::misses());
+
+  CosiWeightCache::capacity(cap);
+  CosiWeightCache::Clear();
+}
+
+TEST(FuelFabTests, CosiWeightCacheThreads) {
+  cyclus::Env::SetNucDataPath();
+  CosiWeightCache::Clear();
+
+  // compositions are created (and their atom vectors computed) up front -
+  // cyclus does not create compositions thread safely
+  std::vector<Composition::Ptr> comps;
+  for (int i = 0; i < 50; i++) {
+    CompMap v;
+    v[id("u238")] = 1;
+    v[id("pu239")] = 0.01 * (i + 1);
+    v[id("am241")] = 0.001 * (i % 5);
+    comps.push_back(Composition::CreateFromAtom(v));
+    comps.back()->atom();
+  }
+
+  int nthreads = 4;
+  std::vector<std::vector<double> > got(nthreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; t++) {
+    threads.push_back(std::thread([&comps, &got, t]() {
+      for (int i = 0; i < comps.size(); i++) {
+        got[t].push_back(CosiWeightCache::Get(comps[i], "thermal"));
+      }
+    }));
+  }
+  for (int t = 0; t < nthreads; t++) {
+    threads[t].join();
+  }
+
+  for (int i = 0; i < comps.size(); i++) {
+    double w = CosiWeight(comps[i], "thermal");
+    for (int t = 0; t < nthreads; t++) {
+      EXPECT_DOUBLE_EQ(w, got[t][i]);
+    }
+  }
+  EXPECT_EQ(nthreads * comps.size(),
+            CosiWeightCache::hits() + CosiWeightCache::misses());
+  CosiWeightCache::Clear();
+}
+
+TEST(FuelFabTests, CosiXSTable) {
+  cyclus::Env::SetNucDataPath();
+  CosiXSTable& xs = CosiXSTable::Get("thermal");
+  EXPECT_EQ(&xs, &CosiXSTable::Get("thermal"));
+  EXPECT_EQ("thermal", xs.spectrum());
+
+  CompMap v;
+  v[id("pu239")] = 1;
+  xs.Add(v);
+  int n = xs.size();
+  xs.Add(v);
+  EXPECT_EQ(n, xs.size());
+  EXPECT_DOUBLE_EQ(1.0, xs.Weight(v));
+
+  // atom vectors don't need to be normalized
+  v[id("u238")] = 3;
+  EXPECT_DOUBLE_EQ(0.25, xs.Weight(v));
+
+  // unseen nuclides are tabulated on demand
+  CompMap pu = c_pustream()->atom();
+  EXPECT_DOUBLE_EQ(CosiWeight(c_pustream(), "thermal"), xs.Weight(pu));
+  EXPECT_GE(xs.size(), n + 3);
+
+  // custom spectra get their own table
+  EXPECT_EQ("fourteen_MeV", CosiXSTable::Get("fourteen_MeV").spectrum());
+  EXPECT_DOUBLE_EQ(0.25,
+                   CosiWeight(Composition::CreateFromAtom(v), "fourteen_MeV"));
+}
+
 TEST(FuelFabTests, HighFrac) {
   cyclus::Env::SetNucDataPath();
   double w_fill = CosiWeight(c_natu(), "thermal");
@@ -586,6 +716,51 @@ TEST(FuelFabTests, FillConstrained) {
   EXPECT_NEAR(max_provide, m->quantity(), 1e-10) << "matched trade uses more fill than available";
 }
 
+// requests for the same recipe share mixing fractions and offers - each
+// requester must still get its own correctly mixed material
+TEST(FuelFabTests, SharedTargetRequests) {
+  cyclus::Env::SetNucDataPath();
+  std::string config =
+     "<fill_commods> <val>natu</val> </fill_commods>"
+     "<fill_recipe>natu</fill_recipe>"
+     "<fill_size>100</fill_size>"
+     ""
+     "<fiss_commods> <val>pustream</val> </fiss_commods>"
+     "<fiss_recipe>pustream</fiss_recipe>"
+     "<fiss_size>100</fiss_size>"
+     ""
+     "<outcommod>recyclefuel</outcommod>"
+     "<spectrum>thermal</spectrum>"
+     "<throughput>100</throughput>"
+     ;
+  int simdur = 3;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:FuelFab"), config, simdur);
+  sim.AddSource("pustream").Finalize();
+  sim.AddSource("natu").Finalize();
+  sim.AddSink("recyclefuel").recipe("uox").capacity(10).lifetime(2).Finalize();
+  sim.AddSink("recyclefuel").recipe("uox").capacity(10).lifetime(2).Finalize();
+  sim.AddSink("recyclefuel").recipe("uox").capacity(5).lifetime(2).Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("pustream", c_pustream());
+  sim.AddRecipe("natu", c_natu());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("Commodity", "==", std::string("recyclefuel")));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(3, qr.rows.size());
+
+  double w_target = CosiWeight(c_uox(), "thermal");
+  double tot = 0;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    double got = CosiWeight(m->comp(), "thermal");
+    EXPECT_LT(std::abs((w_target-got)/w_target), 0.00001) << "mixed composition not within 0.001% of target";
+    tot += m->quantity();
+  }
+  EXPECT_NEAR(25, tot, 1e-6);
+}
+
 // fuel is requested requiring more fissile material than is available with
 // plenty of filler.
 TEST(FuelFabTests, FissConstrained) {
@@ -1,10 +1,61 @@
 // Implements the GrowthRegion class
 #include "growth_region.h"
 
+#include <algorithm>
+#include <sstream>
+
+#include "manager_inst.h"
+
 namespace cycamore {
 
+// time steps of a demand curve tabulated at most, beyond that curves are
+// evaluated from their pieces
+static const int kMaxDemandTable = 1 << 16;
+
+void DemandCurve::Compile(const Demand& demand, int n_table) {
+  starts_.clear();
+  offsets_.clear();
+  fns_.clear();
+  table_.clear();
+
+  cyclus::toolkit::BasicFunctionFactory bff;
+  Demand::const_iterator it;
+  for (it = demand.begin(); it != demand.end(); ++it) {
+    double start = it->first;
+    if (!starts_.empty() && start <= starts_.back()) {
+      std::stringstream ss;
+      ss << "demand pieces must start at increasing times, got " << start
+         << " after " << starts_.back();
+      throw cyclus::ValueError(ss.str());
+    }
+    cyclus::toolkit::FunctionPtr f =
+        bff.GetFunctionPtr(it->second.first, it->second.second);
+    // only the first piece is not made continuous with the previous one
+    double offset = starts_.empty() ? 0 : Eval(start) - f->value(0);
+    starts_.push_back(start);
+    offsets_.push_back(offset);
+    fns_.push_back(f);
+  }
+
+  table_.resize(std::max(0, n_table));
+  for (int t = 0; t < table_.size(); t++) {
+    table_[t] = Eval(t);
+  }
+}
+
+double DemandCurve::Eval(double x) const {
+  if (starts_.empty() || x < starts_.front()) {
+    return 0;
+  }
+  int i = std::upper_bound(starts_.begin(), starts_.end(), x) -
+          starts_.begin() - 1;
+  return fns_[i]->value(x - starts_[i]) + offsets_[i];
+}
+
 GrowthRegion::GrowthRegion(cyclus::Context* ctx)
     : cyclus::Region(ctx),
+      build_horizon(0),
+      plan_tolerance(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {
@@ -37,10 +88,20 @@ void GrowthRegion::AddCommodityDemand_(std::string commod,
   // register the commodity and demand
   cyclus::toolkit::Commodity c(commod);
   sdmanager_.RegisterCommodity(c, pff.GetFunctionPtr());
+
+  // the table covers the build plans of the simulation's last time step
+  int n_table = context()->sim_info().duration + build_horizon + 1;
+  curves_[commod].Compile(demand, std::min(n_table, kMaxDemandTable));
 }
 
 void GrowthRegion::EnterNotify() {
   cyclus::Region::EnterNotify();
+  if (build_horizon < 0) {
+    throw cyclus::ValueError("build_horizon must be non-negative");
+  } else if (plan_tolerance < 0) {
+    throw cyclus::ValueError("plan_tolerance must be non-negative");
+  }
+
   std::set<cyclus::Agent*>::iterator ait;
   for (ait = cyclus::Agent::children().begin();
        ait != cyclus::Agent::children().end();
@@ -73,6 +134,12 @@ void GrowthRegion::Register_(cyclus::Agent* agent) {
                                    << agent->prototype() << agent->id()
                                    << " as a commodity producer manager.";
     sdmanager_.RegisterProducerManager(cpm_cast);
+    ManagerInst* mi_cast = dynamic_cast<ManagerInst*>(agent);
+    if (mi_cast != NULL) {
+      insts_.insert(mi_cast);
+    } else {
+      managers_.insert(cpm_cast);
+    }
   }
 
   Builder* b_cast = dynamic_cast<Builder*>(agent);
@@ -94,8 +161,11 @@ void GrowthRegion::Unregister_(cyclus::Agent* agent) {
 #if CYCLUS_HAS_COIN
   CommodityProducerManager* cpm_cast =
     dynamic_cast<CommodityProducerManager*>(agent);
-  if (cpm_cast != NULL)
+  if (cpm_cast != NULL) {
     sdmanager_.UnregisterProducerManager(cpm_cast);
+    insts_.erase(dynamic_cast<ManagerInst*>(agent));
+    managers_.erase(cpm_cast);
+  }
 
   Builder* b_cast = dynamic_cast<Builder*>(agent);
   if (b_cast != NULL)
@@ -107,15 +177,17 @@ void GrowthRegion::Unregister_(cyclus::Agent* agent) {
 }
 
 void GrowthRegion::Tick() {
+  CYCAMORE_PERF_SCOPE("Tick");
   double demand, supply, unmetdemand;
   cyclus::toolkit::Commodity commod;
   int time = context()->time();
   std::map<std::string, Demand>::iterator it;
   for (it = commodity_demand.begin(); it != commodity_demand.end(); ++it) {
     commod = cyclus::toolkit::Commodity(it->first);
-    demand = sdmanager_.Demand(commod, time);
-    supply = sdmanager_.Supply(commod);
+    demand = Demand_(it->first, time);
+    supply = Supply_(commod);
     unmetdemand = demand - supply;
+    std::map<int, double> orders = PlanBuilds_(commod, time, supply);
 
     LOG(cyclus::LEV_INFO3, "greg") << "GrowthRegion: " << prototype()
                                    << " at time: " << time
@@ -125,15 +197,86 @@ void GrowthRegion::Tick() {
     LOG(cyclus::LEV_INFO3, "greg") << "  * supply = " << supply;
     LOG(cyclus::LEV_INFO3, "greg") << "  * unmet demand = " << unmetdemand;
 
-    if (unmetdemand > 0) {
-      OrderBuilds(commod, unmetdemand);
+    std::map<int, double>::iterator oit;
+    for (oit = orders.begin(); oit != orders.end(); ++oit) {
+      OrderBuilds(commod, oit->second, oit->first);
     }
   }
   cyclus::Region::Tick();
 }
 
+double GrowthRegion::Demand_(const std::string& commod, int time) {
+  return curves_[commod].Value(time);
+}
+
+std::map<int, double> GrowthRegion::PlanBuilds_(
+    const cyclus::toolkit::Commodity& commod, int time, double supply) {
+  std::map<int, double> orders;
+  const std::string& name = commod.name();
+  double unmet = Demand_(name, time) - supply;
+  if (build_horizon == 0) {
+    if (unmet > 0) {
+      orders[time + 1] = unmet;
+    }
+    return orders;
+  }
+
+  // builds of earlier plans up to now are part of the supply
+  std::map<int, double>& planned = planned_builds[name];
+  planned.erase(planned.begin(), planned.upper_bound(time));
+
+  // keep to the current plan unless it has drifted
+  std::map<std::string, int>::iterator it = plan_ends.find(name);
+  if (it != plan_ends.end() && time <= it->second && unmet <= plan_tolerance) {
+    return orders;
+  }
+
+  // order each rise of the unmet demand for the time step it is needed at,
+  // counting the builds still to come of earlier plans. Builds cannot be
+  // scheduled before the next time step.
+  double pending = 0;
+  double ordered = 0;
+  std::map<int, double>::iterator pit = planned.begin();
+  for (int t = time; t <= time + build_horizon; t++) {
+    for (; pit != planned.end() && pit->first <= t; ++pit) {
+      pending += pit->second;
+    }
+    double need = Demand_(name, t) - supply - pending - ordered;
+    if (need > 0) {
+      orders[std::max(t, time + 1)] += need;
+      ordered += need;
+    }
+  }
+  plan_ends[name] = time + build_horizon;
+
+  std::map<int, double>::iterator oit;
+  for (oit = orders.begin(); oit != orders.end(); ++oit) {
+    planned[oit->first] += oit->second;
+  }
+
+  LOG(cyclus::LEV_INFO3, "greg") << "GrowthRegion: " << prototype()
+                                 << " planning builds of " << name
+                                 << " through time " << time + build_horizon
+                                 << " for an unmet demand of " << ordered
+                                 << " at " << orders.size() << " time(s)";
+  return orders;
+}
+
+double GrowthRegion::Supply_(const cyclus::toolkit::Commodity& commod) {
+  double supply = 0;
+  std::set<ManagerInst*>::iterator iit;
+  for (iit = insts_.begin(); iit != insts_.end(); ++iit) {
+    supply += (*iit)->ProducedCapacity(commod);
+  }
+  std::set<cyclus::toolkit::CommodityProducerManager*>::iterator mit;
+  for (mit = managers_.begin(); mit != managers_.end(); ++mit) {
+    supply += (*mit)->TotalCapacity(commod);
+  }
+  return supply;
+}
+
 void GrowthRegion::OrderBuilds(cyclus::toolkit::Commodity& commodity,
-                               double unmetdemand) {
+                               double unmetdemand, int time) {
 #if CYCLUS_HAS_COIN
   using std::vector;
   vector<cyclus::toolkit::BuildOrder> orders =
@@ -163,9 +306,10 @@ void GrowthRegion::OrderBuilds(cyclus::toolkit::Commodity& commodity,
         << " from builder " << instcast->prototype()
         << " is being placed.";
 
+    const std::string& proto = agentcast->prototype();
     for (int j = 0; j < order->number; j++) {
       LOG(cyclus::LEV_DEBUG2, "greg") << "Ordering build number: " << j + 1;
-      context()->SchedBuild(instcast, agentcast->prototype());
+      context()->SchedBuild(instcast, proto, time);
     }
   }
 #else
@@ -7,10 +7,12 @@
 
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
 
 // forward declarations
 namespace cycamore {
 class GrowthRegion;
+class ManagerInst;
 }  // namespace cycamore
 
 // forward includes
@@ -22,6 +24,41 @@ namespace cycamore {
 typedef std::vector<
   std::pair<int, std::pair<std::string, std::string> > > Demand;
 
+/// DemandCurve is a demand function compiled from its Demand pieces once, so
+/// that evaluating it costs neither the piecewise function's search through
+/// its pieces nor a function factory.  The pieces' start times are kept in a
+/// sorted array next to each piece's basic function (see
+/// cyclus::toolkit::BasicFunctionFactory) and the offset that makes the
+/// curve continuous at the piece's start, exactly as
+/// cyclus::toolkit::PiecewiseFunctionFactory joins them.  The curve's values
+/// at the first time steps of a simulation are also tabulated, so that
+/// looking them up is a single index.
+class DemandCurve {
+ public:
+  /// compiles the curve, replacing any previous one
+  /// @param demand the curve's pieces, in order of increasing start time
+  /// @param n_table the number of time steps, from 0, to tabulate
+  /// @throws cyclus::ValueError if the pieces' start times do not increase
+  void Compile(const Demand& demand, int n_table);
+
+  /// @return the curve's value at time t
+  double Value(int t) const {
+    return t >= 0 && t < table_.size() ? table_[t] : Eval(t);
+  }
+
+  /// @return the curve's value at x, evaluated from its pieces
+  double Eval(double x) const;
+
+  /// @return the number of tabulated time steps
+  int table_size() const { return table_.size(); }
+
+ private:
+  std::vector<double> starts_;
+  std::vector<double> offsets_;
+  std::vector<cyclus::toolkit::FunctionPtr> fns_;
+  std::vector<double> table_;
+};
+
 /// This region determines if there is a need to meet a certain
 /// capacity (as defined via input) at each time step. If there is
 /// such a need, the region will determine how many of each facility
@@ -104,6 +141,36 @@ class GrowthRegion : public cyclus::Region,
   }
   std::map<std::string, std::vector<std::pair<int, std::pair<std::string, std::string> > > > commodity_demand; // must match Demand typedef
 
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Build Planning Horizon", \
+    "units": "time steps", \
+    "doc": "If positive, build decisions are planned for this many time " \
+           "steps ahead: whenever a plan is made, each increase of the " \
+           "unmet demand over the horizon is ordered to be built on the " \
+           "time step it is needed, and no further builds are decided until " \
+           "the horizon has passed, unless the unmet demand drifts above " \
+           "the plan tolerance. Zero decides builds every time step.", \
+  }
+  int build_horizon;
+
+  #pragma cyclus var { \
+    "default": 0.0, \
+    "uilabel": "Build Plan Tolerance", \
+    "doc": "Unmet demand (in units of the demanded commodity's capacity) " \
+           "tolerated within a build plan's horizon before it is replanned. " \
+           "Only used if the build horizon is positive.", \
+  }
+  double plan_tolerance;
+
+  /// per commodity, the last time covered by its current build plan
+  #pragma cyclus var {"default": {}, "internal": True}
+  std::map<std::string, int> plan_ends;
+
+  /// per commodity, the capacity ordered to be built at each future time
+  #pragma cyclus var {"default": {}, "internal": True}
+  std::map<std::string, std::map<int, double> > planned_builds;
+
 #if CYCLUS_HAS_COIN
   /// manager for building things
   cyclus::toolkit::BuildingManager buildmanager_;
@@ -112,6 +179,14 @@ class GrowthRegion : public cyclus::Region,
   /// manager for Supply and demand
   cyclus::toolkit::SupplyDemandManager sdmanager_;
 
+  /// registered producer managers, split by whether they keep running
+  /// capacity totals
+  std::set<ManagerInst*> insts_;
+  std::set<cyclus::toolkit::CommodityProducerManager*> managers_;
+
+  /// compiled demand curve of each commodity
+  std::map<std::string, DemandCurve> curves_;
+
   /// register a child
   void Register_(cyclus::Agent* agent);
 
@@ -122,11 +197,26 @@ class GrowthRegion : public cyclus::Region,
   /// facilities be built
   void AddCommodityDemand_(std::string commod, Demand& demand);
 
+  /// @return the demand for commodity at time from its compiled curve
+  double Demand_(const std::string& commod, int time);
+
+  /// @return the production capacity of commodity of the registered
+  /// producer managers (ManagerInsts answer from their running totals)
+  double Supply_(const cyclus::toolkit::Commodity& commod);
+
+  /// @return the unmet demand to order builds for at time by the time step
+  /// the builds are needed at (from time + 1 on), following the build plan of
+  /// commod if planning over a horizon
+  std::map<int, double> PlanBuilds_(const cyclus::toolkit::Commodity& commod,
+                                    int time, double supply);
+
   /// orders builds given a commodity and an unmet demand for production
   /// capacity of that commodity
   /// @param commodity the commodity being demanded
   /// @param unmetdemand the unmet demand
-  void OrderBuilds(cyclus::toolkit::Commodity& commodity, double unmetdemand);
+  /// @param time the time step to build at, the next one if -1
+  void OrderBuilds(cyclus::toolkit::Commodity& commodity, double unmetdemand,
+                   int time = -1);
 
   private:
   #pragma cyclus var { \
@@ -149,6 +239,11 @@ class GrowthRegion : public cyclus::Region,
 
   /// Records an agent's latitude and longitude to the output db
   void RecordPosition();
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 }  // namespace cycamore
 
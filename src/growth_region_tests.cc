@@ -26,6 +26,41 @@ bool GrowthRegionTests::ManagesCommodity(cyclus::toolkit::Commodity& commodity)
   return region->sdmanager()->ManagesCommodity(commodity);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void GrowthRegionTests::AddDemand(std::string commod, Demand demand) {
+  region->AddCommodityDemand_(commod, demand);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void GrowthRegionTests::SetPlanning(int horizon, double tolerance) {
+  region->build_horizon = horizon;
+  region->plan_tolerance = tolerance;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+double GrowthRegionTests::PlanBuilds(std::string commod, int time,
+                                     double supply) {
+  std::map<int, double> orders = PlanBuildTimes(commod, time, supply);
+  double tot = 0;
+  std::map<int, double>::iterator it;
+  for (it = orders.begin(); it != orders.end(); ++it) {
+    tot += it->second;
+  }
+  return tot;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+std::map<int, double> GrowthRegionTests::PlanBuildTimes(std::string commod,
+                                                        int time,
+                                                        double supply) {
+  return region->PlanBuilds_(cyclus::toolkit::Commodity(commod), time, supply);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+double GrowthRegionTests::CompiledDemand(std::string commod, int time) {
+  return region->Demand_(commod, time);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 TEST_F(GrowthRegionTests, init) {
   cyclus::toolkit::Commodity commodity(commodity_name);
@@ -34,6 +69,85 @@ TEST_F(GrowthRegionTests, init) {
   EXPECT_TRUE(ManagesCommodity(commodity));
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(GrowthRegionTests, BuildHorizon) {
+  Demand demand;
+  demand.push_back(std::make_pair(0, std::make_pair(demand_type,
+                                                    demand_params)));
+  AddDemand(commodity_name, demand);
+
+  // without a horizon, the unmet demand is ordered every time
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 0, 0), 5);
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 1, 5), 5);
+
+  // with one, the peak demand over the horizon is ordered once
+  SetPlanning(3, 1);
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 0, 0), 20);
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 1, 20), 0);
+  // drifting within tolerance keeps the plan, beyond it replans
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 2, 14), 0);
+  // the 5 still to be built at time 3 need not be ordered again
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 2, 10), 15);
+  // the plan runs out after its horizon
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 5, 35), 0);
+  EXPECT_DOUBLE_EQ(PlanBuilds(commodity_name, 6, 35), 15);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(GrowthRegionTests, BuildTiming) {
+  Demand demand;
+  demand.push_back(std::make_pair(0, std::make_pair(demand_type,
+                                                    demand_params)));
+  AddDemand(commodity_name, demand);
+  SetPlanning(3, 0);
+
+  // each rise of the demand is built when it is needed, the demand of now
+  // on the next time step
+  std::map<int, double> orders = PlanBuildTimes(commodity_name, 0, 0);
+  ASSERT_EQ(3, orders.size());
+  EXPECT_DOUBLE_EQ(10, orders[1]);
+  EXPECT_DOUBLE_EQ(5, orders[2]);
+  EXPECT_DOUBLE_EQ(5, orders[3]);
+
+  // nothing is ordered while the plan holds, and replanning only orders
+  // what the builds still to come do not cover
+  EXPECT_TRUE(PlanBuildTimes(commodity_name, 1, 10).empty());
+  orders = PlanBuildTimes(commodity_name, 2, 14);
+  ASSERT_EQ(3, orders.size());
+  EXPECT_DOUBLE_EQ(1, orders[3]);
+  EXPECT_DOUBLE_EQ(5, orders[4]);
+  EXPECT_DOUBLE_EQ(5, orders[5]);
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(GrowthRegionTests, DemandCurve) {
+  Demand demand;
+  demand.push_back(std::make_pair(2, std::make_pair("linear", "5 5")));
+  demand.push_back(std::make_pair(10, std::make_pair("exponential",
+                                                     "2 0.1 1")));
+  demand.push_back(std::make_pair(20, std::make_pair("linear", "-3 0")));
+  AddDemand(commodity_name, demand);
+
+  // the compiled curve follows the piecewise function registered with the
+  // supply demand manager, tabulated or not
+  cyclus::toolkit::Commodity c(commodity_name);
+  DemandCurve curve;
+  curve.Compile(demand, 15);
+  EXPECT_EQ(15, curve.table_size());
+  for (int t = 0; t < 30; t++) {
+    double want = region->sdmanager()->Demand(c, t);
+    EXPECT_NEAR(want, CompiledDemand(commodity_name, t), 1e-9 * (1 + want))
+        << "wrong demand at time " << t;
+    EXPECT_NEAR(want, curve.Value(t), 1e-9 * (1 + want))
+        << "wrong demand at time " << t;
+  }
+  EXPECT_DOUBLE_EQ(0, curve.Value(1));
+  EXPECT_DOUBLE_EQ(5, curve.Value(2));
+
+  Demand unordered(demand.rbegin(), demand.rend());
+  EXPECT_THROW(curve.Compile(unordered, 0), cyclus::ValueError);
+}
+
 }  // namespace cycamore
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
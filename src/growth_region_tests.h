@@ -29,6 +29,12 @@ class GrowthRegionTests : public ::testing::Test {
   virtual void SetUp();
   virtual void TearDown();
   bool ManagesCommodity(cyclus::toolkit::Commodity& commodity);
+  void AddDemand(std::string commod, Demand demand);
+  void SetPlanning(int horizon, double tolerance);
+  double PlanBuilds(std::string commod, int time, double supply);
+  std::map<int, double> PlanBuildTimes(std::string commod, int time,
+                                       double supply);
+  double CompiledDemand(std::string commod, int time);
 };
 
 }  // namespace cycamore
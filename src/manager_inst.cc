@@ -50,12 +50,18 @@ void ManagerInst::Register_(Agent* a) {
   using cyclus::toolkit::CommodityProducer;
   using cyclus::toolkit::CommodityProducerManager;
 
+  if (producer_agents_.count(a->id()) > 0) {
+    return;
+  }
+
   CommodityProducer* cp_cast = dynamic_cast<CommodityProducer*>(a);
   if (cp_cast != NULL) {
     LOG(cyclus::LEV_INFO3, "mani") << "Registering agent "
                                    << a->prototype() << a->id()
                                    << " as a commodity producer.";
     CommodityProducerManager::Register(cp_cast);
+    producer_agents_[a->id()] = cp_cast;
+    IndexProducer_(a->id(), cp_cast, true);
   }
 }
 
@@ -63,9 +69,56 @@ void ManagerInst::Unregister_(Agent* a) {
   using cyclus::toolkit::CommodityProducer;
   using cyclus::toolkit::CommodityProducerManager;
 
-  CommodityProducer* cp_cast = dynamic_cast<CommodityProducer*>(a);
-  if (cp_cast != NULL)
-    CommodityProducerManager::Unregister(cp_cast);
+  std::unordered_map<int, CommodityProducer*>::iterator it =
+      producer_agents_.find(a->id());
+  if (it != producer_agents_.end()) {
+    CommodityProducer* cp = it->second;
+    producer_agents_.erase(it);
+    CommodityProducerManager::Unregister(cp);
+    IndexProducer_(a->id(), cp, false);
+  }
+}
+
+void ManagerInst::IndexProducer_(int id,
+                                 cyclus::toolkit::CommodityProducer* producer,
+                                 bool add) {
+  using cyclus::toolkit::Commodity;
+  using cyclus::toolkit::CommodityCompare;
+
+  std::set<Commodity, CommodityCompare> commods =
+      producer->ProducedCommodities();
+  std::set<Commodity, CommodityCompare>::iterator it;
+  for (it = commods.begin(); it != commods.end(); ++it) {
+    const std::string& name = it->name();
+    ProducerMap& index = producer_index_[name];
+    if (add) {
+      index[id] = producer;
+      capacity_totals_[name] += producer->Capacity(*it);
+    } else {
+      index.erase(id);
+      capacity_totals_[name] -= producer->Capacity(*it);
+    }
+
+    if (index.empty()) {
+      // don't let round off accumulate
+      producer_index_.erase(name);
+      capacity_totals_.erase(name);
+    }
+  }
+}
+
+double ManagerInst::ProducedCapacity(
+    const cyclus::toolkit::Commodity& commodity) const {
+  std::unordered_map<std::string, double>::const_iterator it =
+      capacity_totals_.find(commodity.name());
+  return it == capacity_totals_.end() ? 0 : it->second;
+}
+
+const ManagerInst::ProducerMap& ManagerInst::Producers(
+    const cyclus::toolkit::Commodity& commodity) const {
+  std::unordered_map<std::string, ProducerMap>::const_iterator it =
+      producer_index_.find(commodity.name());
+  return it == producer_index_.end() ? no_producers_ : it->second;
 }
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -1,6 +1,8 @@
 #ifndef CYCAMORE_SRC_MANAGER_INST_H_
 #define CYCAMORE_SRC_MANAGER_INST_H_
 
+#include <unordered_map>
+
 #include "cyclus.h"
 #include "cycamore_version.h"
 
@@ -44,6 +46,19 @@ class ManagerInst
   void WriteProducerInformation(cyclus::toolkit::CommodityProducer*
                                 producer);
 
+  /// @return the total capacity of the registered producers of commodity,
+  /// equal to TotalCapacity but kept up to date as producers are registered
+  /// and unregistered instead of summing over them
+  double ProducedCapacity(const cyclus::toolkit::Commodity& commodity) const;
+
+  /// registered producers keyed by their agent id
+  typedef std::map<int, cyclus::toolkit::CommodityProducer*> ProducerMap;
+
+  /// @return the registered producers of commodity, in order of their agent
+  /// id
+  const ProducerMap& Producers(
+      const cyclus::toolkit::Commodity& commodity) const;
+
  private:
   /// register a child
   void Register_(cyclus::Agent* agent);
@@ -51,6 +66,11 @@ class ManagerInst
   /// unregister a child
   void Unregister_(cyclus::Agent* agent);
 
+  /// adds a producer to (or removes it from) the index of each commodity it
+  /// produces and updates the running capacity totals
+  void IndexProducer_(int id, cyclus::toolkit::CommodityProducer* producer,
+                      bool add);
+
   #pragma cyclus var { \
     "tooltip": "producer facility prototypes",                          \
     "uilabel": "Producer Prototype List",                               \
@@ -79,6 +99,21 @@ class ManagerInst
 
   cyclus::toolkit::Position coordinates;
 
+  /// running production capacity per commodity of the registered producers,
+  /// assuming producer capacities don't change while they are registered
+  std::unordered_map<std::string, double> capacity_totals_;
+
+  /// registered producers per commodity
+  std::unordered_map<std::string, ProducerMap> producer_index_;
+
+  /// producer interface of the registered child agents by agent id, so that
+  /// unregistering them needs no dynamic cast
+  std::unordered_map<int, cyclus::toolkit::CommodityProducer*>
+      producer_agents_;
+
+  /// returned for commodities without producers
+  ProducerMap no_producers_;
+
   /// Records an agent's latitude and longitude to the output db
   void RecordPosition();
 };
@@ -53,6 +53,78 @@ TEST_F(ManagerInstTests, productioncapacity) {
   EXPECT_EQ(src_inst->TotalCapacity(commodity), 0);
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(ManagerInstTests, producedcapacity) {
+  TestProducer* other = new TestProducer(ctx_);
+  other->cyclus::toolkit::CommodityProducer::Add(commodity);
+  other->SetCapacity(commodity, 2 * capacity);
+
+  EXPECT_EQ(src_inst->ProducedCapacity(commodity), 0);
+  src_inst->BuildNotify(producer);
+  src_inst->BuildNotify(other);
+  EXPECT_DOUBLE_EQ(src_inst->ProducedCapacity(commodity), 3 * capacity);
+  EXPECT_DOUBLE_EQ(src_inst->ProducedCapacity(commodity),
+                   src_inst->TotalCapacity(commodity));
+
+  // registering twice doesn't count a producer twice
+  src_inst->BuildNotify(producer);
+  EXPECT_DOUBLE_EQ(src_inst->ProducedCapacity(commodity), 3 * capacity);
+
+  src_inst->DecomNotify(producer);
+  EXPECT_DOUBLE_EQ(src_inst->ProducedCapacity(commodity), 2 * capacity);
+  src_inst->DecomNotify(producer);
+  src_inst->DecomNotify(other);
+  EXPECT_EQ(src_inst->ProducedCapacity(commodity), 0);
+  EXPECT_EQ(src_inst->ProducedCapacity(cyclus::toolkit::Commodity("other")),
+            0);
+  delete other;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(ManagerInstTests, producerindex) {
+  cyclus::toolkit::Commodity other_commod("other");
+  TestProducer* other = new TestProducer(ctx_);
+  other->cyclus::toolkit::CommodityProducer::Add(other_commod);
+  other->SetCapacity(other_commod, capacity);
+
+  EXPECT_TRUE(src_inst->Producers(commodity).empty());
+  src_inst->BuildNotify(producer);
+  src_inst->BuildNotify(other);
+  ASSERT_EQ(src_inst->Producers(commodity).size(), 1);
+  EXPECT_EQ(src_inst->Producers(commodity).begin()->second, producer);
+  ASSERT_EQ(src_inst->Producers(other_commod).size(), 1);
+  EXPECT_EQ(src_inst->Producers(other_commod).begin()->second, other);
+
+  src_inst->DecomNotify(producer);
+  EXPECT_TRUE(src_inst->Producers(commodity).empty());
+  EXPECT_EQ(src_inst->ProducedCapacity(commodity), 0);
+  EXPECT_EQ(src_inst->Producers(other_commod).size(), 1);
+  src_inst->DecomNotify(other);
+  delete other;
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+TEST_F(ManagerInstTests, producerorder) {
+  TestProducer* other = new TestProducer(ctx_);
+  other->cyclus::toolkit::CommodityProducer::Add(commodity);
+  other->SetCapacity(commodity, capacity);
+
+  // producers are listed by agent id, whatever the registration order
+  src_inst->BuildNotify(other);
+  src_inst->BuildNotify(producer);
+  const cycamore::ManagerInst::ProducerMap& producers =
+      src_inst->Producers(commodity);
+  ASSERT_EQ(producers.size(), 2);
+  EXPECT_EQ(producers.begin()->first, producer->id());
+  EXPECT_EQ(producers.begin()->second, producer);
+  EXPECT_EQ(producers.rbegin()->first, other->id());
+  EXPECT_EQ(producers.rbegin()->second, other);
+
+  src_inst->DecomNotify(producer);
+  src_inst->DecomNotify(other);
+  delete other;
+}
+
 // required to get functionality in cyclus agent unit tests library
 #ifndef CYCLUS_AGENT_TESTS_CONNECTED
 int ConnectAgentTests();
@@ -7,6 +7,13 @@ namespace cycamore {
 Mixer::Mixer(cyclus::Context* ctx)
     : cyclus::Facility(ctx),
       throughput(0),
+      deferred_mix(false),
+      compact_tol(-1),
+      deferred_qty(0),
+      output_view_(&output),
+      record_mode("all"),
+      record_interval(1),
+      memory_interval(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {
@@ -34,17 +41,21 @@ cyclus::Inventories Mixer::SnapshotInv() {
 }
 
 void Mixer::InitInv(cyclus::Inventories& inv) {
-  inv["output-inv-name"] = output.PopNRes(output.count());
   output.Push(inv["output-inv-name"]);
 
   cyclus::Inventories::iterator it;
   for (it = inv.begin(); it != inv.end(); ++it) {
-    streambufs[it->first].Push(it->second);
+    if (it->first != "output-inv-name") {
+      streambufs[it->first].Push(it->second);
+    }
   }
 }
 
 void Mixer::EnterNotify() {
   cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  memory_.Init(memory_interval);
 
   mixing_ratios.clear();
   in_buf_sizes.clear();
@@ -92,45 +103,190 @@ void Mixer::EnterNotify() {
     }
   }
 
-  sell_policy.Init(this, &output, "output").Set(out_commod).Start();
+  // in deferred mode mixed material is bid by the mixer itself
+  if (!deferred_mix) {
+    sell_policy.Init(this, &output, "output").Set(out_commod).Start();
+  }
 }
 
 void Mixer::Tick() {
-  using cyclus::toolkit::RecordTimeSeries;
-  if (output.quantity() < output.capacity()) {
-    double tgt_qty = output.space();
+  CYCAMORE_PERF_SCOPE("Tick");
+  CommitTick(ComputeTick());
+}
+
+void Mixer::Tock() {
+  CYCAMORE_PERF_SCOPE("Tock");
+  record_policy_.Flush(this);
+  std::map<std::string, cyclus::toolkit::ResBuf<cyclus::Material> >::iterator
+      it;
+  if (compact_tol >= 0) {
+    output_view_.Compact(compact_tol);
+    for (it = streambufs.begin(); it != streambufs.end(); ++it) {
+      StreamView_(it->first).Compact(compact_tol);
+    }
+  }
+
+  if (memory_.Due(context()->time())) {
+    memory_.Add("output", output);
+    for (it = streambufs.begin(); it != streambufs.end(); ++it) {
+      memory_.Add(it->first, it->second);
+    }
+    memory_.Flush(this);
+  }
+}
+
+double Mixer::ComputeTick() {
+  double stored = output.quantity() + deferred_qty;
+  if (stored >= output.capacity()) {
+    return 0;
+  }
+  double tgt_qty = output.capacity() - stored;
 
+  // in deferred mode deferred_qty is still in the input inventories
+  for (int i = 0; i < mixing_ratios.size(); i++) {
+    std::string name = "in_stream_" + std::to_string(i);
+    tgt_qty = std::min(tgt_qty, streambufs[name].quantity() / mixing_ratios[i]
+                                    - deferred_qty);
+  }
+
+  return std::min(tgt_qty, throughput);
+}
+
+void Mixer::CommitTick(double qty) {
+  if (qty > 0) {
+    if (deferred_mix) {
+      deferred_qty += qty;
+    } else {
+      output_view_.Push(Mix_(qty));
+    }
+  }
+  record_policy_.TimeSeries("supply"+out_commod, this, MixedQty_());
+}
+
+cyclus::Material::Ptr Mixer::Mix_(double qty) {
+  cyclus::Material::Ptr m;
+  for (int i = 0; i < mixing_ratios.size(); i++) {
+    std::string name = "in_stream_" + std::to_string(i);
+    double pop_qty = mixing_ratios[i] * qty;
+    if (i == 0) {
+      m = StreamView_(name).Pop(pop_qty, cyclus::eps_rsrc());
+    } else {
+      cyclus::Material::Ptr m_ =
+          StreamView_(name).Pop(pop_qty, cyclus::eps_rsrc());
+      m->Absorb(m_);
+    }
+  }
+  return m;
+}
+
+double Mixer::MixedQty_() {
+  return output.quantity() + deferred_qty;
+}
+
+ResBufView<cyclus::Material>& Mixer::StreamView_(const std::string& name) {
+  std::map<std::string, ResBufView<cyclus::Material> >::iterator it =
+      stream_views_.find(name);
+  if (it == stream_views_.end()) {
+    it = stream_views_.insert(std::make_pair(
+        name, ResBufView<cyclus::Material>(&streambufs[name]))).first;
+  }
+  return it->second;
+}
+
+cyclus::Composition::Ptr Mixer::OfferComp_() {
+  std::vector<unsigned long> versions(1, output_view_.version());
+  for (int i = 0; i < mixing_ratios.size(); i++) {
+    versions.push_back(StreamView_("in_stream_" + std::to_string(i)).version());
+  }
+  if (offer_comp_.get() != NULL && versions == offer_versions_) {
+    return offer_comp_;
+  }
+
+  // the oldest material of each input inventory, or the already mixed
+  // material
+  if (output.count() > 0) {
+    offer_comp_ = output_view_.contents().front()->comp();
+  } else {
+    cyclus::CompMap cm;
     for (int i = 0; i < mixing_ratios.size(); i++) {
-      std::string name = "in_stream_" + std::to_string(i);
-      tgt_qty =
-          std::min(tgt_qty, streambufs[name].quantity() / mixing_ratios[i]);
+      ResBufView<cyclus::Material>& view =
+          StreamView_("in_stream_" + std::to_string(i));
+      if (view.count() == 0) {
+        continue;  // only possible for a zero mixing ratio
+      }
+      cyclus::CompMap c = view.contents().front()->comp()->mass();
+      cyclus::compmath::Normalize(&c, mixing_ratios[i]);
+      cm = cyclus::compmath::Add(cm, c);
     }
+    offer_comp_ = cyclus::Composition::CreateFromMass(cm);
+  }
+  offer_versions_ = versions;
+  return offer_comp_;
+}
 
-    tgt_qty = std::min(tgt_qty, throughput);
+std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Mixer::GetMatlBids(
+    cyclus::CommodMap<cyclus::Material>::type& commod_requests) {
+  CYCAMORE_PERF_SCOPE("GetMatlBids");
+  using cyclus::BidPortfolio;
+  using cyclus::Material;
+  std::set<BidPortfolio<Material>::Ptr> ports;
+
+  double avail = MixedQty_();
+  if (!deferred_mix || avail < cyclus::eps_rsrc() ||
+      commod_requests.count(out_commod) == 0) {
+    return ports;
+  }
+  std::vector<cyclus::Request<Material>*>& reqs = commod_requests[out_commod];
+  if (reqs.size() == 0) {
+    return ports;
+  }
 
-    if (tgt_qty > 0) {
-      cyclus::Material::Ptr m;
-      for (int i = 0; i < mixing_ratios.size(); i++) {
-        std::string name = "in_stream_" + std::to_string(i);
-        double pop_qty = mixing_ratios[i] * tgt_qty;
-        if (i == 0) {
-          m = streambufs[name].Pop(pop_qty, cyclus::eps_rsrc());
-        } else {
-          cyclus::Material::Ptr m_ =
-              streambufs[name].Pop(pop_qty, cyclus::eps_rsrc());
-          m->Absorb(m_);
-        }
+  Material::Ptr offer = Material::CreateUntracked(avail, OfferComp_());
+
+  BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
+  for (int i = 0; i < reqs.size(); i++) {
+    port->AddBid(reqs[i], offer, this);
+  }
+  port->AddConstraint(cyclus::CapacityConstraint<Material>(avail));
+  ports.insert(port);
+  return ports;
+}
+
+void Mixer::GetMatlTrades(
+    const std::vector<cyclus::Trade<cyclus::Material> >& trades,
+    std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                          cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("GetMatlTrades");
+  using cyclus::Material;
+  for (int i = 0; i < trades.size(); i++) {
+    double qty = std::min(trades[i].amt, MixedQty_());
+
+    // already mixed material goes first
+    Material::Ptr m;
+    double from_output = std::min(qty, output.quantity());
+    if (from_output > 0) {
+      m = output_view_.Pop(from_output, cyclus::eps_rsrc());
+    }
+    double to_mix = std::min(qty - from_output, deferred_qty);
+    if (to_mix > cyclus::eps_rsrc()) {
+      Material::Ptr mixed = Mix_(to_mix);
+      if (m.get() == NULL) {
+        m = mixed;
+      } else {
+        m->Absorb(mixed);
       }
-      output.Push(m);
+    }
+    deferred_qty = std::max(0.0, deferred_qty - to_mix);
+    if (m.get() != NULL) {
+      responses.push_back(std::make_pair(trades[i], m));
     }
   }
-  cyclus::toolkit::RecordTimeSeries<double>("supply"+out_commod, this, output.quantity());
 }
 
 std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
 Mixer::GetMatlRequests() {
+  CYCAMORE_PERF_SCOPE("GetMatlRequests");
   using cyclus::RequestPortfolio;
-  using cyclus::toolkit::RecordTimeSeries;
 
   for (int i = 0; i < mixing_ratios.size(); i++)
   {
@@ -140,8 +296,7 @@ Mixer::GetMatlRequests() {
     double prev_pref = 0;
     for (it = in_commods[i].begin(); it != in_commods[i].end(); it++)
     {
-      cyclus::toolkit::RecordTimeSeries<double>("demand" + it->first, this,
-                                                streambufs[name].space());
+      record_policy_.Defer("demand" + it->first, streambufs[name].space());
     }
   }
 
@@ -155,7 +310,7 @@ Mixer::GetMatlRequests() {
           new RequestPortfolio<cyclus::Material>());
 
       cyclus::Material::Ptr m;
-      m = cyclus::NewBlankMaterial(streambufs[name].space());
+      m = pool_.Get(context()->time(), streambufs[name].space());
 
       std::vector<cyclus::Request<cyclus::Material>*> reqs;
 
@@ -176,6 +331,7 @@ Mixer::GetMatlRequests() {
 void Mixer::AcceptMatlTrades(
     const std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                                 cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("AcceptMatlTrades");
   std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                         cyclus::Material::Ptr> >::const_iterator trade;
 
@@ -190,7 +346,7 @@ void Mixer::AcceptMatlTrades(
 
     for (it = streambufs.begin(); it != streambufs.end(); it++) {
       if (name == it->first) {
-        it->second.Push(m);
+        StreamView_(it->first).Push(m);
         assigned = true;
         break;
       }
@@ -1,8 +1,14 @@
 #ifndef CYCAMORE_SRC_MIXER_H_
 #define CYCAMORE_SRC_MIXER_H_
 
+#include <map>
 #include <string>
+#include <vector>
 #include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "res_buf_view.h"
+#include "untracked_pool.h"
 #include "cyclus.h"
 
 namespace cycamore {
@@ -30,8 +36,23 @@ class Mixer
   Mixer(cyclus::Context* ctx);
   virtual ~Mixer(){};
 
+  /// Tick is CommitTick(ComputeTick()).
   virtual void Tick();
-  virtual void Tock(){};
+
+  /// Works out the quantity to mix this time step from the inventories,
+  /// without changing them, so that a scheduler can compute the ticks of many
+  /// facilities in parallel.
+  double ComputeTick();
+
+  /// Mixes (or in deferred mode sets aside) qty, as computed by ComputeTick
+  /// for the current time step, and records the mixed quantity.  Popping and
+  /// absorbing the input materials is left to this serial step since cyclus
+  /// tracks every resource it creates.
+  void CommitTick(double qty);
+
+  /// Merges materials of matching composition in the input and output
+  /// buffers if compact_tol is not negative.
+  virtual void Tock();
   virtual void EnterNotify();
 
   virtual void AcceptMatlTrades(
@@ -41,6 +62,14 @@ class Mixer
   virtual std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
   GetMatlRequests();
 
+  virtual std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> GetMatlBids(
+      cyclus::CommodMap<cyclus::Material>::type& commod_requests);
+
+  virtual void GetMatlTrades(
+      const std::vector<cyclus::Trade<cyclus::Material> >& trades,
+      std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                            cyclus::Material::Ptr> >& responses);
+
 #pragma cyclus clone
 #pragma cyclus initfromcopy
 #pragma cyclus infiletodb
@@ -105,6 +134,66 @@ class Mixer
   }
   double throughput;
 
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Deferred Mixing", \
+    "doc": "If true, mixed material is not made every time step. Instead the" \
+           " mixable quantity is tracked from the input inventories (subject" \
+           " to the same throughput and output inventory limits) and input" \
+           " material is only popped and mixed when, and as much as, mixed" \
+           " material is traded away.", \
+  }
+  bool deferred_mix;
+
+  #pragma cyclus var { \
+    "default": -1, \
+    "uilabel": "Inventory Compaction Tolerance", \
+    "doc": "Adjacent materials in the input and output buffers whose mass " \
+           "fractions all agree within this tolerance are merged into one " \
+           "material at the end of every time step, so that long runs hold, " \
+           "snapshot and restart few materials. Only neighbours are merged, " \
+           "so the buffers keep their first in, first out order, and " \
+           "mixing, which pops quantities from their fronts, mixes the same " \
+           "compositions up to the tolerance. A negative value keeps every " \
+           "material separate.", \
+  }
+  double compact_tol;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "internal": True, \
+    "doc": "Quantity of mixed material available but not yet mixed when " \
+           "deferred_mix is true.", \
+  }
+  double deferred_qty;
+
+  /// Pops qty of material in the mixing ratios from the input inventories
+  /// and mixes it.
+  cyclus::Material::Ptr Mix_(double qty);
+
+  /// Returns the quantity of mixed material that can be supplied.
+  double MixedQty_();
+
+  /// Returns the view of the named input inventory, creating it on first
+  /// use.
+  ResBufView<cyclus::Material>& StreamView_(const std::string& name);
+
+  /// Returns the composition offered in deferred mode: that of the already
+  /// mixed material, or of mixing the oldest material of each input
+  /// inventory.
+  cyclus::Composition::Ptr OfferComp_();
+
+  // all pushes and pops of the output and input inventories go through these
+  // views, so that their versions tell when the offered composition changes
+  ResBufView<cyclus::Material> output_view_;
+  std::map<std::string, ResBufView<cyclus::Material> > stream_views_;
+
+  // deferred mode offer composition and the versions of the output and (in
+  // order) input inventory views it was made for, reused until one of them
+  // changes. Rebuilt on first use, so there is no need to persist.
+  cyclus::Composition::Ptr offer_comp_;
+  std::vector<unsigned long> offer_versions_;
+
   // intra-time-step state - no need to be a state var
   // map<request, inventory name>
   std::map<cyclus::Request<cyclus::Material>*, std::string> req_inventories_;
@@ -113,6 +202,18 @@ class Mixer
   cyclus::toolkit::MatlSellPolicy sell_policy;
 
   private:
+  #include "record_policy.cycpp.h"
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
+
   #pragma cyclus var { \
     "default": 0.0, \
     "uilabel": "Geographical latitude in degrees as a double", \
@@ -131,8 +232,22 @@ class Mixer
 
   cyclus::toolkit::Position coordinates;
 
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
+  /// request targets shared between requests and time steps
+  UntrackedPool pool_;
+
   /// Records an agent's latitude and longitude to the output db
   void RecordPosition();
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 }  // namespace cycamore
@@ -165,6 +165,16 @@ class MixerTest : public ::testing::Test {
 
   double GetThroughput() { return mf_facility_->throughput; }
 
+  void SetDeferredMix(bool deferred) { mf_facility_->deferred_mix = deferred; }
+
+  void SetCompactTol(double tol) { mf_facility_->compact_tol = tol; }
+
+  double GetDeferredQty() { return mf_facility_->deferred_qty; }
+
+  cyclus::Composition::Ptr GetOfferComp() {
+    return mf_facility_->OfferComp_();
+  }
+
   InvBuffer* GetOutPutBuffer() { return &mf_facility_->output; }
 
   std::map<std::string, InvBuffer> GetStreamBuffer() {
@@ -320,6 +330,212 @@ TEST_F(MixerTest, Throughput) {
          "correctly constrained by throughput.";
 }
 
+// In deferred mode the input inventories are untouched by Tick and only the
+// mixable quantity is tracked.
+TEST_F(MixerTest, DeferredMixTick) {
+  using cyclus::Material;
+
+  std::vector<double> in_frac_ = {0.80, 0.15, 0.05};
+  SetStream_ratio(in_frac_);
+  SetOutStream_capacity(50);
+  SetThroughput(0.5);
+  SetDeferredMix(true);
+
+  std::vector<Material::Ptr> mat;
+  mat.push_back(Material::CreateUntracked(in_cap[0], c_natu()));
+  mat.push_back(Material::CreateUntracked(in_cap[1], c_pustream()));
+  mat.push_back(Material::CreateUntracked(in_cap[2], c_uox()));
+  SetInputInv(mat);
+
+  mf_facility_->Tick();
+  mf_facility_->Tick();
+
+  EXPECT_DOUBLE_EQ(0, GetOutPutBuffer()->quantity());
+  EXPECT_DOUBLE_EQ(2 * throughput, GetDeferredQty());
+
+  std::map<std::string, InvBuffer> streambuf = GetStreamBuffer();
+  for (int i = 0; i < in_coms.size(); i++) {
+    std::string name = "in_stream_" + std::to_string(i);
+    EXPECT_DOUBLE_EQ(in_cap[i], streambuf[name].quantity());
+  }
+}
+
+// In deferred mode the offered composition is only made again once an
+// inventory changes.
+TEST_F(MixerTest, DeferredOfferComp) {
+  using cyclus::Material;
+
+  std::vector<double> in_frac_ = {0.80, 0.15, 0.05};
+  SetStream_ratio(in_frac_);
+  SetOutStream_capacity(50);
+  SetThroughput(0.5);
+  SetDeferredMix(true);
+
+  std::vector<Material::Ptr> mat;
+  mat.push_back(Material::CreateUntracked(in_cap[0], c_natu()));
+  mat.push_back(Material::CreateUntracked(in_cap[1], c_pustream()));
+  mat.push_back(Material::CreateUntracked(in_cap[2], c_uox()));
+  SetInputInv(mat);
+
+  mf_facility_->Tick();
+  cyclus::Composition::Ptr c = GetOfferComp();
+  EXPECT_EQ(c->id(), GetOfferComp()->id());
+
+  // setting aside more mixable quantity leaves the inventories unchanged
+  mf_facility_->Tick();
+  EXPECT_EQ(c->id(), GetOfferComp()->id());
+
+  std::vector<Material::Ptr> more(1, Material::CreateUntracked(1, c_uox()));
+  SetInputInv(more);
+  EXPECT_NE(c->id(), GetOfferComp()->id());
+}
+
+// ComputeTick only plans the mix, the inventories change on CommitTick.
+TEST_F(MixerTest, ComputeCommitTick) {
+  using cyclus::Material;
+
+  std::vector<double> in_frac_ = {0.80, 0.15, 0.05};
+  SetStream_ratio(in_frac_);
+  SetOutStream_capacity(50);
+  SetThroughput(0.5);
+
+  std::vector<Material::Ptr> mat;
+  mat.push_back(Material::CreateUntracked(in_cap[0], c_natu()));
+  mat.push_back(Material::CreateUntracked(in_cap[1], c_pustream()));
+  mat.push_back(Material::CreateUntracked(in_cap[2], c_uox()));
+  SetInputInv(mat);
+
+  double qty = mf_facility_->ComputeTick();
+  EXPECT_DOUBLE_EQ(throughput, qty);
+  EXPECT_DOUBLE_EQ(0, GetOutPutBuffer()->quantity());
+  std::map<std::string, InvBuffer> streambuf = GetStreamBuffer();
+  for (int i = 0; i < in_cap.size(); i++) {
+    std::string name = "in_stream_" + std::to_string(i);
+    EXPECT_DOUBLE_EQ(in_cap[i], streambuf[name].quantity());
+  }
+
+  mf_facility_->CommitTick(qty);
+  EXPECT_DOUBLE_EQ(throughput, GetOutPutBuffer()->quantity());
+  streambuf = GetStreamBuffer();
+  for (int i = 0; i < in_cap.size(); i++) {
+    std::string name = "in_stream_" + std::to_string(i);
+    EXPECT_NEAR(in_cap[i] - throughput * in_frac_[i],
+                streambuf[name].quantity(), 1e-10);
+  }
+}
+
+// Request targets of the same quantity are reused instead of recreated.
+TEST_F(MixerTest, SharedRequestTargets) {
+  using cyclus::Material;
+  using cyclus::RequestPortfolio;
+
+  SetOutStream_capacity(50);
+  SetThroughput(1e200);
+  mf_facility_->EnterNotify();
+
+  std::map<double, Material::Ptr> targets;
+  for (int call = 0; call < 2; call++) {
+    std::set<RequestPortfolio<Material>::Ptr> ports =
+        mf_facility_->GetMatlRequests();
+    ASSERT_EQ(3, ports.size());
+    std::set<RequestPortfolio<Material>::Ptr>::iterator it;
+    for (it = ports.begin(); it != ports.end(); ++it) {
+      ASSERT_EQ(1, (*it)->requests().size());
+      Material::Ptr target = (*it)->requests()[0]->target();
+      if (call == 0) {
+        targets[target->quantity()] = target;
+      } else {
+        EXPECT_EQ(targets[target->quantity()], target);
+      }
+    }
+  }
+  EXPECT_EQ(3, targets.size());
+}
+
+// materials of the same composition are merged at the end of the time step
+// when compaction is enabled
+TEST_F(MixerTest, CompactInventories) {
+  using cyclus::Material;
+
+  SetOutStream_capacity(50);
+  SetThroughput(1e200);
+  mf_facility_->EnterNotify();
+
+  for (int i = 0; i < 2; i++) {
+    std::vector<Material::Ptr> mat;
+    mat.push_back(Material::CreateUntracked(1, c_natu()));
+    mat.push_back(Material::CreateUntracked(1, c_pustream()));
+    mat.push_back(Material::CreateUntracked(1, c_uox()));
+    SetInputInv(mat);
+  }
+
+  mf_facility_->Tock();
+  EXPECT_EQ(2, GetStreamBuffer()["in_stream_0"].count());
+
+  SetCompactTol(0);
+  mf_facility_->Tock();
+  std::map<std::string, InvBuffer> bufs = GetStreamBuffer();
+  for (int i = 0; i < 3; i++) {
+    InvBuffer& buf = bufs["in_stream_" + std::to_string(i)];
+    EXPECT_EQ(1, buf.count());
+    EXPECT_DOUBLE_EQ(2, buf.quantity());
+  }
+}
+
+// compaction only merges neighbouring materials, so interleaved compositions
+// are still popped in the order they arrived
+TEST_F(MixerTest, CompactKeepsOrder) {
+  using cyclus::Material;
+
+  SetOutStream_capacity(50);
+  SetThroughput(1e200);
+  mf_facility_->EnterNotify();
+
+  cyclus::Composition::Ptr comps[] = {c_natu(), c_natu(), c_uox(), c_natu(),
+                                      c_uox(), c_uox()};
+  for (int i = 0; i < 6; i++) {
+    std::vector<Material::Ptr> mat;
+    mat.push_back(Material::CreateUntracked(1, comps[i]));
+    SetInputInv(mat);
+  }
+
+  SetCompactTol(0);
+  mf_facility_->Tock();
+  InvBuffer buf = GetStreamBuffer()["in_stream_0"];
+  ASSERT_EQ(4, buf.count());
+
+  double qtys[] = {2, 1, 1, 2};
+  cyclus::Composition::Ptr order[] = {c_natu(), c_uox(), c_natu(), c_uox()};
+  for (int i = 0; i < 4; i++) {
+    Material::Ptr m = buf.Pop();
+    EXPECT_DOUBLE_EQ(qtys[i], m->quantity()) << "material " << i;
+    EXPECT_TRUE(cyclus::compmath::AlmostEq(order[i]->mass(),
+                                           m->comp()->mass(), 1e-12))
+        << "material " << i;
+  }
+}
+
+// the output and input inventories are restored into their own buffers
+TEST_F(MixerTest, RestartInventories) {
+  using cyclus::Material;
+
+  GetOutPutBuffer()->Push(Material::CreateUntracked(3, c_uox()));
+  std::vector<Material::Ptr> mat;
+  mat.push_back(Material::CreateUntracked(1, c_natu()));
+  SetInputInv(mat);
+
+  cyclus::Inventories inv = mf_facility_->SnapshotInv();
+  Mixer* restarted = new Mixer(tc_.get());
+  restarted->InitInv(inv);
+  delete mf_facility_;
+  mf_facility_ = restarted;
+
+  EXPECT_DOUBLE_EQ(3, GetOutPutBuffer()->quantity());
+  std::map<std::string, InvBuffer> bufs = GetStreamBuffer();
+  EXPECT_EQ(0, bufs.count("output-inv-name"));
+  EXPECT_DOUBLE_EQ(1, bufs["in_stream_0"].quantity());
+}
+
 // multiple input streams can be correctly requested and used as
 //  material inventory.
 TEST(MixerTests, MultipleFissStreams) {
@@ -461,6 +677,64 @@ TEST(MixerTests, CompleteMixingProcess) {
   EXPECT_DOUBLE_EQ(1., m->quantity());
 }
 
+// deferred mixing trades the same mixed material as regular mixing
+TEST(MixerTests, DeferredMixingProcess) {
+  std::string config =
+      "<in_streams>"
+        "<stream>"
+          "<info>"
+            "<mixing_ratio>0.8</mixing_ratio>"
+            "<buf_size>2.5</buf_size>"
+          "</info>"
+          "<commodities>"
+            "<item>"
+              "<commodity>stream1</commodity>"
+              "<pref>1</pref>"
+            "</item>"
+          "</commodities>"
+        "</stream>"
+        "<stream>"
+          "<info>"
+            "<mixing_ratio>0.2</mixing_ratio>"
+            "<buf_size>3</buf_size>"
+          "</info>"
+          "<commodities>"
+            "<item>"
+              "<commodity>stream2</commodity>"
+              "<pref>1</pref>"
+            "</item>"
+          "</commodities>"
+        "</stream>"
+      "</in_streams>"
+      "<out_commod>mixedstream</out_commod>"
+      "<outputbuf_size>10</outputbuf_size>"
+      "<throughput>1</throughput>"
+      "<deferred_mix>1</deferred_mix>";
+  int simdur = 3;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Mixer"), config, simdur);
+  sim.AddSource("stream1").recipe("unatstream").capacity(1).Finalize();
+  sim.AddSource("stream2").recipe("pustream").capacity(1).Finalize();
+  sim.AddRecipe("unatstream", c_natu());
+  sim.AddRecipe("pustream", c_pustream());
+
+  sim.AddSink("mixedstream").capacity(0.5).Finalize();
+  int id = sim.Run();
+
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("Commodity", "==", std::string("mixedstream")));
+  cyclus::QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(2, qr.rows.size());
+
+  for (int i = 0; i < qr.rows.size(); i++) {
+    cyclus::Material::Ptr m =
+        sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(0.5, m->quantity());
+    cyclus::toolkit::MatQuery mq(m);
+    EXPECT_NEAR(0.8 * 0.5, mq.mass(pyne::nucname::id("u235")) +
+                               mq.mass(pyne::nucname::id("u238")), 1e-10);
+  }
+}
+
 TEST(MixerTests, PositionInitialize) {
   std::string config =
       "<in_streams>"
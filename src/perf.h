@@ -0,0 +1,179 @@
+#ifndef CYCAMORE_SRC_PERF_H_
+#define CYCAMORE_SRC_PERF_H_
+
+/// Opt-in timing of the archetypes' time step phases.
+///
+/// Building with CYCAMORE_PERF defined (cmake -DCYCAMORE_PERF=ON) makes each
+/// archetype time its Tick, Tock and DRE phases into a per-agent PhaseTimers
+/// member.  When an agent is deleted - after being decommissioned or at the
+/// end of the simulation - it records one row per phase to the ArchetypePerf
+/// table with the number of calls and the total seconds spent.  If the
+/// CYCAMORE_PERF_TRACE environment variable names a file, every timed call is
+/// also written to it as a Chrome trace event (chrome://tracing) when the
+/// process exits.
+///
+/// Without CYCAMORE_PERF the timer macro expands to nothing and no timer
+/// members exist, so instrumented code is exactly the uninstrumented code.
+/// An archetype is instrumented by declaring the timers in its class
+///
+///   #ifdef CYCAMORE_PERF
+///   PhaseTimers perf_;
+///   #endif
+///
+/// and starting each phase with CYCAMORE_PERF_SCOPE("Tick") etc.
+
+#ifdef CYCAMORE_PERF
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cyclus.h"
+
+#define CYCAMORE_PERF_SCOPE(phase) \
+  cycamore::PhaseTimer cycamore_perf_scope_(&perf_, this, phase)
+
+namespace cycamore {
+
+/// TraceLog collects Chrome trace events for the whole process and writes
+/// them to the CYCAMORE_PERF_TRACE file on exit.  Events may be added from
+/// several threads at once.
+class TraceLog {
+ public:
+  struct Event {
+    const char* phase;
+    std::string prototype;
+    int agent;
+    long long start_us;
+    long long dur_us;
+  };
+
+  /// @return the process' log, or NULL if tracing is not enabled
+  static TraceLog* Get() {
+    static const char* path = std::getenv("CYCAMORE_PERF_TRACE");
+    static TraceLog log(path == NULL ? "" : path);
+    return path == NULL ? NULL : &log;
+  }
+
+  void Add(const Event& e) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back(e);
+  }
+
+  ~TraceLog() {
+    if (path_.empty()) {
+      return;
+    }
+    std::ofstream f(path_.c_str());
+    f << "{\"traceEvents\": [";
+    for (int i = 0; i < events_.size(); i++) {
+      const Event& e = events_[i];
+      f << (i == 0 ? "\n" : ",\n") << "{\"name\": \"" << e.phase
+        << "\", \"cat\": \"" << e.prototype << "\", \"ph\": \"X\", \"ts\": "
+        << e.start_us << ", \"dur\": " << e.dur_us
+        << ", \"pid\": 0, \"tid\": " << e.agent << "}";
+    }
+    f << "\n]}\n";
+  }
+
+ private:
+  explicit TraceLog(const std::string& path) : path_(path) {}
+
+  std::string path_;
+  std::vector<Event> events_;
+  std::mutex mutex_;
+};
+
+/// PhaseTimers accumulates the calls and time of each phase of one agent and
+/// records them when the agent is deleted.
+class PhaseTimers {
+ public:
+  PhaseTimers() : agent_(NULL) {}
+
+  ~PhaseTimers() { Record(); }
+
+  /// adds one call of phase taking secs seconds for agent a
+  void Add(cyclus::Agent* a, const char* phase, double secs) {
+    agent_ = a;
+    // very few phases, compared by their (literal) pointers
+    for (int i = 0; i < stats_.size(); i++) {
+      if (stats_[i].phase == phase) {
+        stats_[i].calls++;
+        stats_[i].secs += secs;
+        return;
+      }
+    }
+    Stat s = {phase, 1, secs};
+    stats_.push_back(s);
+  }
+
+  /// records and clears the accumulated phase times
+  void Record() {
+    for (int i = 0; i < stats_.size(); i++) {
+      agent_->context()->NewDatum("ArchetypePerf")
+          ->AddVal("AgentId", agent_->id())
+          ->AddVal("Prototype", agent_->prototype())
+          ->AddVal("Spec", agent_->spec())
+          ->AddVal("Phase", std::string(stats_[i].phase))
+          ->AddVal("Calls", stats_[i].calls)
+          ->AddVal("Seconds", stats_[i].secs)
+          ->Record();
+    }
+    stats_.clear();
+  }
+
+ private:
+  struct Stat {
+    const char* phase;
+    int calls;
+    double secs;
+  };
+
+  cyclus::Agent* agent_;
+  std::vector<Stat> stats_;
+};
+
+/// PhaseTimer times one call of a phase, from its construction to the end of
+/// its scope.
+class PhaseTimer {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  PhaseTimer(PhaseTimers* timers, cyclus::Agent* a, const char* phase)
+      : timers_(timers), agent_(a), phase_(phase), start_(Clock::now()) {}
+
+  ~PhaseTimer() {
+    Clock::time_point end = Clock::now();
+    timers_->Add(agent_, phase_,
+                 std::chrono::duration<double>(end - start_).count());
+    TraceLog* log = TraceLog::Get();
+    if (log != NULL) {
+      using std::chrono::duration_cast;
+      using std::chrono::microseconds;
+      TraceLog::Event e = {
+          phase_, agent_->prototype(), agent_->id(),
+          duration_cast<microseconds>(start_.time_since_epoch()).count(),
+          duration_cast<microseconds>(end - start_).count()};
+      log->Add(e);
+    }
+  }
+
+ private:
+  PhaseTimers* timers_;
+  cyclus::Agent* agent_;
+  const char* phase_;
+  Clock::time_point start_;
+};
+
+}  // namespace cycamore
+
+#else
+
+#define CYCAMORE_PERF_SCOPE(phase)
+
+#endif  // CYCAMORE_PERF
+
+#endif  // CYCAMORE_SRC_PERF_H_
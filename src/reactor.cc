@@ -1,5 +1,7 @@
 #include "reactor.h"
 
+#include <limits>
+
 using cyclus::Material;
 using cyclus::Composition;
 using cyclus::toolkit::ResBuf;
@@ -10,19 +12,38 @@ using cyclus::Request;
 
 namespace cycamore {
 
+static const char* const kEventCols[] = {"AgentId", "Time", "Event", "Value"};
+static const char* const kSideProductCols[] = {"AgentId", "Time", "Product",
+                                               "Value"};
+
 Reactor::Reactor(cyclus::Context* ctx)
     : cyclus::Facility(ctx),
-      n_assem_batch(0),
       assem_size(0),
+      n_assem_batch(0),
       n_assem_core(0),
-      n_assem_spent(0),
       n_assem_fresh(0),
+      n_assem_spent(0),
+      bulk_order(false),
+      aggregate_bids(false),
+      bulk_assems(false),
       cycle_time(0),
       refuel_time(0),
       cycle_step(0),
       power_cap(0),
       power_name("power"),
       discharged(false),
+      fresh_view_(&fresh),
+      core_view_(&core),
+      spent_view_(&spent),
+      spent_index_valid_(false),
+      next_change_time_(-1),
+      side_producing_(-1),
+      spent_groups_version_(0),
+      events_("ReactorEvents", kEventCols),
+      side_product_rows_("ReactorSideProducts", kSideProductCols),
+      record_mode("all"),
+      record_interval(1),
+      memory_interval(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {}
@@ -63,6 +84,9 @@ void Reactor::InitFrom(cyclus::QueryableBackend* b) {
 
 void Reactor::EnterNotify() {
   cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  memory_.Init(memory_interval);
 
   // If the user ommitted fuel_prefs, we set it to zeros for each fuel
   // type.  Without this segfaults could occur - yuck.
@@ -107,6 +131,7 @@ void Reactor::EnterNotify() {
   if (ss.str().size() > 0) {
     throw cyclus::ValueError(ss.str());
   }
+  IndexOutcommods();
   RecordPosition();
 }
 
@@ -114,6 +139,17 @@ bool Reactor::CheckDecommissionCondition() {
   return core.count() == 0 && spent.count() == 0;
 }
 
+void Reactor::Decommission() {
+  FlushRecords();
+  cyclus::Facility::Decommission();
+}
+
+void Reactor::FlushRecords() {
+  record_policy_.Flush(this);
+  events_.Flush(context());
+  side_product_rows_.Flush(context());
+}
+
 void Reactor::Tick() {
   // The following code must go in the Tick so they fire on the time step
   // following the cycle_step update - allowing for the all reactor events to
@@ -122,6 +158,10 @@ void Reactor::Tick() {
   // can't go at the beginnin of the Tock is so that resource exchange has a
   // chance to occur after the discharge on this same time step.
 
+  // the spent index is rebuilt here if it is stale (e.g. after restarting
+  // from a snapshot) so that the exchange only reads it
+  SyncSpentIndex();
+
   if (retired()) {
     Record("RETIRED", "");
 
@@ -142,7 +182,7 @@ void Reactor::Tick() {
     // burn a batch from fresh inventory on this time step.  When retired,
     // this batch also needs to be discharged to spent fuel inventory.
     while (fresh.count() > 0 && spent.space() >= assem_size) {
-      spent.Push(fresh.Pop());
+      PushSpent(PopAssems(&fresh_view_, 1));
     }
     if(CheckDecommissionCondition()) {
       Decommission();    
@@ -150,6 +190,9 @@ void Reactor::Tick() {
     return;
   }
 
+  // not timed above - a retired reactor may delete itself when decommissioned
+  CYCAMORE_PERF_SCOPE("Tick");
+
   if (cycle_step == cycle_time) {
     Transmute();
     Record("CYCLE_END", "");
@@ -162,11 +205,23 @@ void Reactor::Tick() {
     Load();
   }
 
+  // preference and recipe changes are only looked for on the time steps
+  // they are due on
   int t = context()->time();
+  if (next_change_time_ < 0 || t >= next_change_time_) {
+    ApplyChanges(t);
+  }
+}
+
+void Reactor::ApplyChanges(int t) {
+  next_change_time_ = std::numeric_limits<int>::max();
 
   // update preferences
   for (int i = 0; i < pref_change_times.size(); i++) {
     int change_t = pref_change_times[i];
+    if (change_t > t) {
+      next_change_time_ = std::min(next_change_time_, change_t);
+    }
     if (t != change_t) {
       continue;
     }
@@ -183,6 +238,9 @@ void Reactor::Tick() {
   // update recipes
   for (int i = 0; i < recipe_change_times.size(); i++) {
     int change_t = recipe_change_times[i];
+    if (change_t > t) {
+      next_change_time_ = std::min(next_change_time_, change_t);
+    }
     if (t != change_t) {
       continue;
     }
@@ -199,14 +257,15 @@ void Reactor::Tick() {
 }
 
 std::set<cyclus::RequestPortfolio<Material>::Ptr> Reactor::GetMatlRequests() {
+  CYCAMORE_PERF_SCOPE("GetMatlRequests");
   using cyclus::RequestPortfolio;
 
   std::set<RequestPortfolio<Material>::Ptr> ports;
-  Material::Ptr m;
 
   // second min expression reduces assembles to amount needed until
   // retirement if it is near.
-  int n_assem_order = n_assem_core - core.count() + n_assem_fresh - fresh.count();
+  int n_assem_order = n_assem_core - assem_count(core) + n_assem_fresh -
+                      assem_count(fresh);
 
   if (exit_time() != -1) {
     // the +1 accounts for the fact that the reactor is alive and gets to
@@ -216,7 +275,7 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> Reactor::GetMatlRequests() {
     double n_cycles_left = static_cast<double>(t_left - t_left_cycle) /
                          static_cast<double>(cycle_time + refuel_time);
     n_cycles_left = ceil(n_cycles_left);
-    int n_need = std::max(0.0, n_cycles_left * n_assem_batch - n_assem_fresh + n_assem_core - core.count());
+    int n_need = std::max(0.0, n_cycles_left * n_assem_batch - n_assem_fresh + n_assem_core - assem_count(core));
     n_assem_order = std::min(n_assem_order, n_need);
   }
 
@@ -226,26 +285,34 @@ std::set<cyclus::RequestPortfolio<Material>::Ptr> Reactor::GetMatlRequests() {
     return ports;
   }
 
-  for (int i = 0; i < n_assem_order; i++) {
+  std::vector<double>::iterator result;
+  result = std::max_element(fuel_prefs.begin(), fuel_prefs.end());
+  int max_index = std::distance(fuel_prefs.begin(), result);
+
+  record_policy_.Defer("demand"+fuel_incommods[max_index],
+                       assem_size * n_assem_order);
+
+  // in bulk mode the whole order is one portfolio of n_assem_order
+  // assemblies, otherwise there is one portfolio per assembly. The request
+  // targets are the same for every portfolio, so they are shared.
+  int n_ports = bulk_order ? 1 : n_assem_order;
+  double qty = bulk_order ? assem_size * n_assem_order : assem_size;
+  MatVec targets;
+  for (int j = 0; j < fuel_incommods.size(); j++) {
+    Composition::Ptr recipe = context()->GetRecipe(fuel_inrecipes[j]);
+    targets.push_back(pool_.Get(context()->time(), qty, recipe));
+  }
+
+  for (int i = 0; i < n_ports; i++) {
     RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
     std::vector<Request<Material>*> mreqs;
     for (int j = 0; j < fuel_incommods.size(); j++) {
-      std::string commod = fuel_incommods[j];
-      double pref = fuel_prefs[j];
-      Composition::Ptr recipe = context()->GetRecipe(fuel_inrecipes[j]);
-      m = Material::CreateUntracked(assem_size, recipe);
-
-      Request<Material>* r = port->AddRequest(m, this, commod, pref, true);
+      Request<Material>* r = port->AddRequest(targets[j], this,
+                                              fuel_incommods[j], fuel_prefs[j],
+                                              true);
       mreqs.push_back(r);
     }
 
-    std::vector<double>::iterator result;
-    result = std::max_element(fuel_prefs.begin(), fuel_prefs.end());
-    int max_index = std::distance(fuel_prefs.begin(), result);
-
-    cyclus::toolkit::RecordTimeSeries<double>("demand"+fuel_incommods[max_index], this,
-                                          assem_size * n_assem_order) ;
-
     port->AddMutualReqs(mreqs);
     ports.insert(port);
   }
@@ -257,94 +324,136 @@ void Reactor::GetMatlTrades(
     const std::vector<cyclus::Trade<Material> >& trades,
     std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
         responses) {
+  CYCAMORE_PERF_SCOPE("GetMatlTrades");
   using cyclus::Trade;
 
-  std::map<std::string, MatVec> mats = PopSpent();
+  if (bulk_assems) {
+    GetBulkTrades(trades, responses);
+    return;
+  }
+  SyncSpentIndex();
+
+  std::set<int> traded;
   for (int i = 0; i < trades.size(); i++) {
-    std::string commod = trades[i].request->commodity();
-    Material::Ptr m = mats[commod].back();
-    mats[commod].pop_back();
+    int slot = outcommod_slots_[trades[i].request->commodity()];
+    Material::Ptr offer = trades[i].bid->offer();
+    std::map<Material*, int>::iterator g = bid_groups_.find(offer.get());
+
+    // aggregated bids are filled with the oldest assemblies of the offered
+    // composition, combined into a single material
+    int n = 1;
+    int comp_id = -1;
+    if (g != bid_groups_.end()) {
+      n = g->second;
+      comp_id = offer->comp()->id();
+    }
+
+    Material::Ptr m;
+    for (int j = 0; j < n; j++) {
+      Material::Ptr assem = PopSpent(slot, comp_id);
+      traded.insert(assem->obj_id());
+      res_indexes.erase(assem->obj_id());
+      if (j == 0) {
+        m = assem;
+      } else {
+        m->Absorb(assem);
+      }
+    }
     responses.push_back(std::make_pair(trades[i], m));
-    res_indexes.erase(m->obj_id());
   }
-  PushSpent(mats);  // return leftovers back to spent buffer
+  RemoveSpent(traded);
 }
 
 void Reactor::AcceptMatlTrades(const std::vector<
     std::pair<cyclus::Trade<Material>, Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("AcceptMatlTrades");
   std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                         cyclus::Material::Ptr> >::const_iterator trade;
 
+  // split bulk deliveries into individual assemblies, unless they are kept
+  // in bulk
+  MatVec assems;
+  int n_recv = 0;
+  for (trade = responses.begin(); trade != responses.end(); ++trade) {
+    std::string commod = trade->first.request->commodity();
+    Material::Ptr m = trade->second;
+    while (!bulk_assems && m->quantity() - assem_size > cyclus::eps_rsrc()) {
+      Material::Ptr assem = m->ExtractQty(assem_size);
+      index_res(assem, commod);
+      assems.push_back(assem);
+    }
+    index_res(m, commod);
+    assems.push_back(m);
+    n_recv += assem_count(m);
+  }
+
   std::stringstream ss;
-  int nload = std::min((int)responses.size(), n_assem_core - core.count());
+  int nload = std::min(n_recv, n_assem_core - assem_count(core));
   if (nload > 0) {
     ss << nload << " assemblies";
     Record("LOAD", ss.str());
   }
 
-  for (trade = responses.begin(); trade != responses.end(); ++trade) {
-    std::string commod = trade->first.request->commodity();
-    Material::Ptr m = trade->second;
-    index_res(m, commod);
-
-    if (core.count() < n_assem_core) {
-      core.Push(m);
+  for (int i = 0; i < assems.size(); i++) {
+    Material::Ptr m = assems[i];
+    int n_space = n_assem_core - assem_count(core);
+    if (n_space > 0 && n_space < assem_count(m)) {
+      Material::Ptr assem = m->ExtractQty(n_space * assem_size);
+      res_indexes[assem->obj_id()] = res_indexes[m->obj_id()];
+      PushAssems(&core_view_, assem);
+      PushAssems(&fresh_view_, m);
+    } else if (n_space > 0) {
+      PushAssems(&core_view_, m);
     } else {
-      fresh.Push(m);
+      PushAssems(&fresh_view_, m);
     }
   }
 }
 
 std::set<cyclus::BidPortfolio<Material>::Ptr> Reactor::GetMatlBids(
     cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_PERF_SCOPE("GetMatlBids");
   using cyclus::BidPortfolio;
   std::set<BidPortfolio<Material>::Ptr> ports;
 
-  bool gotmats = false;
-  std::map<std::string, MatVec> all_mats;
-
-  if (uniq_outcommods_.empty()) {
-    for (int i = 0; i < fuel_outcommods.size(); i++) {
-      uniq_outcommods_.insert(fuel_outcommods[i]);
-    }
+  bid_groups_.clear();
+  if (spent.count() == 0) {
+    return ports;
   }
+  SyncSpentIndex();
 
-  std::set<std::string>::iterator it;
-  for (it = uniq_outcommods_.begin(); it != uniq_outcommods_.end(); ++it) {
-    std::string commod = *it;
-    std::vector<Request<Material>*>& reqs = commod_requests[commod];
-    if (reqs.size() == 0) {
+  for (int slot = 0; slot < uniq_outcommods_.size(); slot++) {
+    const std::string& commod = uniq_outcommods_[slot];
+    const std::deque<Material::Ptr>& mats = spent_index_[slot];
+    if (mats.size() == 0 || commod_requests.count(commod) == 0) {
       continue;
-    } else if (!gotmats) {
-      all_mats = PeekSpent();
     }
-
-    MatVec mats = all_mats[commod];
-    if (mats.size() == 0) {
+    std::vector<Request<Material>*>& reqs = commod_requests[commod];
+    if (reqs.size() == 0) {
       continue;
     }
 
     BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
 
-    for (int j = 0; j < reqs.size(); j++) {
-      Request<Material>* req = reqs[j];
-      double tot_bid = 0;
-      for (int k = 0; k < mats.size(); k++) {
-        Material::Ptr m = mats[k];
-        tot_bid += m->quantity();
-        port->AddBid(req, m, this, true);
-        if (tot_bid >= req->target()->quantity()) {
-          break;
+    if (aggregate_bids || bulk_assems) {
+      SyncSpentGroups();
+      spent_groups_[slot].AddBids(port, reqs, this, &bid_groups_);
+    } else {
+      for (int j = 0; j < reqs.size(); j++) {
+        Request<Material>* req = reqs[j];
+        double tot_bid = 0;
+        for (int k = 0; k < mats.size(); k++) {
+          Material::Ptr m = mats[k];
+          tot_bid += m->quantity();
+          port->AddBid(req, m, this, true);
+          if (tot_bid >= req->target()->quantity()) {
+            break;
+          }
         }
       }
     }
 
-    double tot_qty = 0;
-    for (int j = 0; j < mats.size(); j++) {
-      tot_qty += mats[j]->quantity();
-    }
-
-    cyclus::CapacityConstraint<Material> cc(tot_qty);
+    cyclus::CapacityConstraint<Material> cc(spent_qty_[slot]);
     port->AddConstraint(cc);
     ports.insert(port);
   }
@@ -352,74 +461,93 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> Reactor::GetMatlBids(
   return ports;
 }
 
+void Reactor::SyncSpentGroups() {
+  SyncSpentIndex();
+  unsigned long version = spent_view_.version();
+  if (version == spent_groups_version_ &&
+      spent_groups_.size() == uniq_outcommods_.size()) {
+    return;
+  }
+  spent_groups_.assign(uniq_outcommods_.size(), SpentGroups());
+  spent_groups_version_ = version;
+
+  for (int slot = 0; slot < spent_index_.size(); slot++) {
+    const std::deque<Material::Ptr>& mats = spent_index_[slot];
+    for (int k = 0; k < mats.size(); k++) {
+      spent_groups_[slot].Add(mats[k], assem_count(mats[k]));
+    }
+  }
+}
+
 void Reactor::Tock() {
+  CYCAMORE_PERF_SCOPE("Tock");
+  if (memory_.Due(context()->time())) {
+    memory_.Add("fresh", fresh);
+    memory_.Add("core", core);
+    memory_.Add("spent", spent);
+    memory_.Add("res_indexes", res_indexes);
+    memory_.Flush(this);
+  }
+
   if (retired()) {
+    FlushRecords();
     return;
   }
   
   // Check that irradiation and refueling periods are over, that 
   // the core is full and that fuel was successfully discharged in this refueling time.
   // If this is the case, then a new cycle will be initiated.
-  if (cycle_step >= cycle_time + refuel_time && core.count() == n_assem_core && discharged == true) {
+  int n_core = assem_count(core);
+  if (cycle_step >= cycle_time + refuel_time && n_core == n_assem_core && discharged == true) {
     discharged = false;
     cycle_step = 0;
   }
 
-  if (cycle_step == 0 && core.count() == n_assem_core) {
+  if (cycle_step == 0 && n_core == n_assem_core) {
     Record("CYCLE_START", "");
   }
 
   if (cycle_step >= 0 && cycle_step < cycle_time &&
-      core.count() == n_assem_core) {
-    cyclus::toolkit::RecordTimeSeries<cyclus::toolkit::POWER>(this, power_cap);
-    cyclus::toolkit::RecordTimeSeries<double>("supplyPOWER", this, power_cap);
+      n_core == n_assem_core) {
+    record_policy_.TimeSeries<cyclus::toolkit::POWER>(this, power_cap);
+    record_policy_.TimeSeries("supplyPOWER", this, power_cap);
     RecordSideProduct(true);
   } else {
-    cyclus::toolkit::RecordTimeSeries<cyclus::toolkit::POWER>(this, 0);
-    cyclus::toolkit::RecordTimeSeries<double>("supplyPOWER", this, 0);
+    record_policy_.TimeSeries<cyclus::toolkit::POWER>(this, 0);
+    record_policy_.TimeSeries("supplyPOWER", this, 0);
     RecordSideProduct(false);
   }
 
   // "if" prevents starting cycle after initial deployment until core is full
   // even though cycle_step is its initial zero.
-  if (cycle_step > 0 || core.count() == n_assem_core) {
+  if (cycle_step > 0 || n_core == n_assem_core) {
     cycle_step++;
   }
+  FlushRecords();
 }
 
 void Reactor::Transmute() { Transmute(n_assem_batch); }
 
 void Reactor::Transmute(int n_assem) {
-  MatVec old = core.PopN(std::min(n_assem, core.count()));
-  core.Push(old);
-  if (core.count() > old.size()) {
-    // rotate untransmuted mats back to back of buffer
-    core.Push(core.PopN(core.count() - old.size()));
-  }
+  // the oldest assemblies are at the front of the core and are transmuted in
+  // place
+  int n = std::min(n_assem, assem_count(core));
+  SplitCore(n);
+  const std::deque<Material::Ptr>& old = core_view_.contents();
 
   std::stringstream ss;
-  ss << old.size() << " assemblies";
+  ss << n << " assemblies";
   Record("TRANSMUTE", ss.str());
 
-  for (int i = 0; i < old.size(); i++) {
+  for (int i = 0, j = 0; j < n; i++) {
     old[i]->Transmute(context()->GetRecipe(fuel_outrecipe(old[i])));
+    j += assem_count(old[i]);
   }
 }
 
-std::map<std::string, MatVec> Reactor::PeekSpent() {
-  std::map<std::string, MatVec> mapped;
-  MatVec mats = spent.PopN(spent.count());
-  spent.Push(mats);
-  for (int i = 0; i < mats.size(); i++) {
-    std::string commod = fuel_outcommod(mats[i]);
-    mapped[commod].push_back(mats[i]);
-  }
-  return mapped;
-}
-
 bool Reactor::Discharge() {
-  int npop = std::min(n_assem_batch, core.count());
-  if (n_assem_spent - spent.count() < npop) {
+  int npop = std::min(n_assem_batch, assem_count(core));
+  if (n_assem_spent - assem_count(spent) < npop) {
     Record("DISCHARGE", "failed");
     return false;  // not enough room in spent buffer
   }
@@ -427,25 +555,20 @@ bool Reactor::Discharge() {
   std::stringstream ss;
   ss << npop << " assemblies";
   Record("DISCHARGE", ss.str());
-  spent.Push(core.PopN(npop));
+  PushSpent(PopAssems(&core_view_, npop));
 
-  std::map<std::string, MatVec> spent_mats;
+  IndexOutcommods();
+  SyncSpentIndex();
   for (int i = 0; i < fuel_outcommods.size(); i++) {
-    spent_mats = PeekSpent();
-    MatVec mats = spent_mats[fuel_outcommods[i]];
-    double tot_spent = 0;
-    for (int j = 0; j<mats.size(); j++){
-      Material::Ptr m = mats[j];
-      tot_spent += m->quantity();
-    }
-    cyclus::toolkit::RecordTimeSeries<double>("supply"+fuel_outcommods[i], this, tot_spent);
+    double tot_spent = spent_qty_[out_slots_[i]];
+    record_policy_.TimeSeries("supply"+fuel_outcommods[i], this, tot_spent);
   }
 
   return true;
 }
 
 void Reactor::Load() {
-  int n = std::min(n_assem_core - core.count(), fresh.count());
+  int n = std::min(n_assem_core - assem_count(core), assem_count(fresh));
   if (n == 0) {
     return;
   }
@@ -453,10 +576,13 @@ void Reactor::Load() {
   std::stringstream ss;
   ss << n << " assemblies";
   Record("LOAD", ss.str());
-  core.Push(fresh.PopN(n));
+  MatVec mats = PopAssems(&fresh_view_, n);
+  for (int i = 0; i < mats.size(); i++) {
+    PushAssems(&core_view_, mats[i]);
+  }
 }
 
-std::string Reactor::fuel_incommod(Material::Ptr m) {
+const std::string& Reactor::fuel_incommod(Material::Ptr m) {
   int i = res_indexes[m->obj_id()];
   if (i >= fuel_incommods.size()) {
     throw KeyError("cycamore::Reactor - no incommod for material object");
@@ -464,7 +590,7 @@ std::string Reactor::fuel_incommod(Material::Ptr m) {
   return fuel_incommods[i];
 }
 
-std::string Reactor::fuel_outcommod(Material::Ptr m) {
+const std::string& Reactor::fuel_outcommod(Material::Ptr m) {
   int i = res_indexes[m->obj_id()];
   if (i >= fuel_outcommods.size()) {
     throw KeyError("cycamore::Reactor - no outcommod for material object");
@@ -472,7 +598,7 @@ std::string Reactor::fuel_outcommod(Material::Ptr m) {
   return fuel_outcommods[i];
 }
 
-std::string Reactor::fuel_inrecipe(Material::Ptr m) {
+const std::string& Reactor::fuel_inrecipe(Material::Ptr m) {
   int i = res_indexes[m->obj_id()];
   if (i >= fuel_inrecipes.size()) {
     throw KeyError("cycamore::Reactor - no inrecipe for material object");
@@ -480,7 +606,7 @@ std::string Reactor::fuel_inrecipe(Material::Ptr m) {
   return fuel_inrecipes[i];
 }
 
-std::string Reactor::fuel_outrecipe(Material::Ptr m) {
+const std::string& Reactor::fuel_outrecipe(Material::Ptr m) {
   int i = res_indexes[m->obj_id()];
   if (i >= fuel_outrecipes.size()) {
     throw KeyError("cycamore::Reactor - no outrecipe for material object");
@@ -507,34 +633,233 @@ void Reactor::index_res(cyclus::Resource::Ptr m, std::string incommod) {
       "cycamore::Reactor - received unsupported incommod material");
 }
 
-std::map<std::string, MatVec> Reactor::PopSpent() {
-  MatVec mats = spent.PopN(spent.count());
-  std::map<std::string, MatVec> mapped;
+int Reactor::outcommod_slot(Material::Ptr m) {
+  int i = res_indexes[m->obj_id()];
+  if (i >= out_slots_.size()) {
+    throw KeyError("cycamore::Reactor - no outcommod for material object");
+  }
+  return out_slots_[i];
+}
+
+void Reactor::IndexOutcommods() {
+  if (!uniq_outcommods_.empty()) {
+    return;
+  }
+  std::set<std::string> uniq(fuel_outcommods.begin(), fuel_outcommods.end());
+  uniq_outcommods_.assign(uniq.begin(), uniq.end());
+  for (int i = 0; i < uniq_outcommods_.size(); i++) {
+    outcommod_slots_[uniq_outcommods_[i]] = i;
+  }
+  for (int i = 0; i < fuel_outcommods.size(); i++) {
+    out_slots_.push_back(outcommod_slots_[fuel_outcommods[i]]);
+  }
+}
+
+void Reactor::SyncSpentIndex() {
+  if (spent_index_valid_) {
+    return;
+  }
+  IndexOutcommods();
+  spent_index_.assign(uniq_outcommods_.size(),
+                      std::deque<Material::Ptr>());
+  spent_qty_.assign(uniq_outcommods_.size(), 0);
+  spent_index_valid_ = true;
+
+  const std::deque<Material::Ptr>& mats = spent_view_.contents();
   for (int i = 0; i < mats.size(); i++) {
-    std::string commod = fuel_outcommod(mats[i]);
-    mapped[commod].push_back(mats[i]);
+    int slot = outcommod_slot(mats[i]);
+    spent_index_[slot].push_back(mats[i]);
+    spent_qty_[slot] += mats[i]->quantity();
+  }
+}
+
+void Reactor::PushSpent(Material::Ptr m) {
+  int slot = outcommod_slot(m);
+  double qty = m->quantity();
+  bool absorbed = PushAssems(&spent_view_, m);
+  if (!spent_index_valid_) {
+    return;  // picked up when the index is rebuilt
+  }
+  if (!absorbed) {
+    spent_index_[slot].push_back(m);
+  }
+  spent_qty_[slot] += qty;
+}
+
+void Reactor::PushSpent(const MatVec& mats) {
+  for (int i = 0; i < mats.size(); i++) {
+    PushSpent(mats[i]);
+  }
+}
+
+Material::Ptr Reactor::PopSpent(int slot, int comp_id) {
+  SyncSpentIndex();
+  std::deque<Material::Ptr>& mats = spent_index_[slot];
+  std::deque<Material::Ptr>::iterator it = mats.begin();
+  if (comp_id >= 0) {
+    while (it != mats.end() && (*it)->comp()->id() != comp_id) {
+      ++it;
+    }
+  }
+  if (it == mats.end()) {
+    throw ValueError("cycamore::Reactor - no spent fuel left to trade on " +
+                     uniq_outcommods_[slot]);
+  }
+  Material::Ptr m = *it;
+  mats.erase(it);
+  // avoid accumulating round-off once the slot is empty
+  spent_qty_[slot] = mats.empty() ? 0 : spent_qty_[slot] - m->quantity();
+  return m;
+}
+
+void Reactor::RemoveSpent(const std::set<int>& obj_ids) {
+  if (obj_ids.empty()) {
+    return;
+  }
+  MatVec mats = spent_view_.PopN(spent.count());
+  MatVec keep;
+  for (int i = 0; i < mats.size(); i++) {
+    if (obj_ids.count(mats[i]->obj_id()) == 0) {
+      keep.push_back(mats[i]);
+    }
+  }
+  spent_view_.Push(keep);
+}
+
+int Reactor::assem_count(Material::Ptr m) {
+  if (!bulk_assems) {
+    return 1;
   }
+  return static_cast<int>(m->quantity() / assem_size + 0.5);
+}
 
-  // needed so we trade away oldest assemblies first
-  std::map<std::string, MatVec>::iterator it;
-  for (it = mapped.begin(); it != mapped.end(); ++it) {
-    std::reverse(it->second.begin(), it->second.end());
+int Reactor::assem_count(const ResBuf<Material>& buf) {
+  if (!bulk_assems) {
+    return buf.count();
   }
+  return static_cast<int>(buf.quantity() / assem_size + 0.5);
+}
 
-  return mapped;
+MatVec Reactor::PopAssems(ResBufView<Material>* buf, int n) {
+  MatVec mats;
+  while (n > 0 && buf->count() > 0) {
+    Material::Ptr m = (*buf)[0];
+    int k = assem_count(m);
+    if (k <= n) {
+      mats.push_back(buf->Pop());
+      n -= k;
+    } else {
+      Material::Ptr part = buf->Pop(n * assem_size);
+      res_indexes[part->obj_id()] = res_indexes[m->obj_id()];
+      mats.push_back(part);
+      n = 0;
+    }
+  }
+  return mats;
 }
 
-void Reactor::PushSpent(std::map<std::string, MatVec> leftover) {
-  std::map<std::string, MatVec>::iterator it;
-  for (it = leftover.begin(); it != leftover.end(); ++it) {
-    // undo reverse in PopSpent to make sure oldest assemblies come out first
-    std::reverse(it->second.begin(), it->second.end());
-    spent.Push(it->second);
+bool Reactor::PushAssems(ResBufView<Material>* buf, Material::Ptr m) {
+  if (bulk_assems && buf->count() > 0) {
+    Material::Ptr back = buf->contents().back();
+    if (back->comp()->id() == m->comp()->id() &&
+        res_indexes[back->obj_id()] == res_indexes[m->obj_id()]) {
+      // popped while absorbing so that the buffer's quantity stays correct
+      back = buf->PopBack();
+      back->Absorb(m);
+      res_indexes.erase(m->obj_id());
+      buf->Push(back);
+      return true;
+    }
   }
+  buf->Push(m);
+  return false;
+}
+
+void Reactor::SplitCore(int n) {
+  if (!bulk_assems) {
+    return;
+  }
+  const std::deque<Material::Ptr>& mats = core_view_.contents();
+  int i = 0;
+  while (i < mats.size() && n >= assem_count(mats[i])) {
+    n -= assem_count(mats[i]);
+    i++;
+  }
+  if (n == 0 || i == mats.size()) {
+    return;  // already on a material boundary
+  }
+
+  MatVec all = core_view_.PopN(core.count());
+  Material::Ptr part = all[i]->ExtractQty(n * assem_size);
+  res_indexes[part->obj_id()] = res_indexes[all[i]->obj_id()];
+  all.insert(all.begin() + i, part);
+  core_view_.Push(all);
+}
+
+void Reactor::GetBulkTrades(
+    const std::vector<cyclus::Trade<Material> >& trades,
+    std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
+        responses) {
+  // all spent fuel is taken out of the buffer so that materials can be split
+  // outside of it, the rest is pushed back in its order
+  MatVec mats = spent_view_.PopN(spent.count());
+  spent_index_valid_ = false;
+
+  for (int i = 0; i < trades.size(); i++) {
+    int slot = outcommod_slots_[trades[i].request->commodity()];
+    Material::Ptr offer = trades[i].bid->offer();
+    int n = bid_groups_[offer.get()];
+    int comp_id = offer->comp()->id();
+
+    Material::Ptr m;
+    for (int k = 0; k < mats.size() && n > 0; k++) {
+      if (mats[k].get() == NULL || mats[k]->comp()->id() != comp_id ||
+          outcommod_slot(mats[k]) != slot) {
+        continue;
+      }
+      Material::Ptr part;
+      if (assem_count(mats[k]) <= n) {
+        part = mats[k];
+        n -= assem_count(part);
+        res_indexes.erase(part->obj_id());
+        mats[k] = Material::Ptr();
+      } else {
+        part = mats[k]->ExtractQty(n * assem_size);
+        n = 0;
+      }
+      if (m.get() == NULL) {
+        m = part;
+      } else {
+        m->Absorb(part);
+      }
+    }
+    if (m.get() == NULL ||
+        m->quantity() < trades[i].amt - cyclus::eps_rsrc()) {
+      throw ValueError("cycamore::Reactor - no spent fuel left to trade on " +
+                       uniq_outcommods_[slot]);
+    }
+    responses.push_back(std::make_pair(trades[i], m));
+  }
+
+  MatVec keep;
+  for (int k = 0; k < mats.size(); k++) {
+    if (mats[k].get() != NULL) {
+      keep.push_back(mats[k]);
+    }
+  }
+  spent_view_.Push(keep);
+  SyncSpentIndex();
 }
 
 void Reactor::RecordSideProduct(bool produce){
-  if (hybrid_){
+  // side products start and end with power, so in "runs" mode they are only
+  // recorded when that changes
+  if (record_policy_.mode() == "runs" && side_producing_ == produce) {
+    return;
+  }
+  side_producing_ = produce;
+
+  if (hybrid_ && record_policy_.RecordsEvents(context()->time())) {
     double value;
     for (int i = 0; i < side_products.size(); i++) {
       if (produce){
@@ -544,25 +869,15 @@ void Reactor::RecordSideProduct(bool produce){
           value = 0;
       }
 
-      context()
-          ->NewDatum("ReactorSideProducts")
-          ->AddVal("AgentId", id())
-          ->AddVal("Time", context()->time())
-          ->AddVal("Product", side_products[i])
-          ->AddVal("Value", value)
-          ->Record();
+      side_product_rows_.Add(id(), context()->time(), side_products[i], value);
     }
   }
 }
 
 void Reactor::Record(std::string name, std::string val) {
-  context()
-      ->NewDatum("ReactorEvents")
-      ->AddVal("AgentId", id())
-      ->AddVal("Time", context()->time())
-      ->AddVal("Event", name)
-      ->AddVal("Value", val)
-      ->Record();
+  if (record_policy_.RecordsEvents(context()->time())) {
+    events_.Add(id(), context()->time(), name, val);
+  }
 }
 
 void Reactor::RecordPosition() {
@@ -3,6 +3,11 @@
 
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "res_buf_view.h"
+#include "spent_groups.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -116,6 +121,7 @@ class Reactor : public cyclus::Facility,
   virtual void Tock();
   virtual void EnterNotify();
   virtual bool CheckDecommissionCondition();
+  virtual void Decommission();
 
   virtual void AcceptMatlTrades(const std::vector<std::pair<
       cyclus::Trade<cyclus::Material>, cyclus::Material::Ptr> >& responses);
@@ -134,12 +140,15 @@ class Reactor : public cyclus::Facility,
   #pragma cyclus decl
 
  private:
-  std::string fuel_incommod(cyclus::Material::Ptr m);
-  std::string fuel_outcommod(cyclus::Material::Ptr m);
-  std::string fuel_inrecipe(cyclus::Material::Ptr m);
-  std::string fuel_outrecipe(cyclus::Material::Ptr m);
+  const std::string& fuel_incommod(cyclus::Material::Ptr m);
+  const std::string& fuel_outcommod(cyclus::Material::Ptr m);
+  const std::string& fuel_inrecipe(cyclus::Material::Ptr m);
+  const std::string& fuel_outrecipe(cyclus::Material::Ptr m);
   double fuel_pref(cyclus::Material::Ptr m);
 
+  /// Returns the unique outcommod slot of the given assembly.
+  int outcommod_slot(cyclus::Material::Ptr m);
+
   bool retired() {
     return exit_time() != -1 && context()->time() > exit_time();
   }
@@ -161,6 +170,10 @@ class Reactor : public cyclus::Facility,
   /// Records production of side products from the reactor
   void RecordSideProduct(bool produce);
 
+  /// Applies the preference and recipe changes due on time step t and
+  /// finds the time step of the next change.
+  void ApplyChanges(int t);
+
   /// Transmute the specified number of assemblies in the core to their
   /// fully burnt state as defined by their outrecipe.
   void Transmute(int n_assem);
@@ -168,17 +181,58 @@ class Reactor : public cyclus::Facility,
   /// Records a reactor event to the output db with the given name and note val.
   void Record(std::string name, std::string val);
 
-  /// Complement of PopSpent - must be called with all materials passed that
-  /// were not traded away to other agents.
-  void PushSpent(std::map<std::string, cyclus::toolkit::MatVec> leftover);
-
-  /// Returns all spent assemblies indexed by outcommod - removing them from
-  /// the spent fuel buffer.
-  std::map<std::string, cyclus::toolkit::MatVec> PopSpent();
-
-  /// Returns all spent assemblies indexed by outcommod without removing them
-  /// from the spent fuel buffer.
-  std::map<std::string, cyclus::toolkit::MatVec> PeekSpent();
+  /// Assigns each unique outcommod an integer slot (in sorted order) and maps
+  /// each fuel index to the slot of its outcommod.
+  void IndexOutcommods();
+
+  /// Rebuilds the per-slot spent fuel index from the spent fuel buffer if it
+  /// is not yet in step with it (e.g. on first use after a restart).
+  void SyncSpentIndex();
+
+  /// Adds the given assemblies to the back of the spent fuel buffer and the
+  /// spent fuel index.
+  void PushSpent(cyclus::Material::Ptr m);
+  void PushSpent(const cyclus::toolkit::MatVec& mats);
+
+  /// Removes and returns the oldest spent assembly in the given outcommod
+  /// slot (with the given composition id, if not negative) from the spent
+  /// fuel index.  The assembly stays in the spent fuel
+  /// buffer until RemoveSpent is called.
+  cyclus::Material::Ptr PopSpent(int slot, int comp_id = -1);
+
+  /// Regroups the spent fuel of every outcommod slot by composition if the
+  /// spent fuel buffer changed since the groups were last built.
+  void SyncSpentGroups();
+
+  /// Removes the given assemblies from the spent fuel buffer, preserving the
+  /// order of the remaining ones.
+  void RemoveSpent(const std::set<int>& obj_ids);
+
+  /// Returns the number of assemblies the given material (always one unless
+  /// bulk_assems is set) or buffer holds.
+  int assem_count(cyclus::Material::Ptr m);
+  int assem_count(const cyclus::toolkit::ResBuf<cyclus::Material>& buf);
+
+  /// Pops the (up to) n oldest assemblies of the given buffer.  In bulk mode a
+  /// material holding more assemblies than needed is split, leaving the rest
+  /// at the front of the buffer.
+  cyclus::toolkit::MatVec PopAssems(ResBufView<cyclus::Material>* buf, int n);
+
+  /// Pushes m to the back of the given buffer.  In bulk mode m is absorbed
+  /// by the newest material of the buffer instead if both have the same
+  /// composition and fuel index.  Returns true if m was absorbed.
+  bool PushAssems(ResBufView<cyclus::Material>* buf, cyclus::Material::Ptr m);
+
+  /// Splits the core's material holding the n'th oldest assembly (in bulk
+  /// mode) so that the n oldest assemblies are whole materials.
+  void SplitCore(int n);
+
+  /// Fills the trades in bulk mode, splitting spent materials only if a part
+  /// of them is traded.
+  void GetBulkTrades(
+      const std::vector<cyclus::Trade<cyclus::Material> >& trades,
+      std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                            cyclus::Material::Ptr> >& responses);
 
   /////// fuel specifications /////////
   #pragma cyclus var { \
@@ -302,6 +356,40 @@ class Reactor : public cyclus::Facility,
            " reactor operation stalls.", \
   }
   int n_assem_spent;
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Order Fuel in Bulk", \
+    "doc": "If true, all assemblies needed on a time step are ordered with a " \
+           "single all-or-nothing request per fuel commodity and the " \
+           "received material is split into assemblies. This keeps large " \
+           "orders (e.g. an initial core) small in the exchange, but the " \
+           "whole order must then come from one supplier. If false (the " \
+           "default), each assembly is requested separately.", \
+  }
+  bool bulk_order;
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Aggregate Spent Fuel Bids", \
+    "doc": "If true, spent fuel is offered with one bid per request and " \
+           "spent fuel composition, each for as many whole assemblies as fit " \
+           "the request, instead of one bid per assembly. A matched bid is " \
+           "filled with the oldest assemblies of that composition, combined " \
+           "into one material. This keeps the exchange small for reactors " \
+           "holding many spent assemblies.", \
+  }
+  bool aggregate_bids;
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Bulk Assemblies", \
+    "doc": "If true, same-recipe assemblies that enter an inventory " \
+           "together (e.g. a bulk order or a discharged batch) are kept as " \
+           "one material holding several assemblies. Batches are " \
+           "transmuted, discharged and traded as a whole and only split " \
+           "when a part of them is needed. Spent fuel is then always " \
+           "offered as with aggregate_bids. Assembly counts in events and " \
+           "trades are the same as without bulk assemblies.", \
+  }
+  bool bulk_assems;
 
    ///////// cycle params ///////////
   #pragma cyclus var { \
@@ -431,8 +519,63 @@ class Reactor : public cyclus::Facility,
   }
   std::map<int, int> res_indexes;
 
-  // populated lazily and no need to persist.
-  std::set<std::string> uniq_outcommods_;
+  // populated on EnterNotify and no need to persist. uniq_outcommods_ holds
+  // each distinct outcommod once in sorted order, outcommod_slots_ maps them to
+  // their position and out_slots_ maps each fuel index to its outcommod's slot.
+  std::vector<std::string> uniq_outcommods_;
+  std::map<std::string, int> outcommod_slots_;
+  std::vector<int> out_slots_;
+
+  // read-only access to the inventories without pop/push round trips - all
+  // pushes and pops of those buffers go through these
+  ResBufView<cyclus::Material> fresh_view_;
+  ResBufView<cyclus::Material> core_view_;
+  ResBufView<cyclus::Material> spent_view_;
+
+  // spent fuel assemblies (oldest first) and their total quantity for each
+  // outcommod slot. Rebuilt from the spent buffer on first use, so there is
+  // no need to persist.
+  std::vector<std::deque<cyclus::Material::Ptr> > spent_index_;
+  std::vector<double> spent_qty_;
+  bool spent_index_valid_;
+
+  // time step of the next preference or recipe change (INT_MAX if there is
+  // none), or -1 if not yet known. Found again on first use, so there is no
+  // need to persist.
+  int next_change_time_;
+
+  // whether side products were last recorded as produced (-1 if not yet
+  // recorded), for the "runs" recording mode
+  int side_producing_;
+
+  // offer of each aggregated spent fuel bid -> number of assemblies it
+  // stands for. Only used within a single exchange.
+  std::map<cyclus::Material*, int> bid_groups_;
+
+  // spent fuel groups of each outcommod slot, reused for the aggregated bids
+  // of every time step until the spent buffer's version moves on from
+  // spent_groups_version_. Rebuilt on first use, so there is no need to
+  // persist.
+  std::vector<SpentGroups> spent_groups_;
+  unsigned long spent_groups_version_;
+
+  // ReactorEvents and ReactorSideProducts rows of the current time step,
+  // flushed at the end of the Tock and on decommissioning.
+  RecordBuffer<int, int, std::string, std::string> events_;
+  RecordBuffer<int, int, std::string, double> side_product_rows_;
+  void FlushRecords();
+
+  #include "record_policy.cycpp.h"
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
 
   #pragma cyclus var { \
     "default": 0.0, \
@@ -452,8 +595,22 @@ class Reactor : public cyclus::Facility,
 
   cyclus::toolkit::Position coordinates;
 
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
+  /// request targets shared between requests and time steps
+  UntrackedPool pool_;
+
   /// Records an agent's latitude and longitude to the output db
   void RecordPosition();
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 } // namespace cycamore
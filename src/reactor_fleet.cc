@@ -0,0 +1,634 @@
+#include "reactor_fleet.h"
+
+using cyclus::Material;
+using cyclus::Composition;
+using cyclus::toolkit::MatVec;
+using cyclus::KeyError;
+using cyclus::ValueError;
+using cyclus::Request;
+
+namespace cycamore {
+
+static const char* const kEventCols[] = {"AgentId", "Time", "Event", "Value"};
+
+ReactorFleet::ReactorFleet(cyclus::Context* ctx)
+    : cyclus::Facility(ctx),
+      n_units(1),
+      record_unit_events(false),
+      assem_size(0),
+      n_assem_batch(0),
+      n_assem_core(0),
+      n_assem_fresh(0),
+      n_assem_spent(0),
+      cycle_time(0),
+      refuel_time(0),
+      power_cap(0),
+      power_name("power"),
+      decom_transmute_all(false),
+      core_view_(&core),
+      spent_view_(&spent),
+      spent_groups_version_(0),
+      events_("ReactorEvents", kEventCols),
+      record_mode("all"),
+      record_interval(1),
+      memory_interval(0) {}
+
+#pragma cyclus def clone cycamore::ReactorFleet
+
+#pragma cyclus def schema cycamore::ReactorFleet
+
+#pragma cyclus def annotations cycamore::ReactorFleet
+
+#pragma cyclus def infiletodb cycamore::ReactorFleet
+
+#pragma cyclus def snapshot cycamore::ReactorFleet
+
+#pragma cyclus def snapshotinv cycamore::ReactorFleet
+
+#pragma cyclus def initinv cycamore::ReactorFleet
+
+void ReactorFleet::InitFrom(ReactorFleet* m) {
+  #pragma cyclus impl initfromcopy cycamore::ReactorFleet
+  cyclus::toolkit::CommodityProducer::Copy(m);
+}
+
+void ReactorFleet::InitFrom(cyclus::QueryableBackend* b) {
+  #pragma cyclus impl initfromdb cycamore::ReactorFleet
+
+  namespace tk = cyclus::toolkit;
+  tk::CommodityProducer::Add(tk::Commodity(power_name),
+                             tk::CommodInfo(n_units * power_cap,
+                                            n_units * power_cap));
+}
+
+void ReactorFleet::EnterNotify() {
+  cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  memory_.Init(memory_interval);
+
+  if (fuel_prefs.size() == 0) {
+    for (int i = 0; i < fuel_outcommods.size(); i++) {
+      fuel_prefs.push_back(cyclus::kDefaultPref);
+    }
+  }
+  if (unit_delays.size() == 0) {
+    unit_delays.assign(n_units, 0);
+  }
+  if (cycle_steps.size() == 0) {
+    cycle_steps.assign(n_units, 0);
+  }
+  if (discharged.size() == 0) {
+    discharged.assign(n_units, 0);
+  }
+
+  // input consistency checking:
+  std::stringstream ss;
+  if (n_units < 1) {
+    ss << "prototype '" << prototype() << "' has " << n_units
+       << " units, expected at least 1\n";
+  }
+  if (unit_delays.size() != n_units) {
+    ss << "prototype '" << prototype() << "' has " << unit_delays.size()
+       << " unit_delays vals, expected " << n_units << "\n";
+  }
+  if (cycle_steps.size() != n_units) {
+    ss << "prototype '" << prototype() << "' has " << cycle_steps.size()
+       << " cycle_steps vals, expected " << n_units << "\n";
+  }
+  if (discharged.size() != n_units) {
+    ss << "prototype '" << prototype() << "' has " << discharged.size()
+       << " discharged vals, expected " << n_units << "\n";
+  }
+  if (n_assem_batch < 1) {
+    ss << "prototype '" << prototype() << "' has " << n_assem_batch
+       << " assemblies per batch, expected at least 1\n";
+  }
+
+  if (ss.str().size() > 0) {
+    throw cyclus::ValueError(ss.str());
+  }
+  SyncCoreCounts();
+}
+
+bool ReactorFleet::CheckDecommissionCondition() {
+  return core.count() == 0 && spent.count() == 0;
+}
+
+void ReactorFleet::Decommission() {
+  FlushRecords();
+  cyclus::Facility::Decommission();
+}
+
+void ReactorFleet::FlushRecords() {
+  record_policy_.Flush(this);
+  for (int i = 0; i < unit_event_counts_.size(); i++) {
+    const std::pair<std::string, std::string>& ev =
+        unit_event_counts_[i].first;
+    std::stringstream ss;
+    ss << unit_event_counts_[i].second << " units";
+    if (!ev.second.empty()) {
+      ss << ", " << ev.second;
+    }
+    events_.Add(id(), context()->time(), ev.first, ss.str());
+  }
+  unit_event_counts_.clear();
+  events_.Flush(context());
+}
+
+void ReactorFleet::Tick() {
+  // as for the Reactor, cycle ends, discharges and loads happen in the Tick
+  // so that they are recorded at the "beginning" of a time step and resource
+  // exchange can occur after a discharge on the same time step.
+  SyncCoreCounts();
+
+  if (retired()) {
+    Record(-1, "RETIRED", "");
+
+    if (context()->time() == exit_time() + 1) {  // only need to transmute once
+      int n = decom_transmute_all ?
+              n_assem_core : (n_assem_core + 1) / 2;
+      for (int u = 0; u < n_units; u++) {
+        Transmute(u, n);
+      }
+    }
+    bool discharged_any = false;
+    for (int u = 0; u < n_units; u++) {
+      while (core_counts_[u] > 0) {
+        if (!Discharge(u)) {
+          break;
+        }
+        discharged_any = true;
+      }
+    }
+    // fresh fuel left over from units loaded late is discharged as well
+    while (fresh.count() > 0 && spent.space() >= assem_size) {
+      spent_view_.Push(fresh.Pop());
+    }
+    if (discharged_any) {
+      RecordSupply();
+    }
+    if (CheckDecommissionCondition()) {
+      Decommission();
+    }
+    return;
+  }
+
+  // not timed above - a retired fleet may delete itself when decommissioned
+  CYCAMORE_PERF_SCOPE("Tick");
+
+  bool discharged_any = false;
+  for (int u = 0; u < n_units; u++) {
+    if (!online(u)) {
+      continue;
+    }
+    int cycle_step = cycle_steps[u];
+    if (cycle_step == cycle_time) {
+      Transmute(u, n_assem_batch);
+      Record(u, "CYCLE_END", "");
+    }
+    if (cycle_step >= cycle_time && !discharged[u]) {
+      discharged[u] = Discharge(u);
+      discharged_any = discharged_any || discharged[u];
+    }
+    // units that have not started their first cycle yet are loaded too, as
+    // the fresh fuel is shared
+    if (cycle_step >= cycle_time || cycle_step == 0) {
+      Load(u);
+    }
+  }
+  if (discharged_any) {
+    RecordSupply();
+  }
+}
+
+std::set<cyclus::RequestPortfolio<Material>::Ptr>
+ReactorFleet::GetMatlRequests() {
+  CYCAMORE_PERF_SCOPE("GetMatlRequests");
+  using cyclus::RequestPortfolio;
+
+  std::set<RequestPortfolio<Material>::Ptr> ports;
+  if (retired()) {
+    return ports;
+  }
+  SyncCoreCounts();
+
+  int t = context()->time();
+  int n_assem_order = n_assem_fresh - fresh.count();
+  int n_need = 0;
+  for (int u = 0; u < n_units; u++) {
+    if (!online(u)) {
+      continue;
+    }
+    int n_missing = n_assem_core - core_counts_[u];
+    n_assem_order += n_missing;
+    if (exit_time() != -1) {
+      // reduces each unit's order to the amount needed until retirement, as
+      // for the Reactor
+      int t_left = exit_time() - t + 1;
+      int t_left_cycle = cycle_time + refuel_time - cycle_steps[u];
+      double n_cycles_left = static_cast<double>(t_left - t_left_cycle) /
+                             static_cast<double>(cycle_time + refuel_time);
+      n_cycles_left = ceil(n_cycles_left);
+      n_need += std::max(0.0, n_cycles_left * n_assem_batch + n_missing);
+    }
+  }
+  if (exit_time() != -1) {
+    n_assem_order = std::min(n_assem_order,
+                             std::max(0, n_need - n_assem_fresh));
+  }
+  if (n_assem_order <= 0) {
+    return ports;
+  }
+
+  std::vector<double>::iterator result;
+  result = std::max_element(fuel_prefs.begin(), fuel_prefs.end());
+  int max_index = std::distance(fuel_prefs.begin(), result);
+
+  record_policy_.Defer("demand"+fuel_incommods[max_index],
+                       assem_size * n_assem_order);
+
+  // one all-or-nothing portfolio per batch, the last one for the remaining
+  // assemblies. The request targets only depend on the portfolio size, so
+  // they are shared.
+  std::map<int, MatVec> targets;
+  for (int n_left = n_assem_order; n_left > 0; n_left -= n_assem_batch) {
+    int n = std::min(n_left, n_assem_batch);
+    MatVec& mats = targets[n];
+    if (mats.empty()) {
+      for (int j = 0; j < fuel_incommods.size(); j++) {
+        Composition::Ptr recipe = context()->GetRecipe(fuel_inrecipes[j]);
+        mats.push_back(pool_.Get(t, n * assem_size, recipe));
+      }
+    }
+
+    RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
+    std::vector<Request<Material>*> mreqs;
+    for (int j = 0; j < fuel_incommods.size(); j++) {
+      Request<Material>* r = port->AddRequest(mats[j], this,
+                                              fuel_incommods[j], fuel_prefs[j],
+                                              true);
+      mreqs.push_back(r);
+    }
+    port->AddMutualReqs(mreqs);
+    ports.insert(port);
+  }
+
+  return ports;
+}
+
+void ReactorFleet::AcceptMatlTrades(const std::vector<
+    std::pair<cyclus::Trade<Material>, Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("AcceptMatlTrades");
+  std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                        cyclus::Material::Ptr> >::const_iterator trade;
+
+  // split batch deliveries into individual assemblies
+  MatVec assems;
+  for (trade = responses.begin(); trade != responses.end(); ++trade) {
+    std::string commod = trade->first.request->commodity();
+    Material::Ptr m = trade->second;
+    while (m->quantity() - assem_size > cyclus::eps_rsrc()) {
+      Material::Ptr assem = m->ExtractQty(assem_size);
+      index_res(assem, commod);
+      assems.push_back(assem);
+    }
+    index_res(m, commod);
+    assems.push_back(m);
+  }
+
+  // cores of the online units are filled in unit order, the rest is kept as
+  // fresh fuel
+  SyncCoreCounts();
+  int u = 0;
+  int nload = 0;
+  for (int i = 0; i < assems.size(); i++) {
+    while (u < n_units && (!online(u) || core_full(u))) {
+      if (nload > 0) {
+        std::stringstream ss;
+        ss << nload << " assemblies";
+        Record(u, "LOAD", ss.str());
+        nload = 0;
+      }
+      u++;
+    }
+    if (u < n_units) {
+      PushCore(u, assems[i]);
+      nload++;
+    } else {
+      fresh.Push(assems[i]);
+    }
+  }
+  if (nload > 0) {
+    std::stringstream ss;
+    ss << nload << " assemblies";
+    Record(u, "LOAD", ss.str());
+  }
+}
+
+std::set<cyclus::BidPortfolio<Material>::Ptr> ReactorFleet::GetMatlBids(
+    cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_PERF_SCOPE("GetMatlBids");
+  using cyclus::BidPortfolio;
+  std::set<BidPortfolio<Material>::Ptr> ports;
+
+  bid_groups_.clear();
+  if (spent.count() == 0) {
+    return ports;
+  }
+
+  SyncSpentGroups();
+  std::map<std::string, SpentGroups>::iterator it;
+  for (it = spent_groups_.begin(); it != spent_groups_.end(); ++it) {
+    const std::string& commod = it->first;
+    SpentGroups& g = it->second;
+    if (commod_requests.count(commod) == 0) {
+      continue;
+    }
+    std::vector<Request<Material>*>& reqs = commod_requests[commod];
+    if (reqs.size() == 0) {
+      continue;
+    }
+
+    BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
+    g.AddBids(port, reqs, this, &bid_groups_);
+    cyclus::CapacityConstraint<Material> cc(g.qty());
+    port->AddConstraint(cc);
+    ports.insert(port);
+  }
+
+  return ports;
+}
+
+void ReactorFleet::SyncSpentGroups() {
+  unsigned long version = spent_view_.version();
+  if (version == spent_groups_version_) {
+    return;
+  }
+  spent_groups_.clear();
+  spent_groups_version_ = version;
+
+  const std::deque<Material::Ptr>& mats = spent_view_.contents();
+  for (int k = 0; k < mats.size(); k++) {
+    spent_groups_[fuel_outcommods[fuel_index(mats[k])]].Add(mats[k], 1);
+  }
+}
+
+void ReactorFleet::GetMatlTrades(
+    const std::vector<cyclus::Trade<Material> >& trades,
+    std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
+        responses) {
+  CYCAMORE_PERF_SCOPE("GetMatlTrades");
+
+  // each trade is filled with the oldest assemblies of the offered
+  // composition, combined into a single material
+  std::set<int> traded;
+  const std::deque<Material::Ptr>& mats = spent_view_.contents();
+  for (int i = 0; i < trades.size(); i++) {
+    const std::string& commod = trades[i].request->commodity();
+    Material::Ptr offer = trades[i].bid->offer();
+    int n = bid_groups_[offer.get()];
+    int comp_id = offer->comp()->id();
+
+    Material::Ptr m;
+    for (int k = 0; k < mats.size() && n > 0; k++) {
+      Material::Ptr assem = mats[k];
+      if (traded.count(assem->obj_id()) > 0 ||
+          assem->comp()->id() != comp_id ||
+          fuel_outcommods[fuel_index(assem)] != commod) {
+        continue;
+      }
+      traded.insert(assem->obj_id());
+      if (m.get() == NULL) {
+        m = assem;
+      } else {
+        m->Absorb(assem);
+      }
+      n--;
+    }
+    if (m.get() == NULL ||
+        m->quantity() < trades[i].amt - cyclus::eps_rsrc()) {
+      throw ValueError("cycamore::ReactorFleet - no spent fuel left to trade "
+                       "on " + commod);
+    }
+    responses.push_back(std::make_pair(trades[i], m));
+  }
+  if (traded.empty()) {
+    return;
+  }
+
+  MatVec all = spent_view_.PopN(spent.count());
+  MatVec keep;
+  for (int i = 0; i < all.size(); i++) {
+    if (traded.count(all[i]->obj_id()) == 0) {
+      keep.push_back(all[i]);
+    } else {
+      res_indexes.erase(all[i]->obj_id());
+    }
+  }
+  spent_view_.Push(keep);
+}
+
+void ReactorFleet::Tock() {
+  CYCAMORE_PERF_SCOPE("Tock");
+  if (memory_.Due(context()->time())) {
+    memory_.Add("fresh", fresh);
+    memory_.Add("core", core);
+    memory_.Add("spent", spent);
+    memory_.Add("res_indexes", res_indexes);
+    memory_.Add("core_units", core_units);
+    memory_.Flush(this);
+  }
+
+  if (retired()) {
+    FlushRecords();
+    return;
+  }
+  SyncCoreCounts();
+
+  int n_operating = 0;
+  for (int u = 0; u < n_units; u++) {
+    if (!online(u)) {
+      continue;
+    }
+    int& cycle_step = cycle_steps[u];
+    // a new cycle starts once the irradiation and refueling periods are over,
+    // the core is full and fuel was discharged in this refueling time.
+    if (cycle_step >= cycle_time + refuel_time && core_full(u) &&
+        discharged[u]) {
+      discharged[u] = 0;
+      cycle_step = 0;
+    }
+    if (cycle_step == 0 && core_full(u)) {
+      Record(u, "CYCLE_START", "");
+    }
+    if (cycle_step >= 0 && cycle_step < cycle_time && core_full(u)) {
+      n_operating++;
+    }
+    // prevents starting the first cycle until the core is full
+    if (cycle_step > 0 || core_full(u)) {
+      cycle_step++;
+    }
+  }
+
+  record_policy_.TimeSeries<cyclus::toolkit::POWER>(this,
+                                                    n_operating * power_cap);
+  record_policy_.TimeSeries("supplyPOWER", this, n_operating * power_cap);
+  FlushRecords();
+}
+
+void ReactorFleet::SyncCoreCounts() {
+  if (core_counts_.size() == n_units) {
+    return;
+  }
+  core_counts_.assign(n_units, 0);
+  const std::deque<Material::Ptr>& mats = core_view_.contents();
+  for (int i = 0; i < mats.size(); i++) {
+    std::map<int, int>::iterator it = core_units.find(mats[i]->obj_id());
+    if (it == core_units.end() || it->second >= n_units) {
+      throw KeyError("cycamore::ReactorFleet - no unit for core assembly");
+    }
+    core_counts_[it->second]++;
+  }
+}
+
+void ReactorFleet::PushCore(int unit, Material::Ptr m) {
+  core_view_.Push(m);
+  core_units[m->obj_id()] = unit;
+  core_counts_[unit]++;
+}
+
+MatVec ReactorFleet::UnitCore(int unit, int n, bool pop) {
+  MatVec mats;
+  if (!pop) {
+    const std::deque<Material::Ptr>& all = core_view_.contents();
+    for (int i = 0; i < all.size() && mats.size() < n; i++) {
+      if (core_units[all[i]->obj_id()] == unit) {
+        mats.push_back(all[i]);
+      }
+    }
+    return mats;
+  }
+
+  // the oldest assemblies of the unit are taken, preserving the order of the
+  // remaining ones
+  MatVec all = core_view_.PopN(core.count());
+  MatVec keep;
+  for (int i = 0; i < all.size(); i++) {
+    if (mats.size() < n && core_units[all[i]->obj_id()] == unit) {
+      core_units.erase(all[i]->obj_id());
+      mats.push_back(all[i]);
+    } else {
+      keep.push_back(all[i]);
+    }
+  }
+  core_view_.Push(keep);
+  core_counts_[unit] -= mats.size();
+  return mats;
+}
+
+void ReactorFleet::Transmute(int unit, int n_assem) {
+  MatVec old = UnitCore(unit, n_assem, false);
+  if (old.empty()) {
+    return;
+  }
+
+  std::stringstream ss;
+  ss << old.size() << " assemblies";
+  Record(unit, "TRANSMUTE", ss.str());
+
+  for (int i = 0; i < old.size(); i++) {
+    int j = fuel_index(old[i]);
+    old[i]->Transmute(context()->GetRecipe(fuel_outrecipes[j]));
+  }
+}
+
+bool ReactorFleet::Discharge(int unit) {
+  int npop = std::min(n_assem_batch, core_counts_[unit]);
+  if (n_assem_spent - spent.count() < npop) {
+    Record(unit, "DISCHARGE", "failed");
+    return false;  // not enough room in spent buffer
+  }
+
+  std::stringstream ss;
+  ss << npop << " assemblies";
+  Record(unit, "DISCHARGE", ss.str());
+  spent_view_.Push(UnitCore(unit, npop, true));
+  return true;
+}
+
+void ReactorFleet::Load(int unit) {
+  int n = std::min(n_assem_core - core_counts_[unit], fresh.count());
+  if (n <= 0) {
+    return;
+  }
+
+  std::stringstream ss;
+  ss << n << " assemblies";
+  Record(unit, "LOAD", ss.str());
+  for (int i = 0; i < n; i++) {
+    PushCore(unit, fresh.Pop());
+  }
+}
+
+void ReactorFleet::RecordSupply() {
+  std::map<std::string, double> qtys;
+  const std::deque<Material::Ptr>& mats = spent_view_.contents();
+  for (int i = 0; i < mats.size(); i++) {
+    qtys[fuel_outcommods[fuel_index(mats[i])]] += mats[i]->quantity();
+  }
+  for (int i = 0; i < fuel_outcommods.size(); i++) {
+    record_policy_.TimeSeries("supply"+fuel_outcommods[i], this,
+                              qtys[fuel_outcommods[i]]);
+  }
+}
+
+int ReactorFleet::fuel_index(Material::Ptr m) {
+  std::map<int, int>::iterator it = res_indexes.find(m->obj_id());
+  if (it == res_indexes.end() || it->second >= fuel_outcommods.size()) {
+    throw KeyError("cycamore::ReactorFleet - no fuel info for material "
+                   "object");
+  }
+  return it->second;
+}
+
+void ReactorFleet::index_res(cyclus::Resource::Ptr m, std::string incommod) {
+  for (int i = 0; i < fuel_incommods.size(); i++) {
+    if (fuel_incommods[i] == incommod) {
+      res_indexes[m->obj_id()] = i;
+      return;
+    }
+  }
+  throw ValueError(
+      "cycamore::ReactorFleet - received unsupported incommod material");
+}
+
+void ReactorFleet::Record(int unit, std::string name, std::string val) {
+  if (!record_policy_.RecordsEvents(context()->time())) {
+    return;
+  }
+  if (unit < 0 || record_unit_events) {
+    std::stringstream ss;
+    if (unit >= 0) {
+      ss << "unit " << unit << (val.empty() ? "" : ": ");
+    }
+    ss << val;
+    events_.Add(id(), context()->time(), name, ss.str());
+    return;
+  }
+
+  std::pair<std::string, std::string> ev(name, val);
+  for (int i = 0; i < unit_event_counts_.size(); i++) {
+    if (unit_event_counts_[i].first == ev) {
+      unit_event_counts_[i].second++;
+      return;
+    }
+  }
+  unit_event_counts_.push_back(std::make_pair(ev, 1));
+}
+
+extern "C" cyclus::Agent* ConstructReactorFleet(cyclus::Context* ctx) {
+  return new ReactorFleet(ctx);
+}
+
+}  // namespace cycamore
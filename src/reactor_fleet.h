@@ -0,0 +1,390 @@
+#ifndef CYCAMORE_SRC_REACTOR_FLEET_H_
+#define CYCAMORE_SRC_REACTOR_FLEET_H_
+
+#include "cyclus.h"
+#include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "res_buf_view.h"
+#include "spent_groups.h"
+#include "untracked_pool.h"
+
+namespace cycamore {
+
+/// ReactorFleet models a cohort of n_units identical reactors in a single
+/// agent.  Each unit follows the Reactor's cycle logic - it runs for
+/// cycle_time time steps, discharges a batch of n_assem_batch assemblies,
+/// refuels for refuel_time time steps and restarts once its core is full
+/// again - with its own cycle step.  Units can be brought online staggered by
+/// unit_delays.
+///
+/// The units share the fleet's fresh and spent fuel inventories, whose
+/// capacities n_assem_fresh and n_assem_spent are for the whole fleet, and
+/// the fleet trades for all of its units at once: fresh fuel is requested in
+/// batch sized, all-or-nothing orders and spent fuel is offered with one bid
+/// per request and spent fuel composition.  The fleet's power is the sum of
+/// its operating units' power.  Reactor events are recorded per unit if
+/// record_unit_events is set and otherwise as one row per event and time step
+/// with the number of units concerned.
+///
+/// Compared to deploying n_units Reactor prototypes this keeps the number of
+/// agents, exchange requests and bids, and output rows small for large
+/// homogeneous fleets.  Recipe and preference changes and side products are
+/// not supported and all units retire with the fleet.
+class ReactorFleet : public cyclus::Facility,
+  public cyclus::toolkit::CommodityProducer {
+#pragma cyclus note { \
+"niche": "reactor", \
+"doc": \
+  "ReactorFleet models a cohort of n_units identical reactors in a single" \
+  " agent.  Each unit follows the Reactor's cycle logic - it runs for" \
+  " cycle_time time steps, discharges a batch of n_assem_batch assemblies," \
+  " refuels for refuel_time time steps and restarts once its core is full" \
+  " again - with its own cycle step.  Units can be brought online staggered" \
+  " by unit_delays." \
+  "\n\n" \
+  "The units share the fleet's fresh and spent fuel inventories, whose" \
+  " capacities n_assem_fresh and n_assem_spent are for the whole fleet, and" \
+  " the fleet trades for all of its units at once: fresh fuel is requested in" \
+  " batch sized, all-or-nothing orders and spent fuel is offered with one bid" \
+  " per request and spent fuel composition.  The fleet's power is the sum of" \
+  " its operating units' power.  Reactor events are recorded per unit if" \
+  " record_unit_events is set and otherwise as one row per event and time" \
+  " step with the number of units concerned." \
+  "\n\n" \
+  "Recipe and preference changes and side products are not supported and all" \
+  " units retire with the fleet." \
+  "", \
+}
+
+ public:
+  ReactorFleet(cyclus::Context* ctx);
+  virtual ~ReactorFleet(){};
+
+  virtual std::string version() { return CYCAMORE_VERSION; }
+
+  virtual void Tick();
+  virtual void Tock();
+  virtual void EnterNotify();
+  virtual bool CheckDecommissionCondition();
+  virtual void Decommission();
+
+  virtual void AcceptMatlTrades(const std::vector<std::pair<
+      cyclus::Trade<cyclus::Material>, cyclus::Material::Ptr> >& responses);
+
+  virtual std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
+  GetMatlRequests();
+
+  virtual std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> GetMatlBids(
+      cyclus::CommodMap<cyclus::Material>::type& commod_requests);
+
+  virtual void GetMatlTrades(
+      const std::vector<cyclus::Trade<cyclus::Material> >& trades,
+      std::vector<std::pair<cyclus::Trade<cyclus::Material>,
+                            cyclus::Material::Ptr> >& responses);
+
+  #pragma cyclus decl
+
+ private:
+  bool retired() {
+    return exit_time() != -1 && context()->time() > exit_time();
+  }
+
+  /// Returns whether the given unit has been brought online.
+  bool online(int unit) {
+    return context()->time() >= enter_time() + unit_delays[unit];
+  }
+
+  /// Returns whether the core of the given unit is full.
+  bool core_full(int unit) { return core_counts_[unit] == n_assem_core; }
+
+  /// Store fuel info index for the given resource received on incommod.
+  void index_res(cyclus::Resource::Ptr m, std::string incommod);
+
+  /// Returns the fuel index of the given assembly.
+  int fuel_index(cyclus::Material::Ptr m);
+
+  /// Rebuilds the per-unit core assembly counts from the core buffer if they
+  /// are not yet in step with it (e.g. on first use after a restart).
+  void SyncCoreCounts();
+
+  /// Adds the given assembly to the core of the given unit.
+  void PushCore(int unit, cyclus::Material::Ptr m);
+
+  /// Returns the (up to) n oldest assemblies in the core of the given unit.
+  /// If pop is true, they are also removed from the core.
+  cyclus::toolkit::MatVec UnitCore(int unit, int n, bool pop);
+
+  /// Discharge a batch from the core of the given unit if there is room in
+  /// the spent fuel inventory.  Returns true if a batch was discharged.
+  bool Discharge(int unit);
+
+  /// Top up the core of the given unit from the fresh fuel inventory as much
+  /// as possible.
+  void Load(int unit);
+
+  /// Transmute the (up to) n_assem oldest assemblies in the core of the given
+  /// unit to their fully burnt state as defined by their outrecipe.
+  void Transmute(int unit, int n_assem);
+
+  /// Regroups the spent fuel of every outcommod by composition if the spent
+  /// fuel buffer changed since the groups were last built.
+  void SyncSpentGroups();
+
+  /// Records the total spent fuel held for each fuel outcommod.
+  void RecordSupply();
+
+  /// Records a reactor event of the given unit (or of the whole fleet if
+  /// unit is negative) with the given name and note val.
+  void Record(int unit, std::string name, std::string val);
+
+  /////// fuel specifications /////////
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "incommodity"], \
+    "uilabel": "Fresh Fuel Commodity List", \
+    "doc": "Ordered list of input commodities on which to requesting fuel.", \
+  }
+  std::vector<std::string> fuel_incommods;
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "inrecipe"], \
+    "uilabel": "Fresh Fuel Recipe List", \
+    "doc": "Fresh fuel recipes to request for each of the given fuel input " \
+           "commodities (same order).", \
+  }
+  std::vector<std::string> fuel_inrecipes;
+  #pragma cyclus var { \
+    "default": [], \
+    "uilabel": "Fresh Fuel Preference List", \
+    "doc": "The preference for each type of fresh fuel requested corresponding"\
+           " to each input commodity (same order).  If no preferences are " \
+           "specified, 1.0 is used for all fuel " \
+           "requests (default).", \
+  }
+  std::vector<double> fuel_prefs;
+  #pragma cyclus var { \
+    "uitype": ["oneormore", "outcommodity"], \
+    "uilabel": "Spent Fuel Commodity List", \
+    "doc": "Output commodities on which to offer spent fuel originally " \
+           "received as each particular input commodity (same order)." \
+  }
+  std::vector<std::string> fuel_outcommods;
+  #pragma cyclus var {           \
+    "uitype": ["oneormore", "outrecipe"], \
+    "uilabel": "Spent Fuel Recipe List", \
+    "doc": "Spent fuel recipes corresponding to the given fuel input " \
+           "commodities (same order)." \
+           " Fuel received via a particular input commodity is transmuted to " \
+           "the recipe specified here after being burned during a cycle.", \
+  }
+  std::vector<std::string> fuel_outrecipes;
+
+  //////////// fleet params ////////////
+  #pragma cyclus var { \
+    "default": 1, \
+    "uilabel": "Number of Units", \
+    "doc": "Number of identical reactor units in the fleet.", \
+  }
+  int n_units;
+  #pragma cyclus var { \
+    "default": [], \
+    "uilabel": "Unit Start Delays", \
+    "units": "time steps", \
+    "doc": "Number of time steps after the fleet is deployed at which each " \
+           "unit is brought online (one value per unit).  If no delays are " \
+           "specified, all units are brought online with the fleet.", \
+  }
+  std::vector<int> unit_delays;
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Record Events per Unit", \
+    "doc": "If true, reactor events are recorded for each unit, with the " \
+           "unit number in the event value.  If false (the default), one " \
+           "row per event and time step is recorded with the number of " \
+           "units concerned.", \
+  }
+  bool record_unit_events;
+
+  //////////// inventory and core params ////////////
+  #pragma cyclus var { \
+    "doc": "Mass (kg) of a single assembly.", \
+    "uilabel": "Assembly Mass", \
+    "uitype": "range", \
+    "range": [1.0, 1e5], \
+    "units": "kg", \
+  }
+  double assem_size;
+  #pragma cyclus var { \
+    "uilabel": "Number of Assemblies per Batch", \
+    "doc": "Number of assemblies that constitute a single batch of a unit.  " \
+           "This is the number of assemblies discharged from a unit's core " \
+           "fully burned each cycle and the size of each fresh fuel order.", \
+  }
+  int n_assem_batch;
+  #pragma cyclus var { \
+    "default": 3, \
+    "uilabel": "Number of Assemblies in Core", \
+    "doc": "Number of assemblies that constitute the full core of a unit.", \
+  }
+  int n_assem_core;
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Minimum Fresh Fuel Inventory", \
+    "units": "assemblies", \
+    "doc": "Number of fresh fuel assemblies to keep on-hand for the whole " \
+           "fleet if possible.", \
+  }
+  int n_assem_fresh;
+  #pragma cyclus var { \
+    "default": 1000000000, \
+    "uilabel": "Maximum Spent Fuel Inventory", \
+    "uitype": "range", \
+    "range": [0, 1000000000], \
+    "units": "assemblies", \
+    "doc": "Number of spent fuel assemblies that can be stored on-site for " \
+           "the whole fleet before unit operation stalls.", \
+  }
+  int n_assem_spent;
+
+  ///////// cycle params ///////////
+  #pragma cyclus var { \
+    "default": 18, \
+    "doc": "The duration of a full operational cycle (excluding refueling " \
+           "time) in time steps.", \
+    "uilabel": "Cycle Length", \
+    "units": "time steps", \
+  }
+  int cycle_time;
+  #pragma cyclus var { \
+    "default": 1, \
+    "doc": "The duration of a full refueling period - the minimum time between"\
+           " the end of a cycle and the start of the next cycle.", \
+    "uilabel": "Refueling Outage Duration", \
+    "units": "time steps", \
+  }
+  int refuel_time;
+  #pragma cyclus var { \
+    "default": [], \
+    "doc": "Number of time steps since the start of the last cycle of each " \
+           "unit. Only set this if you know what you are doing", \
+    "uilabel": "Time Since Start of Last Cycle per Unit", \
+    "units": "time steps", \
+  }
+  std::vector<int> cycle_steps;
+
+  //////////// power params ////////////
+  #pragma cyclus var { \
+    "default": 0, \
+    "doc": "Amount of electrical power each unit produces when operating " \
+           "normally.", \
+    "uilabel": "Nominal Unit Power", \
+    "uitype": "range", \
+    "range": [0.0, 2000.00],  \
+    "units": "MWe", \
+  }
+  double power_cap;
+  #pragma cyclus var { \
+    "default": "power", \
+    "uilabel": "Power Commodity Name", \
+    "doc": "The name of the 'power' commodity used in conjunction with a " \
+           "deployment curve.", \
+  }
+  std::string power_name;
+
+  /////////// Decommission transmutation behavior ///////////
+  #pragma cyclus var {"default": 0, \
+                      "uilabel": "Boolean for transmutation behavior upon decommissioning.", \
+                      "doc": "If true, the archetype transmutes all assemblies upon decommissioning " \
+                             "If false, the archetype only transmutes half.", \
+  }
+  bool decom_transmute_all;
+
+  // Resource inventories - these must be defined AFTER/BELOW the member vars
+  // referenced (e.g. n_units, assem_size, etc.).
+  #pragma cyclus var {"capacity": "n_assem_fresh * assem_size"}
+  cyclus::toolkit::ResBuf<cyclus::Material> fresh;
+  #pragma cyclus var {"capacity": "n_units * n_assem_core * assem_size"}
+  cyclus::toolkit::ResBuf<cyclus::Material> core;
+  #pragma cyclus var {"capacity": "n_assem_spent * assem_size"}
+  cyclus::toolkit::ResBuf<cyclus::Material> spent;
+
+  // should be hidden in ui (internal only). Non-zero for each unit that has
+  // already discharged fuel this cycle.
+  #pragma cyclus var {"default": [], "doc": "This should NEVER be set manually",\
+                      "internal": True \
+  }
+  std::vector<int> discharged;
+
+  // This variable should be hidden/unavailable in ui.  Maps resource object
+  // id's to the index for the incommod through which they were received.
+  #pragma cyclus var {"default": {}, "doc": "This should NEVER be set manually", \
+                      "internal": True \
+  }
+  std::map<int, int> res_indexes;
+
+  // This variable should be hidden/unavailable in ui.  Maps the object id's
+  // of the core assemblies to the unit they are loaded in.
+  #pragma cyclus var {"default": {}, "doc": "This should NEVER be set manually", \
+                      "internal": True \
+  }
+  std::map<int, int> core_units;
+
+  // number of assemblies in each unit's core. Rebuilt from core_units on
+  // first use, so there is no need to persist.
+  std::vector<int> core_counts_;
+
+  // read-only access to the core and spent buffers without pop/push round
+  // trips - all pushes and pops of those buffers go through these
+  ResBufView<cyclus::Material> core_view_;
+  ResBufView<cyclus::Material> spent_view_;
+
+  // offer of each spent fuel bid -> number of assemblies it stands for. Only
+  // used within a single exchange.
+  std::map<cyclus::Material*, int> bid_groups_;
+
+  // spent fuel groups of each outcommod, reused for the bids of every time
+  // step until the spent buffer's version moves on from
+  // spent_groups_version_. Rebuilt on first use, so there is no need to
+  // persist.
+  std::map<std::string, SpentGroups> spent_groups_;
+  unsigned long spent_groups_version_;
+
+  // number of units for each event (name and value) of the current time step
+  // if events are not recorded per unit, in order of first occurrence
+  std::vector<std::pair<std::pair<std::string, std::string>, int> >
+      unit_event_counts_;
+
+  // ReactorEvents rows of the current time step, flushed at the end of the
+  // Tock and on decommissioning.
+  RecordBuffer<int, int, std::string, std::string> events_;
+  void FlushRecords();
+
+  #include "record_policy.cycpp.h"
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
+
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
+  /// request targets shared between requests and time steps
+  UntrackedPool pool_;
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_REACTOR_FLEET_H_
@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "cyclus.h"
+
+using pyne::nucname::id;
+using cyclus::Composition;
+using cyclus::Material;
+using cyclus::QueryResult;
+using cyclus::Cond;
+
+namespace cycamore {
+namespace reactorfleettests {
+
+Composition::Ptr c_uox() {
+  cyclus::CompMap m;
+  m[id("u235")] = 0.04;
+  m[id("u238")] = 0.96;
+  return Composition::CreateFromMass(m);
+};
+
+Composition::Ptr c_mox() {
+  cyclus::CompMap m;
+  m[id("u235")] = .7;
+  m[id("u238")] = 100;
+  m[id("pu239")] = 3.3;
+  return Composition::CreateFromMass(m);
+};
+
+Composition::Ptr c_spentuox() {
+  cyclus::CompMap m;
+  m[id("u235")] =  .8;
+  m[id("u238")] =  100;
+  m[id("pu239")] = 1;
+  return Composition::CreateFromMass(m);
+};
+
+Composition::Ptr c_spentmox() {
+  cyclus::CompMap m;
+  m[id("u235")] =  .2;
+  m[id("u238")] =  100;
+  m[id("pu239")] = .9;
+  return Composition::CreateFromMass(m);
+};
+
+// returns the total quantity of the materials in the transactions matching
+// conds
+double TradedQty(cyclus::MockSim& sim, std::vector<Cond>* conds) {
+  QueryResult qr = sim.db().Query("Transactions", conds);
+  double qty = 0;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    qty += sim.GetMaterial(qr.GetVal<int>("ResourceId", i))->quantity();
+  }
+  return qty;
+}
+
+// tests that units come online after their delays and that the fleet's power
+// is the sum of its operating units' power.
+TEST(ReactorFleetTests, StaggeredUnits) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <n_units>2</n_units>  "
+     "  <unit_delays> <val>0</val> <val>3</val> </unit_delays>  "
+     "  <cycle_time>10</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>100</power_cap>  ";
+
+  int simdur = 6;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:ReactorFleet"), config,
+                      simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  QueryResult qr = sim.db().Query("TimeSeriesPower", &conds);
+  ASSERT_EQ(simdur, qr.rows.size());
+  for (int t = 0; t < simdur; t++) {
+    EXPECT_DOUBLE_EQ(t < 3 ? 100 : 200, qr.GetVal<double>("Value", t))
+        << "wrong fleet power on time step " << t;
+  }
+}
+
+// tests that fresh fuel is ordered in batch sized trades and that events are
+// recorded once for all units.
+TEST(ReactorFleetTests, BatchOrders) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <n_units>3</n_units>  "
+     "  <cycle_time>2</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>10</assem_size>  "
+     "  <n_assem_core>4</n_assem_core>  "
+     "  <n_assem_batch>2</n_assem_batch>  "
+     "  <power_cap>1000</power_cap>  ";
+
+  int simdur = 1;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:ReactorFleet"), config,
+                      simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  QueryResult qr = sim.db().Query("Transactions", NULL);
+  ASSERT_EQ(6, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(20, m->quantity());
+  }
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  qr = sim.db().Query("TimeSeriesPower", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_DOUBLE_EQ(3000, qr.GetVal<double>("Value", 0));
+
+  conds.push_back(Cond("Event", "==", std::string("LOAD")));
+  qr = sim.db().Query("ReactorEvents", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ("3 units, 4 assemblies", qr.GetVal<std::string>("Value", 0));
+}
+
+// tests that with record_unit_events each unit's events are recorded.
+TEST(ReactorFleetTests, UnitEvents) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <n_units>2</n_units>  "
+     "  <record_unit_events>1</record_unit_events>  "
+     "  <cycle_time>2</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  ";
+
+  int simdur = 1;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:ReactorFleet"), config,
+                      simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  conds.push_back(Cond("Event", "==", std::string("CYCLE_START")));
+  QueryResult qr = sim.db().Query("ReactorEvents", &conds);
+  ASSERT_EQ(2, qr.rows.size());
+  EXPECT_EQ("unit 0", qr.GetVal<std::string>("Value", 0));
+  EXPECT_EQ("unit 1", qr.GetVal<std::string>("Value", 1));
+}
+
+// tests that the fleet cycles its units and trades away all of its fuel by
+// retirement.
+TEST(ReactorFleetTests, Retire) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <n_units>2</n_units>  "
+     "  <unit_delays> <val>0</val> <val>1</val> </unit_delays>  "
+     "  <cycle_time>3</cycle_time>  "
+     "  <refuel_time>1</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>2</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>1</power_cap>  ";
+
+  int dur = 20;
+  int life = 10;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:ReactorFleet"), config,
+                      dur, life);
+  sim.AddSource("uox").Finalize();
+  sim.AddSink("waste").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("ReceiverId", "==", id));
+  double received = TradedQty(sim, &conds);
+  // a core per unit and one batch per unit and completed cycle
+  EXPECT_LT(4, received);
+
+  conds.clear();
+  conds.push_back(Cond("SenderId", "==", id));
+  EXPECT_DOUBLE_EQ(received, TradedQty(sim, &conds))
+      << "failed to discharge all material by retirement time";
+
+  conds.clear();
+  conds.push_back(Cond("AgentId", "==", id));
+  conds.push_back(Cond("Event", "==", std::string("CYCLE_END")));
+  QueryResult qr = sim.db().Query("ReactorEvents", &conds);
+  EXPECT_LT(0, qr.rows.size());
+}
+
+// tests that several requests are not matched with more spent assemblies of
+// one composition than the fleet holds.
+TEST(ReactorFleetTests, SpentBidsPerComposition) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      <val>mox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> <val>spentmox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      <val>mox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <n_units>1</n_units>  "
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  ";
+
+  int simdur = 4;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:ReactorFleet"), config,
+                      simdur);
+  sim.AddSource("uox").capacity(1).lifetime(1).Finalize();
+  sim.AddSource("mox").capacity(2).lifetime(1).Finalize();
+  sim.AddSink("waste").capacity(1).Finalize();
+  sim.AddSink("waste").capacity(1).Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  sim.AddRecipe("mox", c_mox());
+  sim.AddRecipe("spentmox", c_spentmox());
+  int id = sim.Run();
+
+  // one spent uox and two spent mox assemblies, two requests for one
+  // assembly each per time step
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", id));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(3, qr.rows.size());
+  std::map<int, int> per_time;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(1, m->quantity());
+    per_time[qr.GetVal<int>("Time", i)]++;
+  }
+  EXPECT_EQ(2, per_time.begin()->second);
+}
+
+}  // namespace reactorfleettests
+}  // namespace cycamore
@@ -80,6 +80,50 @@ TEST(ReactorTests, JustInTimeOrdering) {
   EXPECT_EQ(simdur, qr.rows.size()) << "failed to order+run on fresh fuel inside 1 time step";
 }
 
+// tests that with bulk ordering a full core is received in a single trade and
+// split into assemblies, and that demand is only recorded once per order.
+TEST(ReactorTests, BulkOrder) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>2</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>10</assem_size>  "
+     "  <n_assem_core>5</n_assem_core>  "
+     "  <n_assem_batch>5</n_assem_batch>  "
+     "  <power_cap>1000</power_cap>  "
+     "  <bulk_order>1</bulk_order>  ";
+
+  int simdur = 1;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  QueryResult qr = sim.db().Query("Transactions", NULL);
+  EXPECT_EQ(1, qr.rows.size());
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  qr = sim.db().Query("TimeSeriesdemanduox", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_DOUBLE_EQ(50, qr.GetVal<double>("Value", 0));
+
+  // the core is full, so the reactor runs on the first time step
+  qr = sim.db().Query("TimeSeriesPower", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_DOUBLE_EQ(1000, qr.GetVal<double>("Value", 0));
+
+  conds.push_back(Cond("Event", "==", std::string("LOAD")));
+  qr = sim.db().Query("ReactorEvents", &conds);
+  ASSERT_EQ(1, qr.rows.size());
+  EXPECT_EQ("5 assemblies", qr.GetVal<std::string>("Value", 0));
+}
+
 // tests that the correct number of assemblies are popped from the core each
 // cycle.
 TEST(ReactorTests, BatchSizes) {
@@ -136,6 +180,86 @@ TEST(ReactorTests, RefuelTimes) {
   EXPECT_EQ(n_assem_want, qr.rows.size());
 }
 
+// tests that in the "runs" recording mode power is only recorded when it
+// changes, i.e. at the start of each cycle and refueling period.
+TEST(ReactorTests, PowerRuns) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>4</cycle_time>  "
+     "  <refuel_time>2</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>1</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <power_cap>1000</power_cap>  "
+     "  <record_mode>runs</record_mode>  ";
+
+  int simdur = 12;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  QueryResult qr = sim.db().Query("TimeSeriesPower", &conds);
+  int times[] = {0, 4, 6, 10};
+  double power[] = {1000, 0, 1000, 0};
+  ASSERT_EQ(4, qr.rows.size());
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(times[i], qr.GetVal<int>("Time", i));
+    EXPECT_DOUBLE_EQ(power[i], qr.GetVal<double>("Value", i));
+  }
+
+  // events are not affected
+  conds.push_back(Cond("Event", "==", std::string("CYCLE_START")));
+  qr = sim.db().Query("ReactorEvents", &conds);
+  EXPECT_EQ(2, qr.rows.size());
+}
+
+
+// tests that in the "mean" recording mode a demand not given on the last
+// time step of an interval is not averaged into the next interval.  Fuel is
+// only ordered on the time steps a batch is discharged (0, 3, 6, 9), and the
+// interval ending on time step 7 has no order on it.
+TEST(ReactorTests, DemandMeanSkippedSample) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>3</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>10</assem_size>  "
+     "  <n_assem_core>2</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <record_mode>mean</record_mode>  "
+     "  <record_interval>2</record_interval>  ";
+
+  int simdur = 10;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  // the initial order of a full core on time step 0 is not on a sampled
+  // time step and must not be part of the mean recorded on time step 3
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  QueryResult qr = sim.db().Query("TimeSeriesdemanduox", &conds);
+  int times[] = {3, 9};
+  ASSERT_EQ(2, qr.rows.size());
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(times[i], qr.GetVal<int>("Time", i));
+    EXPECT_DOUBLE_EQ(10, qr.GetVal<double>("Value", i));
+  }
+}
 
 // tests that a reactor decommissions on time without producing
 // power at the end of its lifetime.
@@ -457,6 +581,291 @@ TEST(ReactorTests, SpentFuelProperCommodTracking) {
   EXPECT_EQ(2*(simdur-1), qr.rows.size());
 }
 
+// tests that the supply time series track the spent fuel held for each
+// outcommod as assemblies are discharged and traded away.
+TEST(ReactorTests, SpentFuelSupplyTotals) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      <val>mox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> <val>spentmox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      <val>mox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste1</val>   <val>waste2</val>   </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  ";
+
+  int simdur = 7;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").capacity(1).Finalize();
+  sim.AddSource("mox").capacity(2).Finalize();
+  sim.AddSink("waste2").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  sim.AddRecipe("mox", c_mox());
+  sim.AddRecipe("spentmox", c_spentmox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+
+  // nobody takes waste1, so it piles up one assembly per discharge
+  QueryResult qr = sim.db().Query("TimeSeriessupplywaste1", &conds);
+  ASSERT_EQ(simdur-1, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    EXPECT_DOUBLE_EQ(i + 1, qr.GetVal<double>("Value", i));
+  }
+
+  // waste2 is traded away every time step, so only the latest discharge is
+  // ever held
+  qr = sim.db().Query("TimeSeriessupplywaste2", &conds);
+  ASSERT_EQ(simdur-1, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    EXPECT_DOUBLE_EQ(2, qr.GetVal<double>("Value", i));
+  }
+}
+
+// tests that aggregated spent fuel bids trade whole assemblies per commodity
+// in a single transaction.
+TEST(ReactorTests, AggregateSpentBids) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      <val>mox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> <val>spentmox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      <val>mox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste1</val>   <val>waste2</val>   </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  "
+     "  <aggregate_bids>1</aggregate_bids>  ";
+
+  int simdur = 7;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").capacity(1).Finalize();
+  sim.AddSource("mox").capacity(2).Finalize();
+  sim.AddSink("waste1").Finalize();
+  sim.AddSink("waste2").Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  sim.AddRecipe("mox", c_mox());
+  sim.AddRecipe("spentmox", c_spentmox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", id));
+  conds.push_back(Cond("Commodity", "==", std::string("waste1")));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  EXPECT_EQ(simdur-1, qr.rows.size());
+
+  // both mox assemblies of a batch go out together
+  conds[1] = Cond("Commodity", "==", std::string("waste2"));
+  qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(simdur-1, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(2, m->quantity());
+  }
+}
+
+// tests that aggregated spent fuel bids follow the spent fuel buffer when it
+// is drained over several time steps and while it stays unchanged.
+TEST(ReactorTests, AggregateSpentBidsDrain) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  "
+     "  <aggregate_bids>1</aggregate_bids>  ";
+
+  int simdur = 7;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").capacity(3).lifetime(1).Finalize();
+  sim.AddSink("waste").capacity(1).Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  // a single core is discharged and traded away one assembly at a time
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", id));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(3, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(1, m->quantity());
+    if (i > 0) {
+      EXPECT_LT(qr.GetVal<int>("Time", i - 1), qr.GetVal<int>("Time", i));
+    }
+  }
+}
+
+// tests that aggregated bids of several requests are not matched with more
+// assemblies of a composition than the reactor holds.
+TEST(ReactorTests, AggregateSpentBidsPerComposition) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      <val>mox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> <val>spentmox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      <val>mox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>3</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  "
+     "  <aggregate_bids>1</aggregate_bids>  ";
+
+  int simdur = 4;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").capacity(1).lifetime(1).Finalize();
+  sim.AddSource("mox").capacity(2).lifetime(1).Finalize();
+  sim.AddSink("waste").capacity(1).Finalize();
+  sim.AddSink("waste").capacity(1).Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  sim.AddRecipe("mox", c_mox());
+  sim.AddRecipe("spentmox", c_spentmox());
+  int id = sim.Run();
+
+  // one spent uox and two spent mox assemblies, two requests for one
+  // assembly each per time step
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", id));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(3, qr.rows.size());
+  std::map<int, int> per_time;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    Material::Ptr m = sim.GetMaterial(qr.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(1, m->quantity());
+    per_time[qr.GetVal<int>("Time", i)]++;
+  }
+  EXPECT_EQ(2, per_time.begin()->second);
+}
+
+// tests that memory reports are recorded every memory_interval time steps and
+// that res_indexes holds an entry for exactly the assemblies in the buffers.
+TEST(ReactorTests, MemoryReport) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>1</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>2</n_assem_core>  "
+     "  <n_assem_batch>1</n_assem_batch>  "
+     "  <memory_interval>2</memory_interval>  ";
+
+  int simdur = 6;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Reactor"), config, simdur);
+  sim.AddSource("uox").Finalize();
+  sim.AddSink("waste").capacity(1).Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", id));
+  QueryResult qr = sim.db().Query("ArchetypeMemory", &conds);
+  // fresh, core, spent and res_indexes on time steps 1, 3 and 5
+  ASSERT_EQ(12, qr.rows.size());
+
+  std::map<int, int> assems;
+  std::map<int, int> indexes;
+  for (int i = 0; i < qr.rows.size(); i++) {
+    int t = qr.GetVal<int>("Time", i);
+    EXPECT_EQ(1, t % 2) << "report on time step " << t;
+    std::string buf = qr.GetVal<std::string>("Buffer", i);
+    int count = qr.GetVal<int>("Count", i);
+    EXPECT_EQ(count > 0, qr.GetVal<double>("Bytes", i) > 0) << buf;
+    if (buf == "res_indexes") {
+      indexes[t] = count;
+    } else {
+      assems[t] += count;
+    }
+  }
+  EXPECT_EQ(3, indexes.size());
+  EXPECT_EQ(assems, indexes);
+}
+
+// runs the reactor of sim with a fresh fuel source and a spent fuel sink
+// taking less than a batch per time step, and returns the reactor's id.
+int RunBulkAssems(cyclus::MockSim& sim) {
+  sim.AddSource("uox").Finalize();
+  sim.AddSink("waste").capacity(2).Finalize();
+  sim.AddRecipe("uox", c_uox());
+  sim.AddRecipe("spentuox", c_spentuox());
+  return sim.Run();
+}
+
+// tests that with bulk assemblies, batches are kept and traded as single
+// materials without changing the assembly counts of events and trades.
+TEST(ReactorTests, BulkAssemblies) {
+  std::string config =
+     "  <fuel_inrecipes>  <val>uox</val>      </fuel_inrecipes>  "
+     "  <fuel_outrecipes> <val>spentuox</val> </fuel_outrecipes>  "
+     "  <fuel_incommods>  <val>uox</val>      </fuel_incommods>  "
+     "  <fuel_outcommods> <val>waste</val>    </fuel_outcommods>  "
+     ""
+     "  <cycle_time>2</cycle_time>  "
+     "  <refuel_time>0</refuel_time>  "
+     "  <assem_size>1</assem_size>  "
+     "  <n_assem_core>6</n_assem_core>  "
+     "  <n_assem_batch>3</n_assem_batch>  "
+     "  <bulk_order>1</bulk_order>  "
+     "  <aggregate_bids>1</aggregate_bids>  ";
+
+  int simdur = 12;
+  cyclus::MockSim assems(cyclus::AgentSpec(":cycamore:Reactor"), config,
+                         simdur);
+  int assems_id = RunBulkAssems(assems);
+  cyclus::MockSim bulk(cyclus::AgentSpec(":cycamore:Reactor"),
+                       config + "<bulk_assems>1</bulk_assems>", simdur);
+  int bulk_id = RunBulkAssems(bulk);
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("AgentId", "==", assems_id));
+  QueryResult want = assems.db().Query("ReactorEvents", &conds);
+  conds[0] = Cond("AgentId", "==", bulk_id);
+  QueryResult got = bulk.db().Query("ReactorEvents", &conds);
+  ASSERT_EQ(want.rows.size(), got.rows.size());
+  for (int i = 0; i < want.rows.size(); i++) {
+    EXPECT_EQ(want.GetVal<int>("Time", i), got.GetVal<int>("Time", i));
+    EXPECT_EQ(want.GetVal<std::string>("Event", i),
+              got.GetVal<std::string>("Event", i));
+    EXPECT_EQ(want.GetVal<std::string>("Value", i),
+              got.GetVal<std::string>("Value", i));
+  }
+
+  conds.clear();
+  conds.push_back(Cond("SenderId", "==", assems_id));
+  want = assems.db().Query("Transactions", &conds);
+  conds[0] = Cond("SenderId", "==", bulk_id);
+  got = bulk.db().Query("Transactions", &conds);
+  ASSERT_EQ(want.rows.size(), got.rows.size());
+  for (int i = 0; i < want.rows.size(); i++) {
+    EXPECT_EQ(want.GetVal<int>("Time", i), got.GetVal<int>("Time", i));
+    Material::Ptr m = assems.GetMaterial(want.GetVal<int>("ResourceId", i));
+    Material::Ptr b = bulk.GetMaterial(got.GetVal<int>("ResourceId", i));
+    EXPECT_DOUBLE_EQ(m->quantity(), b->quantity());
+  }
+
+  // a transmuted batch is one resource instead of one per assembly
+  EXPECT_GT(assems.db().Query("Resources", NULL).rows.size(),
+            bulk.db().Query("Resources", NULL).rows.size());
+}
+
 // The user can optionally omit fuel preferences.  In the case where
 // preferences are adjusted, the ommitted preference vector must be populated
 // with default values - if it wasn't then preferences won't be adjusted
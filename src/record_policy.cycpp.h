@@ -0,0 +1,51 @@
+// State variables of an agent recording through a RecordPolicy.  Archetypes
+// include this file in their class body, next to their other state
+// variables, and initialize the policy from them when entering the
+// simulation:
+//
+//   record_policy_.Init(record_mode, record_interval, &record_sums,
+//                       &record_counts, &record_sum_intervals, &record_last);
+//
+// The interval sums and last recorded values are state, so that a
+// simulation restarted from a snapshot records what it would have recorded
+// without the restart.
+
+#pragma cyclus var { \
+  "default": "all", \
+  "uilabel": "Recording Mode", \
+  "doc": "Which per time step output rows (time series such as supply " \
+         "and demand, and event tables) the agent records: 'all', 'none', " \
+         "'sample' (only on the last time step of each recording " \
+         "interval), 'mean' (as 'sample', with time series averaged " \
+         "over the interval) or 'runs' (all event rows, but time series " \
+         "only when their value changes).", \
+}
+std::string record_mode;
+
+#pragma cyclus var { \
+  "default": 1, \
+  "uilabel": "Recording Interval", \
+  "units": "time steps", \
+  "doc": "Number of time steps per recording interval for the 'sample' " \
+         "and 'mean' recording modes.", \
+}
+int record_interval;
+
+/// "mean" mode sum of the values of each time series since it was last
+/// recorded
+#pragma cyclus var {"default": {}, "internal": True}
+std::map<std::string, double> record_sums;
+
+/// "mean" mode number of values of each time series since it was last
+/// recorded
+#pragma cyclus var {"default": {}, "internal": True}
+std::map<std::string, int> record_counts;
+
+/// "mean" mode recording interval (the time step divided by the interval
+/// length) the sum of each time series belongs to
+#pragma cyclus var {"default": {}, "internal": True}
+std::map<std::string, int> record_sum_intervals;
+
+/// "runs" mode last recorded value of each time series
+#pragma cyclus var {"default": {}, "internal": True}
+std::map<std::string, double> record_last;
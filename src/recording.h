@@ -0,0 +1,359 @@
+#ifndef CYCAMORE_SRC_RECORDING_H_
+#define CYCAMORE_SRC_RECORDING_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "cyclus.h"
+
+namespace cycamore {
+
+/// RecordBuffer collects the rows an agent writes to one output table over a
+/// time step and records them in a single batch.  The table's columns are
+/// declared once, with their types given as template parameters, so adding a
+/// row in a hot path only appends a tuple to a buffer that keeps its storage
+/// from step to step - no datum is built until the buffer is flushed.
+///
+/// The table name and the column keys are prepared once per buffer.  Column
+/// names are kept as pointers, the form cyclus datums key their values by, so
+/// flushing a row does no name lookup or copy; they must outlive the
+/// simulation, e.g. string literals.  The recorder has no batch API, so each
+/// flushed row is still one datum with one value per column.  Owners flush
+/// their buffers at the end of each time step (their Tock) and before they
+/// are decommissioned.  Buffers are not state: a buffer is empty at the end
+/// of every time step.
+///
+///   static const char* const kCols[] = {"AgentId", "Time", "Event"};
+///   RecordBuffer<int, int, std::string> events("Events", kCols);
+///   events.Add(id(), context()->time(), "START");
+///   ...
+///   events.Flush(context());
+template <class... Ts>
+class RecordBuffer {
+ public:
+  typedef std::tuple<Ts...> Row;
+
+  /// @param table the output table name
+  /// @param cols the name of each of the table's columns
+  RecordBuffer(const char* table, const char* const* cols) : table_(table) {
+    std::copy(cols, cols + sizeof...(Ts), cols_);
+  }
+
+  /// buffers a row to be recorded at the next flush
+  void Add(const Ts&... vals) { rows_.push_back(Row(vals...)); }
+
+  /// records and clears the buffered rows
+  void Flush(cyclus::Context* ctx) {
+    for (int i = 0; i < rows_.size(); i++) {
+      cyclus::Datum* d = ctx->NewDatum(table_);
+      AddVals_<0>(d, rows_[i]);
+      d->Record();
+    }
+    rows_.clear();
+  }
+
+  /// @return the buffered rows
+  const std::vector<Row>& rows() const { return rows_; }
+
+  int size() const { return rows_.size(); }
+
+  const std::string& table() const { return table_; }
+
+ private:
+  template <std::size_t I>
+  typename std::enable_if<I == sizeof...(Ts)>::type
+  AddVals_(cyclus::Datum* d, const Row& r) {}
+
+  template <std::size_t I>
+  typename std::enable_if<(I < sizeof...(Ts))>::type
+  AddVals_(cyclus::Datum* d, const Row& r) {
+    d->AddVal(cols_[I], std::get<I>(r));
+    AddVals_<I + 1>(d, r);
+  }
+
+  std::string table_;
+  const char* cols_[sizeof...(Ts)];
+  std::vector<Row> rows_;
+};
+
+/// RecordPolicy decides which of an agent's per time step output rows are
+/// recorded.  Its mode is one of
+///
+///   - "all": record every row (the default),
+///   - "none": record no time series or event rows,
+///   - "sample": only record rows on the last time step of each interval,
+///   - "mean": as "sample", but time series values are averaged over the
+///     values given since they were last recorded,
+///   - "runs": record every event row, but a time series value only if it
+///     differs from the last recorded value of that time series, so that
+///     each row starts a run of equal values lasting until the next row.
+///
+/// Intervals are aligned to the simulation start, so a time series with
+/// interval N is recorded on time steps N-1, 2N-1, ...  Values given after
+/// the last interval of a simulation ends are not recorded.  Neither are the
+/// values of a time series that is not given on the last time step of an
+/// interval (e.g. a demand only given while there is one): in "sample" and
+/// "mean" mode it has no row for that interval, and its values are not
+/// carried into the mean of the next one.  Time series go
+/// through TimeSeries instead of cyclus::toolkit::RecordTimeSeries;
+/// event-like rows are guarded by RecordsEvents.
+///
+/// Values known during the resource exchange (e.g. the demand of a request
+/// or the supply of a bid) are given to Defer, which only stashes them, and
+/// are recorded by Flush in the agent's Tock, so that no exchange phase
+/// writes to the shared recorder.
+///
+/// The per time series sums, counts, intervals and last values the "mean"
+/// and "runs" modes need
+/// are kept by the agent as state, declared with its recording options by
+/// including record_policy.cycpp.h in its class body.
+class RecordPolicy {
+ public:
+  RecordPolicy()
+      : mode_("all"),
+        interval_(1),
+        sums_(NULL),
+        counts_(NULL),
+        sum_intervals_(NULL),
+        last_(NULL) {}
+
+  /// @param mode the recording mode, see above
+  /// @param interval the number of time steps per interval
+  /// @param sums the agent's "mean" mode sum of each time series
+  /// @param counts the agent's "mean" mode number of values summed
+  /// @param sum_intervals the agent's "mean" mode interval of each sum
+  /// @param last the agent's "runs" mode last value of each time series
+  /// @throws cyclus::ValueError for an unknown mode or a non-positive interval
+  void Init(const std::string& mode, int interval,
+            std::map<std::string, double>* sums,
+            std::map<std::string, int>* counts,
+            std::map<std::string, int>* sum_intervals,
+            std::map<std::string, double>* last) {
+    if (mode != "all" && mode != "none" && mode != "sample" &&
+        mode != "mean" && mode != "runs") {
+      throw cyclus::ValueError("recording mode must be one of 'all', 'none', "
+                               "'sample', 'mean' or 'runs', got '" + mode +
+                               "'");
+    } else if (interval < 1) {
+      throw cyclus::ValueError("recording interval must be at least 1");
+    }
+    mode_ = mode;
+    interval_ = interval;
+    sums_ = sums;
+    counts_ = counts;
+    sum_intervals_ = sum_intervals;
+    last_ = last;
+  }
+
+  const std::string& mode() const { return mode_; }
+
+  int interval() const { return interval_; }
+
+  /// @return whether event rows of time step t are recorded
+  bool RecordsEvents(int t) const {
+    return mode_ == "all" || mode_ == "runs" ||
+           (mode_ != "none" && Sampled_(t));
+  }
+
+  /// records (or not) a named time series value of agent a
+  void TimeSeries(const std::string& name, cyclus::Agent* a, double value) {
+    if (Keep_(name, a, &value)) {
+      cyclus::toolkit::RecordTimeSeries<double>(name, a, value);
+    }
+  }
+
+  /// records (or not) a value of agent a for one of the cyclus time series
+  /// types, e.g. cyclus::toolkit::POWER
+  template <class T>
+  void TimeSeries(cyclus::Agent* a, double value) {
+    if (Keep_(typeid(T).name(), a, &value)) {
+      cyclus::toolkit::RecordTimeSeries<T>(a, value);
+    }
+  }
+
+  /// stashes a named time series value to be given to TimeSeries by the
+  /// next Flush
+  void Defer(const std::string& name, double value) {
+    deferred_.push_back(std::make_pair(name, value));
+  }
+
+  /// records (or not) and clears the deferred time series values of agent a
+  void Flush(cyclus::Agent* a) {
+    for (int i = 0; i < deferred_.size(); i++) {
+      TimeSeries(deferred_[i].first, a, deferred_[i].second);
+    }
+    deferred_.clear();
+  }
+
+ private:
+  bool Sampled_(int t) const { return (t + 1) % interval_ == 0; }
+
+  /// @return whether the value of the time series key is to be recorded now,
+  /// replacing it with its interval mean in "mean" mode
+  bool Keep_(const std::string& key, cyclus::Agent* a, double* value) {
+    if (mode_ == "all") {
+      return true;
+    } else if (mode_ == "none") {
+      return false;
+    } else if (mode_ == "runs") {
+      std::map<std::string, double>::iterator it = last_->find(key);
+      if (it != last_->end() && it->second == *value) {
+        return false;
+      }
+      (*last_)[key] = *value;
+      return true;
+    }
+
+    int t = a->context()->time();
+    bool sampled = Sampled_(t);
+    if (mode_ == "mean") {
+      // a sum left from an interval whose last time step the time series was
+      // not given on is dropped rather than averaged into this interval
+      int interval = t / interval_;
+      std::map<std::string, int>::iterator it = sum_intervals_->find(key);
+      if (it == sum_intervals_->end() || it->second != interval) {
+        (*sums_)[key] = 0;
+        (*counts_)[key] = 0;
+        (*sum_intervals_)[key] = interval;
+      }
+      double& sum = (*sums_)[key];
+      int& count = (*counts_)[key];
+      sum += *value;
+      count++;
+      if (sampled) {
+        *value = sum / count;
+        sums_->erase(key);
+        counts_->erase(key);
+        sum_intervals_->erase(key);
+      }
+    }
+    return sampled;
+  }
+
+  std::string mode_;
+  int interval_;
+
+  std::map<std::string, double>* sums_;
+  std::map<std::string, int>* counts_;
+  std::map<std::string, int>* sum_intervals_;
+  std::map<std::string, double>* last_;
+
+  // deferred values are recorded within their time step, so are not state
+  std::vector<std::pair<std::string, double> > deferred_;
+};
+
+/// MemoryReport records, every interval time steps, how many objects each of
+/// an agent's buffers holds and an estimate of the bytes they take to the
+/// ArchetypeMemory table:
+///
+///   - AgentId, Time: the agent and time step,
+///   - Buffer: the name of the buffer (a ResBuf, or a map, list or vector
+///     of bookkeeping entries),
+///   - Count: the number of resources or entries it holds,
+///   - Bytes: the estimated bytes they take.
+///
+/// Byte estimates only count what the buffer holds on its own behalf: a
+/// resource, its reference count and its ResBuf entry, or a container
+/// node.  Compositions are shared between resources and are not counted, nor
+/// is the heap memory owned by entries (e.g. the characters of a string).
+/// The estimates are meant for comparing buffers and spotting growth rather
+/// than for accounting.
+///
+/// Reports are off by default.  Like RecordPolicy intervals, report intervals
+/// are aligned to the simulation start, so an agent with interval N reports on
+/// time steps N-1, 2N-1, ...  Owners check Due in their Tock, Add each buffer
+/// and Flush.
+///
+///   if (memory_.Due(context()->time())) {
+///     memory_.Add("inventory", inventory);
+///     memory_.Flush(this);
+///   }
+class MemoryReport {
+ public:
+  MemoryReport() : interval_(0), rows_("ArchetypeMemory", Cols_()) {}
+
+  /// @param interval the number of time steps between reports, 0 for none
+  /// @throws cyclus::ValueError for a negative interval
+  void Init(int interval) {
+    if (interval < 0) {
+      throw cyclus::ValueError("memory report interval must not be negative");
+    }
+    interval_ = interval;
+  }
+
+  int interval() const { return interval_; }
+
+  /// @return whether a report is due on time step t
+  bool Due(int t) const { return interval_ > 0 && (t + 1) % interval_ == 0; }
+
+  /// adds a buffer of count objects taking an estimated bytes
+  void Add(const std::string& name, int count, double bytes) {
+    names_.push_back(name);
+    counts_.push_back(count);
+    bytes_.push_back(bytes);
+  }
+
+  template <class T>
+  void Add(const std::string& name, const cyclus::toolkit::ResBuf<T>& buf) {
+    // the resource and its shared_ptr control block, plus the buffer's list
+    // node and the set node it uses to reject duplicates
+    double each = sizeof(T) + 4 * sizeof(void*) +
+                  (2 * sizeof(void*) + sizeof(typename T::Ptr)) +
+                  (4 * sizeof(void*) + sizeof(typename T::Ptr));
+    Add(name, buf.count(), buf.count() * each);
+  }
+
+  template <class K, class V>
+  void Add(const std::string& name, const std::map<K, V>& m) {
+    // a red-black tree node is three links and a color
+    Add(name, m.size(),
+        m.size() * (sizeof(std::pair<const K, V>) + 4 * sizeof(void*)));
+  }
+
+  template <class T>
+  void Add(const std::string& name, const std::list<T>& l) {
+    Add(name, l.size(), l.size() * (sizeof(T) + 2 * sizeof(void*)));
+  }
+
+  template <class T>
+  void Add(const std::string& name, const std::vector<T>& v) {
+    Add(name, v.size(), v.capacity() * sizeof(T));
+  }
+
+  /// records and clears the added buffers as rows of agent a
+  void Flush(cyclus::Agent* a) {
+    int t = a->context()->time();
+    for (int i = 0; i < names_.size(); i++) {
+      rows_.Add(a->id(), t, names_[i], counts_[i], bytes_[i]);
+    }
+    rows_.Flush(a->context());
+    names_.clear();
+    counts_.clear();
+    bytes_.clear();
+  }
+
+ private:
+  static const char* const* Cols_() {
+    static const char* const cols[] = {"AgentId", "Time", "Buffer", "Count",
+                                       "Bytes"};
+    return cols;
+  }
+
+  int interval_;
+  std::vector<std::string> names_;
+  std::vector<int> counts_;
+  std::vector<double> bytes_;
+  RecordBuffer<int, int, std::string, int, double> rows_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_RECORDING_H_
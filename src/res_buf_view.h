@@ -0,0 +1,188 @@
+#ifndef CYCAMORE_SRC_RES_BUF_VIEW_H_
+#define CYCAMORE_SRC_RES_BUF_VIEW_H_
+
+#include <deque>
+#include <vector>
+
+#include "cyclus.h"
+
+namespace cycamore {
+
+/// ResBufView keeps a mirror of a ResBuf's contents in the buffer's FIFO
+/// order so that an archetype can inspect everything it holds without popping
+/// the whole buffer and pushing it straight back.  Reading through the view
+/// costs no allocation and does not mutate the buffer.
+///
+/// To keep the mirror current, pushes and pops of the buffer should go
+/// through the view.  The view checks itself against the buffer's count
+/// before every read and rebuilds the mirror with a single pop/push round
+/// trip if they disagree (e.g. after the buffer was refilled directly when
+/// restarting from a snapshot), so missing an update only costs performance.
+/// Views are not state - they are simply rebuilt on first use.
+///
+/// Every change made through the view (or picked up by a rebuild) bumps its
+/// version(), so results derived from the contents, such as bid offers, can
+/// be reused for as long as the version is unchanged.
+template <class T>
+class ResBufView {
+ public:
+  typedef typename T::Ptr Ptr;
+  typedef typename std::deque<Ptr>::const_iterator const_iterator;
+
+  explicit ResBufView(cyclus::toolkit::ResBuf<T>* buf = NULL)
+      : buf_(buf), version_(0) {}
+
+  /// Sets the buffer being viewed and discards the current mirror.
+  void Init(cyclus::toolkit::ResBuf<T>* buf) {
+    buf_ = buf;
+    mirror_.clear();
+    version_++;
+  }
+
+  /// Returns a counter that changes whenever the buffer's contents do.
+  unsigned long version() {
+    Sync_();
+    return version_;
+  }
+
+  /// Returns the viewed buffer's contents, oldest first.
+  const std::deque<Ptr>& contents() {
+    Sync_();
+    return mirror_;
+  }
+
+  const_iterator begin() { return contents().begin(); }
+  const_iterator end() { return contents().end(); }
+
+  /// Returns the i'th oldest resource in the buffer.
+  Ptr operator[](int i) { return contents()[i]; }
+
+  int count() const { return buf_->count(); }
+
+  double quantity() const { return buf_->quantity(); }
+
+  bool empty() const { return buf_->empty(); }
+
+  /// The mirrored ResBuf::Push.
+  void Push(cyclus::Resource::Ptr r) {
+    Sync_();
+    buf_->Push(r);
+    mirror_.push_back(cyclus::ResCast<T>(r));
+    version_++;
+  }
+
+  /// The mirrored ResBuf::Push for many resources.
+  template <class B>
+  void Push(const std::vector<B>& rs) {
+    Sync_();
+    buf_->Push(rs);
+    for (int i = 0; i < rs.size(); i++) {
+      mirror_.push_back(cyclus::ResCast<T>(rs[i]));
+    }
+    version_++;
+  }
+
+  /// The mirrored ResBuf::Pop.
+  Ptr Pop() {
+    Sync_();
+    Ptr r = buf_->Pop();
+    mirror_.pop_front();
+    version_++;
+    return r;
+  }
+
+  /// The mirrored ResBuf::PopBack.
+  Ptr PopBack() {
+    Sync_();
+    Ptr r = buf_->PopBack();
+    mirror_.pop_back();
+    version_++;
+    return r;
+  }
+
+  /// The mirrored ResBuf::PopN.
+  std::vector<Ptr> PopN(int n) {
+    Sync_();
+    std::vector<Ptr> rs = buf_->PopN(n);
+    mirror_.erase(mirror_.begin(), mirror_.begin() + rs.size());
+    version_++;
+    return rs;
+  }
+
+  /// The mirrored ResBuf::Pop of a quantity.  Whole resources are removed
+  /// from the front of the buffer; the resource that was split (if any) stays
+  /// at the front with its remaining quantity.
+  Ptr Pop(double qty, double eps = cyclus::eps_rsrc()) {
+    Sync_();
+    Ptr r = buf_->Pop(qty, eps);
+    Trim_();
+    version_++;
+    return r;
+  }
+
+  /// Merges runs of adjacent viewed materials whose compositions match within
+  /// tol (see cyclus::compmath::AlmostEq) into one material per run.  Only
+  /// neighbours are merged, so the buffer keeps its first in, first out
+  /// order: popping any quantity gives the same compositions in the same
+  /// order as without compaction.  Each material is compared against the
+  /// composition of its run's oldest material, so merged compositions never
+  /// drift further than tol from it.  Only available for views of materials.
+  ///
+  /// @return the number of materials merged away
+  int Compact(double tol) {
+    Sync_();
+    if (buf_->count() < 2) {
+      return 0;
+    }
+
+    std::vector<Ptr> rs = buf_->PopN(buf_->count());
+    std::vector<Ptr> merged;
+    cyclus::Composition::Ptr rep;
+    for (int i = 0; i < rs.size(); i++) {
+      cyclus::Composition::Ptr c = rs[i]->comp();
+      if (i > 0 && (c == rep ||
+                    cyclus::compmath::AlmostEq(c->mass(), rep->mass(), tol))) {
+        merged.back()->Absorb(rs[i]);
+      } else {
+        merged.push_back(rs[i]);
+        rep = c;
+      }
+    }
+    buf_->Push(merged);
+    mirror_.assign(merged.begin(), merged.end());
+    if (merged.size() < rs.size()) {
+      version_++;
+    }
+    return rs.size() - merged.size();
+  }
+
+ private:
+  /// Rebuilds the mirror if it is out of step with the buffer.
+  void Sync_() {
+    if (mirror_.size() == buf_->count()) {
+      return;
+    }
+    std::vector<Ptr> rs = buf_->PopN(buf_->count());
+    buf_->Push(rs);
+    mirror_.assign(rs.begin(), rs.end());
+    version_++;
+  }
+
+  /// Drops mirrored resources that were popped off the front of the buffer.
+  void Trim_() {
+    while (mirror_.size() > buf_->count()) {
+      mirror_.pop_front();
+    }
+    if (!mirror_.empty()) {
+      mirror_.front() = buf_->Peek();
+    }
+  }
+
+  cyclus::toolkit::ResBuf<T>* buf_;
+  std::deque<Ptr> mirror_;
+  unsigned long version_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_RES_BUF_VIEW_H_
@@ -11,8 +11,19 @@ using cyclus::CompMap;
 
 namespace cycamore {
 
+static const char* const kEventCols[] = {"AgentId", "Time", "Event", "Value",
+                                         "Type"};
+
 Separations::Separations(cyclus::Context* ctx)
     : cyclus::Facility(ctx),
+      leftover_compact_tol(-1),
+      stream_compact_tol(-1),
+      feed_view_(&feed),
+      leftover_view_(&leftover),
+      events_("SeparationEvents", kEventCols),
+      record_mode("all"),
+      record_interval(1),
+      memory_interval(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {}
@@ -23,35 +34,62 @@ cyclus::Inventories Separations::SnapshotInv() {
   // these inventory names are intentionally convoluted so as to not clash
   // with the user-specified stream commods that are used as the separations
   // streams inventory names.
-  invs["leftover-inv-name"] = leftover.PopNRes(leftover.count());
-  leftover.Push(invs["leftover-inv-name"]);
-  invs["feed-inv-name"] = feed.PopNRes(feed.count());
-  feed.Push(invs["feed-inv-name"]);
+  invs["leftover-inv-name"] =
+      std::vector<cyclus::Resource::Ptr>(leftover_view_.begin(),
+                                         leftover_view_.end());
+  invs["feed-inv-name"] =
+      std::vector<cyclus::Resource::Ptr>(feed_view_.begin(), feed_view_.end());
 
   std::map<std::string, ResBuf<Material> >::iterator it;
   for (it = streambufs.begin(); it != streambufs.end(); ++it) {
-    invs[it->first] = it->second.PopNRes(it->second.count());
-    it->second.Push(invs[it->first]);
+    ResBufView<Material>& view = StreamView_(it->first);
+    invs[it->first] =
+        std::vector<cyclus::Resource::Ptr>(view.begin(), view.end());
   }
 
   return invs;
 }
 
+void Separations::InitFrom(Separations* m) {
+  #pragma cyclus impl initfromcopy cycamore::Separations
+  sep_table_.Share(m->sep_table_);
+}
+
+void Separations::InitFrom(cyclus::QueryableBackend* b) {
+  #pragma cyclus impl initfromdb cycamore::Separations
+  CompileStreams_();
+}
+
 void Separations::InitInv(cyclus::Inventories& inv) {
   leftover.Push(inv["leftover-inv-name"]);
   feed.Push(inv["feed-inv-name"]);
 
   cyclus::Inventories::iterator it;
   for (it = inv.begin(); it != inv.end(); ++it) {
-    streambufs[it->first].Push(it->second);
+    if (it->first != "leftover-inv-name" && it->first != "feed-inv-name") {
+      streambufs[it->first].Push(it->second);
+    }
   }
 }
 
+ResBufView<Material>& Separations::StreamView_(const std::string& name) {
+  std::map<std::string, ResBufView<Material> >::iterator it =
+      stream_views_.find(name);
+  if (it == stream_views_.end()) {
+    it = stream_views_.insert(std::make_pair(
+        name, ResBufView<Material>(&streambufs[name]))).first;
+  }
+  return it->second;
+}
+
 typedef std::pair<double, std::map<int, double> > Stream;
 typedef std::map<std::string, Stream> StreamSet;
 
 void Separations::EnterNotify() {
   cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  memory_.Init(memory_interval);
   std::map<int, double> efficiency_;
 
   StreamSet::iterator it;
@@ -70,6 +108,11 @@ void Separations::EnterNotify() {
     }
     RecordPosition();
   }
+  if (sep_table_.size() != streams_.size()) {
+    CompileStreams_();
+  } else {
+    sep_table_.cache_size(sep_cache_size);
+  }
 
   std::vector<int> eff_pb_;
   for (it2 = efficiency_.begin(); it2 != efficiency_.end(); it2++) {
@@ -102,82 +145,141 @@ void Separations::EnterNotify() {
   }
 }
 
+void Separations::CompileStreams_() {
+  std::vector<std::map<int, double> > effs;
+  StreamSet::iterator it;
+  for (it = streams_.begin(); it != streams_.end(); ++it) {
+    effs.push_back(it->second.second);
+  }
+  sep_table_.Init(effs);
+  sep_table_.cache_size(sep_cache_size);
+}
+
+void Separations::RecordCache_() {
+  if (!record_sep_cache || !record_policy_.RecordsEvents(context()->time())) {
+    return;
+  }
+  context()
+      ->NewDatum("SeparationsCache")
+      ->AddVal("AgentId", id())
+      ->AddVal("Time", context()->time())
+      ->AddVal("Hits", static_cast<int>(sep_table_.hits()))
+      ->AddVal("Misses", static_cast<int>(sep_table_.misses()))
+      ->AddVal("Entries", sep_table_.cached())
+      ->Record();
+}
+
 void Separations::Tick() {
-  using cyclus::toolkit::RecordTimeSeries;
+  CYCAMORE_PERF_SCOPE("Tick");
+  TickPlan plan;
+  if (ComputeTick(&plan)) {
+    CommitTick(plan);
+  }
+}
+
+bool Separations::ComputeTick(TickPlan* plan) {
   if (feed.count() == 0) {
-    return;
+    return false;
+  }
+  plan->feed_qty = std::min(throughput, feed.quantity());
+
+  if (sep_table_.size() != streams_.size()) {
+    CompileStreams_();
   }
-  double pop_qty = std::min(throughput, feed.quantity());
-  Material::Ptr mat = feed.Pop(pop_qty, cyclus::eps_rsrc());
-  double orig_qty = mat->quantity();
+
+  // the composition of what popping feed_qty would give - feed that is all
+  // one material keeps its composition (and so its separations cache entry)
+  const std::deque<Material::Ptr>& mats = feed_view_.contents();
+  if (mats[0]->quantity() >= plan->feed_qty - cyclus::eps_rsrc()) {
+    plan->feed_comp = mats[0]->comp();
+    plan->cuts = &sep_table_.Separate(plan->feed_comp);
+  } else {
+    double left = plan->feed_qty;
+    for (int i = 0; i < mats.size() && left > cyclus::eps_rsrc(); i++) {
+      double qty = std::min(left, mats[i]->quantity());
+      CompMap v = mats[i]->comp()->mass();
+      cyclus::compmath::Normalize(&v, qty);
+      plan->feed_mass = cyclus::compmath::Add(plan->feed_mass, v);
+      left -= qty;
+    }
+    plan->cuts = &sep_table_.Separate(plan->feed_mass);
+  }
+  const std::vector<SepEffTable::Cut>& cuts = *plan->cuts;
 
   StreamSet::iterator it;
-  double maxfrac = 1;
-  std::map<std::string, Material::Ptr> stagedsep;
-  Record("Separating", orig_qty, "feed");
-  for (it = streams_.begin(); it != streams_.end(); ++it) {
-    Stream info = it->second;
-    std::string name = it->first;
-    stagedsep[name] = SepMaterial(info.second, mat);
-    double frac = streambufs[name].space() / stagedsep[name]->quantity();
-    if (frac < maxfrac) {
-      maxfrac = frac;
+  plan->maxfrac = 1;
+  int i = 0;
+  for (it = streams_.begin(); it != streams_.end(); ++it, ++i) {
+    double frac = streambufs[it->first].space() /
+                  (cuts[i].frac * plan->feed_qty);
+    if (frac < plan->maxfrac) {
+      plan->maxfrac = frac;
     }
   }
+  return true;
+}
 
-  std::map<std::string, Material::Ptr>::iterator itf;
-  for (itf = stagedsep.begin(); itf != stagedsep.end(); ++itf) {
-    std::string name = itf->first;
-    Material::Ptr m = itf->second;
-    if (m->quantity() > 0) {
-      double qty = m->quantity();
-      if (m->quantity() > mat->quantity()) {
+void Separations::CommitTick(const TickPlan& plan) {
+  Material::Ptr mat = feed_view_.Pop(plan.feed_qty, cyclus::eps_rsrc());
+  double orig_qty = mat->quantity();
+  double maxfrac = plan.maxfrac;
+  RecordCache_();
+
+  const std::vector<SepEffTable::Cut>& cuts = *plan.cuts;
+  StreamSet::iterator it;
+  int i = 0;
+  Record("Separating", orig_qty, "feed");
+  for (it = streams_.begin(); it != streams_.end(); ++it, ++i) {
+    const std::string& name = it->first;
+    double qty = cuts[i].frac * orig_qty;
+    if (qty > 0) {
+      if (qty > mat->quantity()) {
         qty = mat->quantity();
       }
-      streambufs[name].Push(
-          mat->ExtractComp(qty * maxfrac, m->comp()));
+      StreamView_(name).Push(mat->ExtractComp(qty * maxfrac,
+                                              cuts[i].comp()));
       Record("Separated", qty * maxfrac, name);
     }
-    cyclus::toolkit::RecordTimeSeries<double>("supply"+name, this,
-                                              streambufs[name].quantity());
+    record_policy_.TimeSeries("supply"+name, this, streambufs[name].quantity());
   }
 
   if (maxfrac == 1) {
     if (mat->quantity() > 0) {
       // unspecified separations fractions go to leftovers
-      leftover.Push(mat);
+      leftover_view_.Push(mat);
     }
   } else {  // maxfrac is < 1
     // push back any leftover feed due to separated stream inv size constraints
 
-    feed.Push(mat->ExtractQty((1 - maxfrac) * orig_qty));
+    feed_view_.Push(mat->ExtractQty((1 - maxfrac) * orig_qty));
     if (mat->quantity() > 0) {
       // unspecified separations fractions go to leftovers
-      leftover.Push(mat);
+      leftover_view_.Push(mat);
     }
   }
-  cyclus::toolkit::RecordTimeSeries<double>("supply"+leftover_commod, this,
-                                            leftover.quantity());
-
+  record_policy_.TimeSeries("supply"+leftover_commod, this,
+                            leftover.quantity());
 }
 
 // Note that this returns an untracked material that should just be used for
 // its composition and qty - not in any real inventories, etc.
-Material::Ptr SepMaterial(std::map<int, double> effs, Material::Ptr mat) {
+Material::Ptr SepMaterial(const std::map<int, double>& effs,
+                          Material::Ptr mat) {
   CompMap cm = mat->comp()->mass();
   cyclus::compmath::Normalize(&cm, mat->quantity());
   double tot_qty = 0;
   CompMap sepcomp;
 
   CompMap::iterator it;
+  std::map<int, double>::const_iterator eit;
   for (it = cm.begin(); it != cm.end(); ++it) {
     int nuc = it->first;
     int elem = (nuc / 10000000) * 10000000;
     double eff = 0;
-    if (effs.count(nuc) > 0) {
-      eff = effs[nuc];
-    } else if (effs.count(elem) > 0) {
-      eff = effs[elem];
+    if ((eit = effs.find(nuc)) != effs.end()) {
+      eff = eit->second;
+    } else if ((eit = effs.find(elem)) != effs.end()) {
+      eff = eit->second;
     } else {
       continue;
     }
@@ -192,10 +294,172 @@ Material::Ptr SepMaterial(std::map<int, double> effs, Material::Ptr mat) {
   return Material::CreateUntracked(tot_qty, c);
 };
 
+std::map<SepEffTable::EffList, boost::weak_ptr<const SepEffTable::Effs> >
+    SepEffTable::compiled_;
+std::mutex SepEffTable::mutex_;
+
+void SepEffTable::Init(const std::vector<std::map<int, double> >& effs) {
+  nstreams_ = effs.size();
+  effs_ = Compile_(effs);
+  lru_.clear();
+  lru_index_.clear();
+}
+
+void SepEffTable::Share(const SepEffTable& other) {
+  nstreams_ = other.nstreams_;
+  effs_ = other.effs_;
+  lru_.clear();
+  lru_index_.clear();
+}
+
+boost::shared_ptr<const SepEffTable::Effs> SepEffTable::Compile_(
+    const EffList& effs) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  boost::weak_ptr<const Effs>& shared = compiled_[effs];
+  boost::shared_ptr<const Effs> compiled = shared.lock();
+  if (compiled) {
+    return compiled;
+  }
+
+  // drop the entries of tables that are gone
+  std::map<EffList, boost::weak_ptr<const Effs> >::iterator c;
+  for (c = compiled_.begin(); c != compiled_.end();) {
+    if (c->second.expired() && &c->second != &shared) {
+      compiled_.erase(c++);
+    } else {
+      ++c;
+    }
+  }
+
+  boost::shared_ptr<Effs> e(new Effs());
+  int nstreams = effs.size();
+  std::map<int, double>::const_iterator it;
+  for (int s = 0; s < nstreams; s++) {
+    for (it = effs[s].begin(); it != effs[s].end(); ++it) {
+      int z = it->first / 10000000;
+      if (it->first % 10000000 != 0) {
+        continue;
+      }
+      if (e->elem.size() < (z + 1) * nstreams) {
+        e->elem.resize((z + 1) * nstreams, -1);
+      }
+      e->elem[z * nstreams + s] = it->second;
+    }
+  }
+
+  // nuclide overrides fall back on their element's efficiency for streams
+  // that only specify the element
+  for (int s = 0; s < nstreams; s++) {
+    for (it = effs[s].begin(); it != effs[s].end(); ++it) {
+      int nuc = it->first;
+      if (nuc % 10000000 == 0 || e->nucs.count(nuc) > 0) {
+        continue;
+      }
+      std::vector<double>& row = e->nucs[nuc];
+      int z = nuc / 10000000;
+      if ((z + 1) * nstreams <= e->elem.size()) {
+        row.assign(e->elem.begin() + z * nstreams,
+                   e->elem.begin() + (z + 1) * nstreams);
+      } else {
+        row.assign(nstreams, -1);
+      }
+      for (int s2 = 0; s2 < nstreams; s2++) {
+        std::map<int, double>::const_iterator f = effs[s2].find(nuc);
+        if (f != effs[s2].end()) {
+          row[s2] = f->second;
+        }
+      }
+    }
+  }
+
+  shared = e;
+  return e;
+}
+
+const double* SepEffTable::Row_(int nuc) const {
+  const std::map<int, std::vector<double> >& nucs = effs_->nucs;
+  if (!nucs.empty()) {
+    std::map<int, std::vector<double> >::const_iterator it = nucs.find(nuc);
+    if (it != nucs.end()) {
+      return &it->second[0];
+    }
+  }
+  int z = nuc / 10000000;
+  if ((z + 1) * nstreams_ > effs_->elem.size()) {
+    return NULL;
+  }
+  return &effs_->elem[z * nstreams_];
+}
+
+void SepEffTable::cache_size(int n) {
+  cache_size_ = std::max(0, n);
+  Evict_();
+}
+
+void SepEffTable::Evict_() {
+  while (lru_.size() > cache_size_) {
+    lru_index_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+const std::vector<SepEffTable::Cut>& SepEffTable::Separate(
+    Composition::Ptr c) {
+  std::map<int, CutList::iterator>::iterator it = lru_index_.find(c->id());
+  if (it != lru_index_.end()) {
+    hits_++;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return lru_.front().second;
+  }
+
+  misses_++;
+  if (cache_size_ == 0) {
+    Compute_(c->mass(), &uncached_);
+    return uncached_;
+  }
+  lru_.push_front(std::make_pair(c->id(), std::vector<Cut>()));
+  lru_index_[c->id()] = lru_.begin();
+  Compute_(c->mass(), &lru_.front().second);
+  Evict_();
+  return lru_.front().second;
+}
+
+const std::vector<SepEffTable::Cut>& SepEffTable::Separate(const CompMap& m) {
+  misses_++;
+  Compute_(m, &uncached_);
+  return uncached_;
+}
+
+void SepEffTable::Compute_(const CompMap& m, std::vector<Cut>* cuts) const {
+  cuts->assign(nstreams_, Cut());
+  if (nstreams_ == 0) {
+    return;
+  }
+
+  CompMap cm = m;
+  cyclus::compmath::Normalize(&cm, 1);
+
+  CompMap::iterator it;
+  for (it = cm.begin(); it != cm.end(); ++it) {
+    const double* effs = Row_(it->first);
+    if (effs == NULL) {
+      continue;
+    }
+    for (int s = 0; s < nstreams_; s++) {
+      if (effs[s] < 0) {
+        continue;
+      }
+      double sepqty = it->second * effs[s];
+      (*cuts)[s].mass[it->first] = sepqty;
+      (*cuts)[s].frac += sepqty;
+    }
+  }
+}
+
 std::set<cyclus::RequestPortfolio<Material>::Ptr>
 Separations::GetMatlRequests() {
+  CYCAMORE_PERF_SCOPE("GetMatlRequests");
   using cyclus::RequestPortfolio;
-  using cyclus::toolkit::RecordTimeSeries;
   std::set<RequestPortfolio<Material>::Ptr> ports;
 
   int t = context()->time();
@@ -205,8 +469,7 @@ Separations::GetMatlRequests() {
   std::vector<double>::iterator result;
   result = std::max_element(feed_commod_prefs.begin(), feed_commod_prefs.end());
   int maxindx = std::distance(feed_commod_prefs.begin(), result);
-  cyclus::toolkit::RecordTimeSeries<double>("demand"+feed_commods[maxindx],
-                                            this, feed.space());
+  record_policy_.Defer("demand"+feed_commods[maxindx], feed.space());
   if (t_exit >= 0 && (feed.quantity() >= (t_exit - t) * throughput)) {
     return ports;  // already have enough feed for remainder of life
   } else if (feed.space() < cyclus::eps_rsrc()) {
@@ -216,11 +479,11 @@ Separations::GetMatlRequests() {
   bool exclusive = false;
   RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
 
-  Material::Ptr m = cyclus::NewBlankMaterial(feed.space());
+  Composition::Ptr c;
   if (!feed_recipe.empty()) {
-    Composition::Ptr c = context()->GetRecipe(feed_recipe);
-    m = Material::CreateUntracked(feed.space(), c);
+    c = context()->GetRecipe(feed_recipe);
   }
+  Material::Ptr m = pool_.Get(context()->time(), feed.space(), c);
 
   std::vector<cyclus::Request<Material>*> reqs;
   for (int i = 0; i < feed_commods.size(); i++) {
@@ -238,6 +501,7 @@ void Separations::GetMatlTrades(
     const std::vector<cyclus::Trade<Material> >& trades,
     std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
         responses) {
+  CYCAMORE_PERF_SCOPE("GetMatlTrades");
   using cyclus::Trade;
 
   std::vector<cyclus::Trade<cyclus::Material> >::const_iterator it;
@@ -245,11 +509,11 @@ void Separations::GetMatlTrades(
     std::string commod = trades[i].request->commodity();
     if (commod == leftover_commod) {
       double amt = std::min(leftover.quantity(), trades[i].amt);
-      Material::Ptr m = leftover.Pop(amt, cyclus::eps_rsrc());
+      Material::Ptr m = leftover_view_.Pop(amt, cyclus::eps_rsrc());
       responses.push_back(std::make_pair(trades[i], m));
     } else if (streambufs.count(commod) > 0) {
       double amt = std::min(streambufs[commod].quantity(), trades[i].amt);
-      Material::Ptr m = streambufs[commod].Pop(amt, cyclus::eps_rsrc());
+      Material::Ptr m = StreamView_(commod).Pop(amt, cyclus::eps_rsrc());
       responses.push_back(std::make_pair(trades[i], m));
     } else {
       throw ValueError("invalid commodity " + commod +
@@ -261,18 +525,19 @@ void Separations::GetMatlTrades(
 void Separations::AcceptMatlTrades(
     const std::vector<std::pair<cyclus::Trade<Material>, Material::Ptr> >&
         responses) {
+  CYCAMORE_PERF_SCOPE("AcceptMatlTrades");
   std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                         cyclus::Material::Ptr> >::const_iterator trade;
 
   for (trade = responses.begin(); trade != responses.end(); ++trade) {
-    feed.Push(trade->second);
+    feed_view_.Push(trade->second);
   }
 }
 
 std::set<cyclus::BidPortfolio<Material>::Ptr> Separations::GetMatlBids(
     cyclus::CommodMap<Material>::type& commod_requests) {
+  CYCAMORE_PERF_SCOPE("GetMatlBids");
   using cyclus::BidPortfolio;
-  bool exclusive = false;
   std::set<BidPortfolio<Material>::Ptr> ports;
 
   // bid streams
@@ -286,29 +551,9 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> Separations::GetMatlBids(
       continue;
     }
 
-    MatVec mats = streambufs[commod].PopN(streambufs[commod].count());
-    streambufs[commod].Push(mats);
-
     BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
 
-    for (int j = 0; j < reqs.size(); j++) {
-      Request<Material>* req = reqs[j];
-      double tot_bid = 0;
-      for (int k = 0; k < mats.size(); k++) {
-        Material::Ptr m = mats[k];
-        tot_bid += m->quantity();
-
-        // this fix the problem of the cyclus exchange manager which crashes
-        // when a bid with a quantity <=0 is offered.
-        if (m->quantity() > cyclus::eps_rsrc()) {
-          port->AddBid(req, m, this, exclusive);
-        }
-
-        if (tot_bid >= req->target()->quantity()) {
-          break;
-        }
-      }
-    }
+    AddBids_(port, reqs, StreamView_(commod));
 
     double tot_qty = streambufs[commod].quantity();
     cyclus::CapacityConstraint<Material> cc(tot_qty);
@@ -319,29 +564,9 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> Separations::GetMatlBids(
   // bid leftovers
   std::vector<Request<Material>*>& reqs = commod_requests[leftover_commod];
   if (reqs.size() > 0 && leftover.quantity() >= cyclus::eps_rsrc()) {
-    MatVec mats = leftover.PopN(leftover.count());
-    leftover.Push(mats);
-
     BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
 
-    for (int j = 0; j < reqs.size(); j++) {
-      Request<Material>* req = reqs[j];
-      double tot_bid = 0;
-      for (int k = 0; k < mats.size(); k++) {
-        Material::Ptr m = mats[k];
-        tot_bid += m->quantity();
-
-        // this fix the problem of the cyclus exchange manager which crashes
-        // when a bid with a quantity <=0 is offered.
-        if (m->quantity() > cyclus::eps_rsrc()) {
-          port->AddBid(req, m, this, exclusive);
-        }
-
-        if (tot_bid >= req->target()->quantity()) {
-          break;
-        }
-      }
-    }
+    AddBids_(port, reqs, leftover_view_);
 
     cyclus::CapacityConstraint<Material> cc(leftover.quantity());
     port->AddConstraint(cc);
@@ -351,7 +576,83 @@ std::set<cyclus::BidPortfolio<Material>::Ptr> Separations::GetMatlBids(
   return ports;
 }
 
-void Separations::Tock() {}
+void Separations::AddBids_(cyclus::BidPortfolio<Material>::Ptr port,
+                           std::vector<Request<Material>*>& reqs,
+                           ResBufView<Material>& view) {
+  bool exclusive = false;
+  const std::deque<Material::Ptr>& mats = view.contents();
+
+  if (aggregate_bids) {
+    // a single bid per request for everything in the buffer - trades pop
+    // their quantity from the front of the buffer anyway.  The offer is
+    // reused for as long as the buffer is unchanged.
+    std::pair<unsigned long, Material::Ptr>& agg = agg_offers_[&view];
+    if (agg.second.get() == NULL || agg.first != view.version()) {
+      CompMap cm;
+      double qty = 0;
+      for (int k = 0; k < mats.size(); k++) {
+        CompMap c = mats[k]->comp()->mass();
+        cyclus::compmath::Normalize(&c, mats[k]->quantity());
+        CompMap::iterator it;
+        for (it = c.begin(); it != c.end(); ++it) {
+          cm[it->first] += it->second;
+        }
+        qty += mats[k]->quantity();
+      }
+      agg.first = view.version();
+      agg.second =
+          Material::CreateUntracked(qty, Composition::CreateFromMass(cm));
+    }
+    Material::Ptr offer = agg.second;
+    for (int j = 0; j < reqs.size(); j++) {
+      port->AddBid(reqs[j], offer, this, exclusive);
+    }
+    return;
+  }
+
+  for (int j = 0; j < reqs.size(); j++) {
+    Request<Material>* req = reqs[j];
+    double tot_bid = 0;
+    for (int k = 0; k < mats.size(); k++) {
+      Material::Ptr m = mats[k];
+      tot_bid += m->quantity();
+
+      // this fix the problem of the cyclus exchange manager which crashes
+      // when a bid with a quantity <=0 is offered.
+      if (m->quantity() > cyclus::eps_rsrc()) {
+        port->AddBid(req, m, this, exclusive);
+      }
+
+      if (tot_bid >= req->target()->quantity()) {
+        break;
+      }
+    }
+  }
+}
+
+void Separations::Tock() {
+  CYCAMORE_PERF_SCOPE("Tock");
+  if (leftover_compact_tol >= 0) {
+    leftover_view_.Compact(leftover_compact_tol);
+  }
+  if (stream_compact_tol >= 0) {
+    std::map<std::string, ResBuf<Material> >::iterator it;
+    for (it = streambufs.begin(); it != streambufs.end(); ++it) {
+      StreamView_(it->first).Compact(stream_compact_tol);
+    }
+  }
+  if (memory_.Due(context()->time())) {
+    memory_.Add("feed", feed);
+    memory_.Add("leftover", leftover);
+    std::map<std::string, ResBuf<Material> >::iterator it;
+    for (it = streambufs.begin(); it != streambufs.end(); ++it) {
+      memory_.Add(it->first, it->second);
+    }
+    memory_.Flush(this);
+  }
+  record_policy_.Flush(this);
+  events_.Flush(context());
+}
 
 bool Separations::CheckDecommissionCondition() {
   if (leftover.count() > 0) {
@@ -381,14 +682,9 @@ void Separations::RecordPosition() {
 }
 
 void Separations::Record(std::string name, double val, std::string type) {
-  context()
-      ->NewDatum("SeparationEvents")
-      ->AddVal("AgentId", id())
-      ->AddVal("Time", context()->time())
-      ->AddVal("Event", name)
-      ->AddVal("Value", val)
-      ->AddVal("Type", type)
-      ->Record();
+  if (record_policy_.RecordsEvents(context()->time())) {
+    events_.Add(id(), context()->time(), name, val, type);
+  }
 }
 
 extern "C" cyclus::Agent* ConstructSeparations(cyclus::Context* ctx) {
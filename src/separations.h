@@ -1,8 +1,20 @@
 #ifndef CYCAMORE_SRC_SEPARATIONS_H_
 #define CYCAMORE_SRC_SEPARATIONS_H_
 
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "res_buf_view.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -13,9 +25,127 @@ namespace cycamore {
 /// separations efficiency for that nuclide or element.  Note that this returns
 /// an untracked material that should only be used for its composition and qty
 /// - not in any real inventories, etc.
-cyclus::Material::Ptr SepMaterial(std::map<int, double> effs,
+cyclus::Material::Ptr SepMaterial(const std::map<int, double>& effs,
                                   cyclus::Material::Ptr mat);
 
+/// SepEffTable holds the efficiencies of a set of separations streams (in the
+/// same form as for SepMaterial) compiled into a dense table indexed by
+/// element with per-nuclide overrides, so that a feed composition can be split
+/// into all the streams in a single pass.  The cuts of the most recently
+/// separated compositions are kept in a least-recently-used cache keyed by
+/// composition id, so separating a known composition again costs one lookup.
+class SepEffTable {
+ public:
+  /// The part of a feed composition that is separated into a stream.
+  struct Cut {
+    Cut() : frac(0) {}
+
+    /// Returns the composition of the separated material - NULL if nothing
+    /// is separated.  The composition is only created on the first call, so
+    /// that computing cuts creates no compositions.
+    cyclus::Composition::Ptr comp() const {
+      if (comp_ == NULL && frac > 0) {
+        comp_ = cyclus::Composition::CreateFromMass(mass);
+      }
+      return comp_;
+    }
+
+    /// mass of each separated nuclide per unit mass of feed
+    cyclus::CompMap mass;
+    /// mass of separated material per unit mass of feed
+    double frac;
+
+   private:
+    mutable cyclus::Composition::Ptr comp_;
+  };
+
+  SepEffTable()
+      : nstreams_(0), effs_(new Effs()), cache_size_(1), hits_(0),
+        misses_(0) {}
+
+  /// Compiles the table for the given stream efficiencies, replacing any
+  /// previous contents and clearing the cache.  The compiled efficiencies
+  /// are immutable and shared by all tables initialized with the same
+  /// efficiencies (e.g. the clones of one Separations prototype), so they
+  /// are only built and held once.
+  void Init(const std::vector<std::map<int, double> >& effs);
+
+  /// Returns the number of streams in the table.
+  int size() const { return nstreams_; }
+
+  /// Returns whether this table shares its compiled efficiencies with other.
+  bool shares(const SepEffTable& other) const {
+    return effs_ == other.effs_;
+  }
+
+  /// Shares the compiled efficiencies of other, as if initialized with the
+  /// same efficiencies but without looking them up, and clears the cache.
+  void Share(const SepEffTable& other);
+
+  /// Sets the maximum number of compositions whose cuts are cached.  Zero
+  /// disables caching.
+  void cache_size(int n);
+  int cache_size() const { return cache_size_; }
+
+  /// Returns the number of compositions currently cached.
+  int cached() const { return lru_.size(); }
+
+  /// Returns the number of Separate calls served from and missing the cache.
+  unsigned long hits() const { return hits_; }
+  unsigned long misses() const { return misses_; }
+
+  /// Returns the cut of composition c for each stream, in the order the
+  /// streams were passed to Init.  The reference is valid until the next
+  /// call.
+  const std::vector<Cut>& Separate(cyclus::Composition::Ptr c);
+
+  /// Returns the cut of the (not necessarily normalized) mass composition m
+  /// for each stream, as above.  The cuts of compositions that are not
+  /// cyclus compositions are not cached.
+  const std::vector<Cut>& Separate(const cyclus::CompMap& m);
+
+ private:
+  typedef std::list<std::pair<int, std::vector<Cut> > > CutList;
+  typedef std::vector<std::map<int, double> > EffList;
+
+  /// Compiled stream efficiencies.
+  struct Effs {
+    // (element Z, stream) -> efficiency
+    std::vector<double> elem;
+    // nuclide -> efficiency per stream, for nuclides given explicitly
+    std::map<int, std::vector<double> > nucs;
+  };
+
+  /// Returns the compiled form of effs, shared with any other table using it.
+  static boost::shared_ptr<const Effs> Compile_(const EffList& effs);
+
+  /// Returns the per-stream efficiencies for nuc, with negative values for
+  /// streams that do not separate nuc at all.  Returns NULL if no stream does.
+  const double* Row_(int nuc) const;
+
+  /// Computes the cuts of the mass composition m into cuts.
+  void Compute_(const cyclus::CompMap& m, std::vector<Cut>* cuts) const;
+
+  /// Drops the least recently used entries beyond cache_size_.
+  void Evict_();
+
+  int nstreams_;
+  boost::shared_ptr<const Effs> effs_;
+
+  // most recently used first, with an index by composition id
+  int cache_size_;
+  CutList lru_;
+  std::map<int, CutList::iterator> lru_index_;
+  // holds the result when caching is disabled
+  std::vector<Cut> uncached_;
+  unsigned long hits_;
+  unsigned long misses_;
+
+  // compiled efficiencies in use, by the efficiencies they were compiled from
+  static std::map<EffList, boost::weak_ptr<const Effs> > compiled_;
+  static std::mutex mutex_;
+};
+
 /// Separations processes feed material into one or more streams containing
 /// specific elements and/or nuclides.  It uses mass-based efficiencies.
 ///
@@ -66,7 +196,42 @@ class Separations
 
   virtual std::string version() { return CYCAMORE_VERSION; }
 
+  /// The separations of one time step, as worked out by ComputeTick.
+  struct TickPlan {
+    TickPlan() : feed_qty(0), cuts(NULL), maxfrac(1) {}
+
+    /// feed to separate, zero if there is nothing to do
+    double feed_qty;
+    /// composition of the feed to separate if it is all one material, NULL
+    /// otherwise
+    cyclus::Composition::Ptr feed_comp;
+    /// mass composition of the feed to separate if it is a mix of materials
+    cyclus::CompMap feed_mass;
+    /// cut of the feed into each stream, in streams_ order, as held by the
+    /// facility's separations table
+    const std::vector<SepEffTable::Cut>* cuts;
+    /// fraction of the feed that fits into the stream buffers
+    double maxfrac;
+  };
+
+  /// Tick is ComputeTick followed by CommitTick.
   virtual void Tick();
+
+  /// Works out the time step's separations - the feed composition and its
+  /// split into the streams - without changing any inventories or recording
+  /// anything, so that a scheduler can compute the ticks of many facilities
+  /// in parallel.  Only this facility's own separations cache is updated.
+  /// No compositions are created - cyclus does not create them thread
+  /// safely - the plan only holds mass compositions, and the stream
+  /// compositions are created by CommitTick.
+  /// @return false if there is nothing to separate
+  bool ComputeTick(TickPlan* plan);
+
+  /// Applies a plan from ComputeTick of the current time step - moves the
+  /// feed into the streams and leftovers and records the results.  Nothing
+  /// else may change the inventories in between.
+  void CommitTick(const TickPlan& plan);
+
   virtual void Tock();
   virtual void EnterNotify();
 
@@ -87,9 +252,7 @@ class Separations
   virtual bool CheckDecommissionCondition();
 
   #pragma cyclus clone
-  #pragma cyclus initfromcopy
   #pragma cyclus infiletodb
-  #pragma cyclus initfromdb
   #pragma cyclus schema
   #pragma cyclus annotations
   #pragma cyclus snapshot
@@ -98,9 +261,17 @@ class Separations
   //
   //     #pragma cyclus snapshotinv
   //     #pragma cyclus initinv
+  //
+  // and in order to compile the separations table once per prototype and
+  // share it with the prototype's clones:
+  //
+  //     #pragma cyclus initfromcopy
+  //     #pragma cyclus initfromdb
 
   virtual cyclus::Inventories SnapshotInv();
   virtual void InitInv(cyclus::Inventories& inv);
+  virtual void InitFrom(Separations* m);
+  virtual void InitFrom(cyclus::QueryableBackend* b);
 
  private:
   #pragma cyclus var { \
@@ -177,6 +348,29 @@ class Separations
   }
   double leftoverbuf_size;
 
+  #pragma cyclus var { \
+    "doc" : "Adjacent leftover materials whose mass fractions all agree" \
+            " within this tolerance are merged into one material at the end" \
+            " of every time step, which reduces the number of leftover" \
+            " materials and bids. A negative value keeps every leftover" \
+            " material separate.", \
+    "uilabel": "Leftover Compaction Tolerance", \
+    "default": -1, \
+  }
+  double leftover_compact_tol;
+
+  #pragma cyclus var { \
+    "doc" : "Adjacent materials in a stream buffer whose mass fractions all" \
+            " agree within this tolerance are merged into one material at the" \
+            " end of every time step, so that long runs hold, snapshot and" \
+            " restart few materials. Unless aggregate_bids is set, this also" \
+            " means fewer and larger stream bids. A negative value keeps" \
+            " every stream material separate.", \
+    "uilabel": "Stream Compaction Tolerance", \
+    "default": -1, \
+  }
+  double stream_compact_tol;
+
  #pragma cyclus var { \
     "capacity" : "leftoverbuf_size", \
   }
@@ -206,6 +400,84 @@ class Separations
   // state var.
   std::map<std::string, cyclus::toolkit::ResBuf<cyclus::Material> > streambufs;
 
+  /// Returns the view of the named stream buffer, creating both if needed.
+  ResBufView<cyclus::Material>& StreamView_(const std::string& name);
+
+  // read-only access to the buffers without pop/push round trips - all
+  // pushes and pops of the feed, leftover and stream buffers go through these
+  ResBufView<cyclus::Material> feed_view_;
+  ResBufView<cyclus::Material> leftover_view_;
+
+  // SeparationEvents rows of the current time step, flushed at the end of
+  // the Tock
+  RecordBuffer<int, int, std::string, double, std::string> events_;
+  std::map<std::string, ResBufView<cyclus::Material> > stream_views_;
+
+  #pragma cyclus var { \
+    "default": 8, \
+    "uilabel": "Separations Cache Size", \
+    "doc": "Number of distinct feed compositions whose separated stream " \
+           "compositions are remembered. Feed usually comes from a few " \
+           "recipes, so a small cache avoids recomputing the same split every " \
+           "time step. Zero disables the cache.", \
+  }
+  int sep_cache_size;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Record Separations Cache", \
+    "doc": "If true, the cumulative hits and misses of the separations " \
+           "cache and its number of entries are recorded to the " \
+           "SeparationsCache table on each time step that separates feed " \
+           "and records events.", \
+  }
+  bool record_sep_cache;
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Aggregate Bids", \
+    "doc": "If true, the contents of each output buffer are offered as a " \
+           "single bid per request with the buffer's average composition, " \
+           "instead of up to one bid per stored material. This keeps the " \
+           "exchange small when many small batches are stored, at the cost " \
+           "of requesters only seeing the average composition.", \
+  }
+  bool aggregate_bids;
+
+  // efficiencies of streams_ (in map order), compiled when the prototype is
+  // initialized from the db and shared with its clones
+  SepEffTable sep_table_;
+
+  /// Compiles sep_table_ from streams_.
+  void CompileStreams_();
+
+  /// Records the cache statistics of sep_table_ to the output db if
+  /// record_sep_cache is set and events are recorded on this time step.
+  void RecordCache_();
+
+  /// Adds bids for the contents of view against each of reqs to port.
+  void AddBids_(cyclus::BidPortfolio<cyclus::Material>::Ptr port,
+                std::vector<cyclus::Request<cyclus::Material>*>& reqs,
+                ResBufView<cyclus::Material>& view);
+
+  // aggregated offer for each buffer view and the view's version it was made
+  // for, reused until the buffer changes. Rebuilt on first use, so there is
+  // no need to persist.
+  std::map<const ResBufView<cyclus::Material>*,
+           std::pair<unsigned long, cyclus::Material::Ptr> > agg_offers_;
+
+  #include "record_policy.cycpp.h"
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
+
   #pragma cyclus var { \
     "default": 0.0, \
     "uilabel": "Geographical latitude in degrees as a double", \
@@ -224,9 +496,23 @@ class Separations
 
   cyclus::toolkit::Position coordinates;
 
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
+  /// request targets shared between requests and time steps
+  UntrackedPool pool_;
+
   /// Records an agent's latitude and longitude to the output db
   void RecordPosition();
   void Record(std::string name, double val, std::string type);
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 }  // namespace cycamore
@@ -44,6 +44,148 @@ TEST(SeparationsTests, SepMaterial) {
 }
 
 
+TEST(SeparationsTests, SepEffTable) {
+  CompMap comp;
+  comp[id("U235")] = 10;
+  comp[id("U238")] = 90;
+  comp[id("Pu239")] = 1;
+  comp[id("Pu240")] = 2;
+  comp[id("Am241")] = 3;
+  comp[id("Am242")] = 2.8;
+  double qty = 100;
+  Composition::Ptr c = Composition::CreateFromMass(comp);
+  Material::Ptr mat = Material::CreateUntracked(qty, c);
+
+  std::vector<std::map<int, double> > effs(3);
+  effs[0][id("U")] = .7;
+  effs[0][id("Pu")] = .4;
+  effs[0][id("Am241")] = .4;
+  effs[1][id("Pu239")] = .5;
+  effs[1][id("Am")] = .9;
+  // a stream that separates nothing from this feed
+  effs[2][id("Cs")] = 1;
+
+  SepEffTable table;
+  table.Init(effs);
+  ASSERT_EQ(3, table.size());
+  const std::vector<SepEffTable::Cut>& cuts = table.Separate(c);
+  ASSERT_EQ(3, cuts.size());
+
+  for (int i = 0; i < 2; i++) {
+    Material::Ptr want = SepMaterial(effs[i], mat);
+    EXPECT_DOUBLE_EQ(want->quantity(), cuts[i].frac * qty);
+
+    Material::Ptr got = Material::CreateUntracked(cuts[i].frac * qty,
+                                                  cuts[i].comp());
+    MatQuery mqwant(want);
+    MatQuery mqgot(got);
+    CompMap::iterator it;
+    for (it = comp.begin(); it != comp.end(); ++it) {
+      EXPECT_NEAR(mqwant.mass(it->first), mqgot.mass(it->first), 1e-10)
+          << "stream " << i << ", nuclide " << it->first;
+    }
+  }
+  EXPECT_DOUBLE_EQ(0, cuts[2].frac);
+  EXPECT_TRUE(cuts[2].comp().get() == NULL);
+
+  // the cuts are reused for the same composition
+  Composition::Ptr prev = cuts[0].comp();
+  EXPECT_EQ(prev.get(), table.Separate(c)[0].comp().get());
+
+  // and are the same for the mass composition
+  std::vector<double> fracs;
+  for (int i = 0; i < 3; i++) {
+    fracs.push_back(cuts[i].frac);
+  }
+  const std::vector<SepEffTable::Cut>& masscuts = table.Separate(comp);
+  ASSERT_EQ(3, masscuts.size());
+  for (int i = 0; i < 3; i++) {
+    EXPECT_DOUBLE_EQ(fracs[i], masscuts[i].frac);
+  }
+}
+
+TEST(SeparationsTests, SepEffTableCache) {
+  CompMap comp;
+  comp[id("U235")] = 1;
+  comp[id("U238")] = 99;
+  Composition::Ptr c1 = Composition::CreateFromMass(comp);
+  comp[id("Pu239")] = 1;
+  Composition::Ptr c2 = Composition::CreateFromMass(comp);
+  comp[id("Pu240")] = 1;
+  Composition::Ptr c3 = Composition::CreateFromMass(comp);
+
+  std::vector<std::map<int, double> > effs(1);
+  effs[0][id("Pu")] = .9;
+
+  SepEffTable table;
+  table.Init(effs);
+  table.cache_size(2);
+
+  table.Separate(c1);
+  table.Separate(c2);
+  table.Separate(c1);
+  EXPECT_EQ(1ul, table.hits());
+  EXPECT_EQ(2ul, table.misses());
+  EXPECT_EQ(2, table.cached());
+
+  // c2 is the least recently used and gets evicted
+  table.Separate(c3);
+  table.Separate(c1);
+  table.Separate(c2);
+  EXPECT_EQ(2ul, table.hits());
+  EXPECT_EQ(4ul, table.misses());
+  EXPECT_EQ(2, table.cached());
+
+  table.cache_size(0);
+  EXPECT_EQ(0, table.cached());
+  EXPECT_DOUBLE_EQ(0, table.Separate(c1)[0].frac);
+  EXPECT_EQ(5ul, table.misses());
+}
+
+TEST(SeparationsTests, SepEffTableShared) {
+  CompMap comp;
+  comp[id("U238")] = 99;
+  comp[id("Pu239")] = 1;
+  Composition::Ptr c = Composition::CreateFromMass(comp);
+
+  std::vector<std::map<int, double> > effs(2);
+  effs[0][id("Pu")] = .9;
+  effs[1][id("U")] = .5;
+  std::vector<std::map<int, double> > other(effs);
+  other[1][id("U")] = .6;
+
+  // tables of the same efficiencies share them, but not their caches
+  SepEffTable t1;
+  SepEffTable t2;
+  SepEffTable t3;
+  t1.Init(effs);
+  t2.Init(effs);
+  t3.Init(other);
+  EXPECT_TRUE(t1.shares(t2));
+  EXPECT_FALSE(t1.shares(t3));
+
+  t1.Separate(c);
+  EXPECT_EQ(1, t1.cached());
+  EXPECT_EQ(0, t2.cached());
+  EXPECT_NEAR(.5 * .99, t2.Separate(c)[1].frac, 1e-12);
+  EXPECT_NEAR(.6 * .99, t3.Separate(c)[1].frac, 1e-12);
+
+  // reinitializing leaves the other tables alone
+  t2.Init(other);
+  EXPECT_TRUE(t2.shares(t3));
+  EXPECT_FALSE(t1.shares(t2));
+  EXPECT_NEAR(.5 * .99, t1.Separate(c)[1].frac, 1e-12);
+
+  // a table can share another's efficiencies without compiling them, as
+  // clones do with their prototype's table
+  SepEffTable t4;
+  t4.Share(t1);
+  EXPECT_TRUE(t4.shares(t1));
+  EXPECT_EQ(2, t4.size());
+  EXPECT_EQ(0, t4.cached());
+  EXPECT_NEAR(.5 * .99, t4.Separate(c)[1].frac, 1e-12);
+}
+
 // Check that cumulative separations efficiency for a single nuclide of less than or equal to one does not trigger an error.
 TEST(SeparationsTests, SeparationEfficiency) {
 
@@ -281,6 +423,107 @@ TEST(SeparationsTests, SepMixElemAndNuclide) {
   EXPECT_DOUBLE_EQ(0, mq.mass("Pu240"));
 }
 
+// the separations cache statistics are only recorded if asked for
+TEST(SeparationsTests, RecordSepCache) {
+  std::string config =
+      "<streams>"
+      "    <item>"
+      "        <commod>stream1</commod>"
+      "        <info>"
+      "            <buf_size>-1</buf_size>"
+      "            <efficiencies>"
+      "                <item><comp>U</comp> <eff>0.6</eff></item>"
+      "            </efficiencies>"
+      "        </info>"
+      "    </item>"
+      "</streams>"
+      ""
+      "<leftover_commod>waste</leftover_commod>"
+      "<throughput>100</throughput>"
+      "<feedbuf_size>100</feedbuf_size>"
+      "<feed_commods> <val>feed</val> </feed_commods>"
+     ;
+
+  CompMap m;
+  m[id("u235")] = 0.08;
+  m[id("u238")] = 0.9;
+  m[id("Pu239")] = .02;
+  Composition::Ptr c = Composition::CreateFromMass(m);
+
+  int simdur = 3;
+  cyclus::MockSim sim1(cyclus::AgentSpec(":cycamore:Separations"), config,
+                       simdur);
+  sim1.AddSource("feed").recipe("recipe1").Finalize();
+  sim1.AddRecipe("recipe1", c);
+  sim1.Run();
+  EXPECT_THROW(sim1.db().Query("SeparationsCache", NULL), std::exception);
+
+  // feed received on time step 0 is separated on time steps 1 and 2, once
+  // per time step
+  cyclus::MockSim sim2(cyclus::AgentSpec(":cycamore:Separations"),
+                       config + "<record_sep_cache>1</record_sep_cache>",
+                       simdur);
+  sim2.AddSource("feed").recipe("recipe1").Finalize();
+  sim2.AddRecipe("recipe1", c);
+  sim2.Run();
+  QueryResult qr = sim2.db().Query("SeparationsCache", NULL);
+  ASSERT_EQ(2, qr.rows.size());
+  for (int i = 0; i < 2; i++) {
+    EXPECT_EQ(i + 1, qr.GetVal<int>("Time", i));
+    EXPECT_EQ(i + 1, qr.GetVal<int>("Hits", i) + qr.GetVal<int>("Misses", i));
+  }
+}
+
+// aggregated bids offer the buffer's average composition, but the traded
+// material still comes from the buffer itself
+TEST(SeparationsTests, AggregateBids) {
+  std::string config =
+      "<streams>"
+      "    <item>"
+      "        <commod>stream1</commod>"
+      "        <info>"
+      "            <buf_size>-1</buf_size>"
+      "            <efficiencies>"
+      "                <item><comp>U</comp> <eff>0.6</eff></item>"
+      "                <item><comp>Pu239</comp> <eff>.7</eff></item>"
+      "            </efficiencies>"
+      "        </info>"
+      "    </item>"
+      "</streams>"
+      ""
+      "<leftover_commod>waste</leftover_commod>"
+      "<throughput>100</throughput>"
+      "<feedbuf_size>100</feedbuf_size>"
+      "<feed_commods> <val>feed</val> </feed_commods>"
+      "<aggregate_bids>1</aggregate_bids>"
+     ;
+
+  CompMap m;
+  m[id("u235")] = 0.08;
+  m[id("u238")] = 0.9;
+  m[id("Pu239")] = .01;
+  m[id("Pu240")] = .01;
+  Composition::Ptr c = Composition::CreateFromMass(m);
+
+  int simdur = 3;
+  cyclus::MockSim sim(cyclus::AgentSpec(":cycamore:Separations"), config, simdur);
+  sim.AddSource("feed").recipe("recipe1").Finalize();
+  sim.AddSink("stream1").capacity(100).Finalize();
+  sim.AddRecipe("recipe1", c);
+  int id = sim.Run();
+
+  std::vector<Cond> conds;
+  conds.push_back(Cond("SenderId", "==", id));
+  QueryResult qr = sim.db().Query("Transactions", &conds);
+  ASSERT_EQ(simdur - 1, qr.rows.size());
+  for (int i = 0; i < qr.rows.size(); i++) {
+    MatQuery mq(sim.GetMaterial(qr.GetVal<int>("ResourceId", i)));
+    EXPECT_DOUBLE_EQ(m[922350000]*0.6*100, mq.mass("U235"));
+    EXPECT_DOUBLE_EQ(m[942390000]*0.7*100, mq.mass("Pu239"));
+    EXPECT_DOUBLE_EQ(0, mq.mass("Pu240"));
+  }
+}
+
 TEST(SeparationsTests, Retire) {
   std::string config =
       "<streams>"
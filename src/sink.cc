@@ -12,6 +12,12 @@ namespace cycamore {
 Sink::Sink(cyclus::Context* ctx)
     : cyclus::Facility(ctx),
       capacity(std::numeric_limits<double>::max()),
+      compaction("none"),
+      compaction_interval(1),
+      summed_qty(0),
+      record_mode("all"),
+      record_interval(1),
+      memory_interval(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {
@@ -41,6 +47,9 @@ Sink::~Sink() {}
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sink::EnterNotify() {
   cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  memory_.Init(memory_interval);
 
   if (in_commod_prefs.size() == 0) {
     for (int i = 0; i < in_commods.size(); ++i) {
@@ -52,6 +61,20 @@ void Sink::EnterNotify() {
        << " values, expected " << in_commods.size();
     throw cyclus::ValueError(ss.str());
   }
+
+  if (compaction != "none" && compaction != "squash" && compaction != "sum") {
+    throw cyclus::ValueError("compaction must be one of 'none', 'squash' or "
+                             "'sum', got '" + compaction + "'");
+  } else if (compaction_interval < 1) {
+    std::stringstream ss;
+    ss << "compaction_interval must be at least 1, got "
+       << compaction_interval;
+    throw cyclus::ValueError(ss.str());
+  }
+
+  if (!recipe_name.empty()) {
+    request_comp_ = context()->GetRecipe(recipe_name);
+  }
   RecordPosition();
 }
 
@@ -78,22 +101,15 @@ std::string Sink::str() {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::RequestPortfolio<cyclus::Material>::Ptr>
 Sink::GetMatlRequests() {
+  CYCAMORE_PERF_SCOPE("GetMatlRequests");
   using cyclus::Material;
   using cyclus::RequestPortfolio;
   using cyclus::Request;
-  using cyclus::Composition;
 
   std::set<RequestPortfolio<Material>::Ptr> ports;
   RequestPortfolio<Material>::Ptr port(new RequestPortfolio<Material>());
   double amt = RequestAmt();
-  Material::Ptr mat;
-
-  if (recipe_name.empty()) {
-    mat = cyclus::NewBlankMaterial(amt);
-  } else {
-    Composition::Ptr rec = this->context()->GetRecipe(recipe_name);
-    mat = cyclus::Material::CreateUntracked(amt, rec);
-  }
+  Material::Ptr mat = RequestMat_(amt);
 
   if (amt > cyclus::eps()) {
     std::vector<Request<Material>*> mutuals;
@@ -107,6 +123,16 @@ Sink::GetMatlRequests() {
   return ports;
 }
 
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+cyclus::Material::Ptr Sink::RequestMat_(double amt) {
+  using cyclus::Material;
+
+  if (!recipe_name.empty() && request_comp_.get() == NULL) {
+    request_comp_ = context()->GetRecipe(recipe_name);
+  }
+  return pool_.Get(context()->time(), amt, request_comp_);
+}
+
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 std::set<cyclus::RequestPortfolio<cyclus::Product>::Ptr>
 Sink::GetGenRsrcRequests() {
@@ -140,6 +166,7 @@ Sink::GetGenRsrcRequests() {
 void Sink::AcceptMatlTrades(
     const std::vector< std::pair<cyclus::Trade<cyclus::Material>,
                                  cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("AcceptMatlTrades");
   std::vector< std::pair<cyclus::Trade<cyclus::Material>,
                          cyclus::Material::Ptr> >::const_iterator it;
   for (it = responses.begin(); it != responses.end(); ++it) {
@@ -160,10 +187,17 @@ void Sink::AcceptGenRsrcTrades(
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sink::Tick() {
+  CYCAMORE_PERF_SCOPE("Tick");
   using std::string;
   using std::vector;
   LOG(cyclus::LEV_INFO3, "SnkFac") << prototype() << " is ticking {";
 
+  // material summed away still counts against the inventory size
+  if (summed_qty > 0) {
+    inventory.capacity(std::max(inventory.quantity(),
+                                max_inv_size - summed_qty));
+  }
+
   double requestAmt = RequestAmt();
   // inform the simulation about what the sink facility will be requesting
   if (requestAmt > cyclus::eps()) {
@@ -172,8 +206,7 @@ void Sink::Tick() {
          commod++) {
       LOG(cyclus::LEV_INFO4, "SnkFac") << " will request " << requestAmt
                                        << " kg of " << *commod << ".";
-      cyclus::toolkit::RecordTimeSeries<double>("demand"+*commod, this,
-                                            requestAmt);
+      record_policy_.TimeSeries("demand"+*commod, this, requestAmt);
     }
   }
   LOG(cyclus::LEV_INFO3, "SnkFac") << "}";
@@ -181,19 +214,86 @@ void Sink::Tick() {
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Sink::Tock() {
+  CYCAMORE_PERF_SCOPE("Tock");
   LOG(cyclus::LEV_INFO3, "SnkFac") << prototype() << " is tocking {";
 
+  if (compaction != "none" && context()->time() % compaction_interval == 0) {
+    Compact();
+  }
+
   // On the tock, the sink facility doesn't really do much.
   // Maybe someday it will record things.
   // For now, lets just print out what we have at each timestep.
-  double total_material = inventory.quantity();
+  double total_material = InventorySize();
   LOG(cyclus::LEV_INFO4, "SnkFac") << "Sink " << this->id()
                                    << " is holding " << total_material
                                    << " units of material at the close of month "
                                    << context()->time() << ".";
   LOG(cyclus::LEV_INFO3, "SnkFac") << "}";
-  cyclus::toolkit::RecordTimeSeries<double>("SinkTotalMats", this,
-                                            total_material);
+  record_policy_.TimeSeries("SinkTotalMats", this, total_material);
+  if (memory_.Due(context()->time())) {
+    memory_.Add("inventory", inventory);
+    memory_.Flush(this);
+  }
+}
+
+// - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Sink::Compact() {
+  using cyclus::Material;
+  using cyclus::Product;
+  using cyclus::ResCast;
+
+  if (inventory.count() == 0 ||
+      (compaction == "squash" && inventory.count() == 1)) {
+    return;
+  }
+
+  std::vector<cyclus::Resource::Ptr> rs = inventory.PopN(inventory.count());
+  if (compaction == "sum") {
+    for (int i = 0; i < rs.size(); i++) {
+      if (rs[i]->type() == Material::kType) {
+        Material::Ptr m = ResCast<Material>(rs[i]);
+        cyclus::CompMap cm = m->comp()->mass();
+        cyclus::compmath::Normalize(&cm, m->quantity());
+        cyclus::CompMap::iterator it;
+        for (it = cm.begin(); it != cm.end(); ++it) {
+          summed_comp[it->first] += it->second;
+        }
+      }
+      summed_qty += rs[i]->quantity();
+    }
+    inventory.capacity(std::max(0.0, max_inv_size - summed_qty));
+    return;
+  }
+
+  // squash
+  Material::Ptr mat;
+  std::map<std::string, Product::Ptr> prods;
+  for (int i = 0; i < rs.size(); i++) {
+    if (rs[i]->type() == Material::kType) {
+      Material::Ptr m = ResCast<Material>(rs[i]);
+      if (mat.get() == NULL) {
+        mat = m;
+      } else {
+        mat->Absorb(m);
+      }
+    } else {
+      Product::Ptr p = ResCast<Product>(rs[i]);
+      Product::Ptr& prod = prods[p->quality()];
+      if (prod.get() == NULL) {
+        prod = p;
+      } else {
+        prod->Absorb(p);
+      }
+    }
+  }
+  if (mat.get() != NULL) {
+    inventory.Push(mat);
+  }
+  std::map<std::string, Product::Ptr>::iterator it;
+  for (it = prods.begin(); it != prods.end(); ++it) {
+    inventory.Push(it->second);
+  }
 }
 
 void Sink::RecordPosition() {
@@ -8,6 +8,9 @@
 
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -77,14 +80,36 @@ class Sink
   ///  @param size the storage size
   inline void SetMaxInventorySize(double size) {
     max_inv_size = size;
-    inventory.capacity(size);
+    inventory.capacity(std::max(0.0, size - summed_qty));
   }
 
   /// @return the maximum inventory storage size
-  inline double MaxInventorySize() const { return inventory.capacity(); }
+  inline double MaxInventorySize() const { return max_inv_size; }
 
   /// @return the current inventory storage size
-  inline double InventorySize() const { return inventory.quantity(); }
+  inline double InventorySize() const {
+    return inventory.quantity() + summed_qty;
+  }
+
+  /// @return the number of resource objects held in inventory
+  inline int InventoryCount() const { return inventory.count(); }
+
+  /// sets how and how often the inventory is compacted
+  /// @param mode one of "none", "squash" or "sum"
+  /// @param interval the number of time steps between compactions
+  inline void Compaction(std::string mode, int interval = 1) {
+    compaction = mode;
+    compaction_interval = interval;
+  }
+
+  /// @return the per-nuclide mass of material no longer held as objects in
+  /// "sum" compaction mode
+  inline const std::map<int, double>& SummedComp() const {
+    return summed_comp;
+  }
+
+  /// compacts the inventory according to the compaction mode
+  void Compact();
 
   /// determines the amount to request
   inline double RequestAmt() const {
@@ -154,6 +179,46 @@ class Sink
   #pragma cyclus var {'capacity': 'max_inv_size'}
   cyclus::toolkit::ResBuf<cyclus::Resource> inventory;
 
+  #pragma cyclus var {"default": "none", \
+                      "tooltip": "inventory compaction mode", \
+                      "uilabel": "Inventory Compaction", \
+                      "categorical": ["none", "squash", "sum"], \
+                      "doc": "How received resources are kept. 'none' keeps " \
+                             "every resource as received, 'squash' " \
+                             "periodically combines all materials (and all " \
+                             "products of the same quality) into one " \
+                             "resource, and 'sum' only keeps the total " \
+                             "quantity and per-nuclide mass of everything " \
+                             "received. Compaction bounds memory use for " \
+                             "long running sinks."}
+  std::string compaction;
+
+  #pragma cyclus var {"default": 1, \
+                      "tooltip": "time steps between compactions", \
+                      "uilabel": "Compaction Interval", \
+                      "units": "time steps", \
+                      "doc": "number of time steps between inventory " \
+                             "compactions if compaction is not 'none'"}
+  int compaction_interval;
+
+  /// quantity and per-nuclide mass of resources discarded in "sum" mode
+  #pragma cyclus var {"default": 0, "internal": True}
+  double summed_qty;
+  #pragma cyclus var {"default": {}, "internal": True}
+  std::map<int, double> summed_comp;
+
+  #include "record_policy.cycpp.h"
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
+
   #pragma cyclus var { \
     "default": 0.0, \
     "uilabel": "Geographical latitude in degrees as a double", \
@@ -172,7 +237,27 @@ class Sink
 
   cyclus::toolkit::Position coordinates;
 
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
+  /// the resolved request recipe, cached at EnterNotify
+  cyclus::Composition::Ptr request_comp_;
+
+  /// request targets, reused while the amount requested does not change
+  UntrackedPool pool_;
+
+  /// @return a request target of quantity amt
+  cyclus::Material::Ptr RequestMat_(double amt);
+
   void RecordPosition();
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 }  // namespace cycamore
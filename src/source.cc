@@ -1,5 +1,6 @@
 #include "source.h"
 
+#include <algorithm>
 #include <sstream>
 #include <limits>
 
@@ -9,8 +10,11 @@ namespace cycamore {
 
 Source::Source(cyclus::Context* ctx)
     : cyclus::Facility(ctx),
-      throughput(std::numeric_limits<double>::max()),
       inventory_size(std::numeric_limits<double>::max()),
+      throughput(std::numeric_limits<double>::max()),
+      max_bids(0),
+      record_mode("all"),
+      record_interval(1),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {}
@@ -31,6 +35,22 @@ void Source::InitFrom(cyclus::QueryableBackend* b) {
   RecordPosition();
 }
 
+void Source::EnterNotify() {
+  cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  if (!outrecipe.empty()) {
+    out_comp_ = context()->GetRecipe(outrecipe);
+  }
+}
+
+cyclus::Composition::Ptr Source::OutComp_() {
+  if (out_comp_.get() == NULL) {
+    out_comp_ = context()->GetRecipe(outrecipe);
+  }
+  return out_comp_;
+}
+
 std::string Source::str() {
   namespace tk = cyclus::toolkit;
   std::stringstream ss;
@@ -51,8 +71,15 @@ std::string Source::str() {
   return ss.str();
 }
 
+/// orders requests by descending preference
+static bool PrefGreater(cyclus::Request<cyclus::Material>* l,
+                        cyclus::Request<cyclus::Material>* r) {
+  return l->preference() > r->preference();
+}
+
 std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Source::GetMatlBids(
     cyclus::CommodMap<cyclus::Material>::type& commod_requests) {
+  CYCAMORE_PERF_SCOPE("GetMatlBids");
   using cyclus::Bid;
   using cyclus::BidPortfolio;
   using cyclus::CapacityConstraint;
@@ -60,8 +87,7 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Source::GetMatlBids(
   using cyclus::Request;
 
   double max_qty = std::min(throughput, inventory_size);
-  cyclus::toolkit::RecordTimeSeries<double>("supply"+outcommod, this,
-                                            max_qty);
+  record_policy_.Defer("supply"+outcommod, max_qty);
   LOG(cyclus::LEV_INFO3, "Source") << prototype() << " is bidding up to "
                                    << max_qty << " kg of " << outcommod;
   LOG(cyclus::LEV_INFO5, "Source") << "stats: " << str();
@@ -74,15 +100,23 @@ std::set<cyclus::BidPortfolio<cyclus::Material>::Ptr> Source::GetMatlBids(
   }
 
   BidPortfolio<Material>::Ptr port(new BidPortfolio<Material>());
-  std::vector<Request<Material>*>& requests = commod_requests[outcommod];
+  std::vector<Request<Material>*> requests = commod_requests[outcommod];
+  if (max_bids > 0 && requests.size() > max_bids) {
+    std::stable_sort(requests.begin(), requests.end(), PrefGreater);
+    requests.resize(max_bids);
+  }
   std::vector<Request<Material>*>::iterator it;
   for (it = requests.begin(); it != requests.end(); ++it) {
     Request<Material>* req = *it;
     Material::Ptr target = req->target();
     double qty = std::min(target->quantity(), max_qty);
-    Material::Ptr m = Material::CreateUntracked(qty, target->comp());
+    Material::Ptr m;
     if (!outrecipe.empty()) {
-      m = Material::CreateUntracked(qty, context()->GetRecipe(outrecipe));
+      m = pool_.Get(context()->time(), qty, OutComp_());
+    } else if (qty == target->quantity()) {
+      m = target;
+    } else {
+      m = pool_.Get(context()->time(), qty, target->comp());
     }
     port->AddBid(req, m, this);
   }
@@ -97,6 +131,7 @@ void Source::GetMatlTrades(
     const std::vector<cyclus::Trade<cyclus::Material> >& trades,
     std::vector<std::pair<cyclus::Trade<cyclus::Material>,
                           cyclus::Material::Ptr> >& responses) {
+  CYCAMORE_PERF_SCOPE("GetMatlTrades");
   using cyclus::Material;
   using cyclus::Trade;
 
@@ -107,7 +142,7 @@ void Source::GetMatlTrades(
 
     Material::Ptr response;
     if (!outrecipe.empty()) {
-      response = Material::Create(this, qty, context()->GetRecipe(outrecipe));
+      response = Material::Create(this, qty, OutComp_());
     } else {
       response = Material::Create(this, qty, it->request->target()->comp());
     }
@@ -117,6 +152,11 @@ void Source::GetMatlTrades(
   }
 }
 
+void Source::Tock() {
+  CYCAMORE_PERF_SCOPE("Tock");
+  record_policy_.Flush(this);
+}
+
 void Source::RecordPosition() {
   std::string specification = this->spec();
   context()
@@ -1,11 +1,15 @@
 #ifndef CYCAMORE_SRC_SOURCE_H_
 #define CYCAMORE_SRC_SOURCE_H_
 
+#include <map>
 #include <set>
 #include <vector>
 
 #include "cyclus.h"
 #include "cycamore_version.h"
+#include "perf.h"
+#include "recording.h"
+#include "untracked_pool.h"
 
 namespace cycamore {
 
@@ -57,9 +61,11 @@ class Source : public cyclus::Facility,
 
   virtual void InitFrom(cyclus::QueryableBackend* b);
 
+  virtual void EnterNotify();
+
   virtual void Tick() {};
 
-  virtual void Tock() {};
+  virtual void Tock();
 
   virtual std::string str();
 
@@ -116,6 +122,21 @@ class Source : public cyclus::Facility,
   }
   double throughput;
 
+  #pragma cyclus var { \
+    "default": 0, \
+    "tooltip": "maximum number of bids per time step", \
+    "uilabel": "Maximum Number of Bids", \
+    "doc": "If positive, the source only bids on this many requests each " \
+           "time step, those with the highest preferences (earlier requests " \
+           "win ties). This shrinks the exchange when many facilities " \
+           "request from few sources; as long as the source can fill every " \
+           "request it bids on, results are unchanged. Zero bids on every " \
+           "request.", \
+  }
+  int max_bids;
+
+  #include "record_policy.cycpp.h"
+
   #pragma cyclus var { \
     "default": 0.0, \
     "uilabel": "Geographical latitude in degrees as a double", \
@@ -134,7 +155,25 @@ class Source : public cyclus::Facility,
 
   cyclus::toolkit::Position coordinates;
 
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// the resolved outrecipe composition, cached at EnterNotify
+  cyclus::Composition::Ptr out_comp_;
+
+  /// offers, shared by all requests asking for the same quantity and
+  /// composition and kept for reuse in the next time step
+  UntrackedPool pool_;
+
+  /// @return the outrecipe composition
+  cyclus::Composition::Ptr OutComp_();
+
   void RecordPosition();
+
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
 };
 
 }  // namespace cycamore
@@ -80,6 +80,86 @@ TEST_F(SourceTest, AddBids) {
   EXPECT_EQ(*constrs.begin(), CapacityConstraint<Material>(capacity));
 }
 
+TEST_F(SourceTest, SharedOffers) {
+  using cyclus::BidPortfolio;
+  using cyclus::Material;
+
+  int nreqs = 3;
+  boost::shared_ptr< cyclus::ExchangeContext<Material> >
+      ec = GetContext(nreqs, commod);
+
+  std::set<BidPortfolio<Material>::Ptr> ports =
+      src_facility->GetMatlBids(ec.get()->commod_requests);
+  ASSERT_EQ(ports.size(), 1);
+  std::set<cyclus::Bid<Material>*> bids = (*ports.begin())->bids();
+  ASSERT_EQ(bids.size(), nreqs);
+
+  // every request asks for the same quantity, so one recipe offer backs them
+  Material::Ptr offer = (*bids.begin())->offer();
+  EXPECT_EQ(offer->comp(), recipe);
+  std::set<cyclus::Bid<Material>*>::iterator it;
+  for (it = bids.begin(); it != bids.end(); ++it) {
+    EXPECT_EQ((*it)->offer(), offer);
+  }
+
+  // and the offer is reused in the next time step
+  ports = src_facility->GetMatlBids(ec.get()->commod_requests);
+  bids = (*ports.begin())->bids();
+  EXPECT_EQ((*bids.begin())->offer(), offer);
+
+  // without a recipe, whole requests are offered their own targets
+  outrecipe(src_facility, "");
+  ports = src_facility->GetMatlBids(ec.get()->commod_requests);
+  bids = (*ports.begin())->bids();
+  for (it = bids.begin(); it != bids.end(); ++it) {
+    Material::Ptr target = (*it)->request()->target();
+    if (target->quantity() <= capacity) {
+      EXPECT_EQ((*it)->offer(), target);
+    } else {
+      EXPECT_EQ((*it)->offer()->comp(), target->comp());
+    }
+  }
+}
+
+TEST_F(SourceTest, MaxBids) {
+  using cyclus::BidPortfolio;
+  using cyclus::ExchangeContext;
+  using cyclus::Material;
+  using cyclus::Request;
+  using test_helpers::get_mat;
+
+  boost::shared_ptr< ExchangeContext<Material> >
+      ec(new ExchangeContext<Material>());
+  double prefs[] = {1, 4, 2, 4, 3};
+  std::vector<Request<Material>*> reqs;
+  for (int i = 0; i < 5; i++) {
+    reqs.push_back(Request<Material>::Create(get_mat(), trader, commod,
+                                             prefs[i]));
+    ec->AddRequest(reqs.back());
+  }
+
+  max_bids(src_facility, 3);
+  std::set<BidPortfolio<Material>::Ptr> ports =
+      src_facility->GetMatlBids(ec.get()->commod_requests);
+  ASSERT_EQ(ports.size(), 1);
+  std::set<cyclus::Bid<Material>*> bids = (*ports.begin())->bids();
+  ASSERT_EQ(bids.size(), 3);
+
+  std::set<Request<Material>*> bid_on;
+  std::set<cyclus::Bid<Material>*>::iterator it;
+  for (it = bids.begin(); it != bids.end(); ++it) {
+    bid_on.insert((*it)->request());
+  }
+  EXPECT_EQ(bid_on.count(reqs[1]), 1);
+  EXPECT_EQ(bid_on.count(reqs[3]), 1);
+  EXPECT_EQ(bid_on.count(reqs[4]), 1);
+
+  // more bids allowed than requests made
+  max_bids(src_facility, 10);
+  ports = src_facility->GetMatlBids(ec.get()->commod_requests);
+  EXPECT_EQ((*ports.begin())->bids().size(), 5);
+}
+
 TEST_F(SourceTest, Response) {
   using cyclus::Bid;
   using cyclus::Material;
@@ -153,6 +233,28 @@ TEST_F(SourceTest, Longitude) {
 
 }
 
+TEST_F(SourceTest, SupplyTimeSeries) {
+  std::string config =
+    "<outcommod>spent_fuel</outcommod>"
+    "<throughput>10</throughput>"
+  ;
+  int simdur = 3;
+  cyclus::MockSim sim(cyclus::AgentSpec (":cycamore:Source"), config, simdur);
+  sim.AddSink("spent_fuel").Finalize();
+  int id = sim.Run();
+
+  // the supply offered in the exchange is recorded in the source's tock
+  std::vector<cyclus::Cond> conds;
+  conds.push_back(cyclus::Cond("AgentId", "==", id));
+  cyclus::QueryResult qr =
+      sim.db().Query("TimeSeriessupplyspent_fuel", &conds);
+  ASSERT_EQ(simdur, qr.rows.size());
+  for (int i = 0; i < simdur; i++) {
+    EXPECT_EQ(i, qr.GetVal<int>("Time", i));
+    EXPECT_DOUBLE_EQ(10, qr.GetVal<double>("Value", i));
+  }
+}
+
 boost::shared_ptr< cyclus::ExchangeContext<cyclus::Material> >
 SourceTest::GetContext(int nreqs, std::string commod) {
   using cyclus::Material;
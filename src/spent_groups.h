@@ -0,0 +1,101 @@
+#ifndef CYCAMORE_SRC_SPENT_GROUPS_H_
+#define CYCAMORE_SRC_SPENT_GROUPS_H_
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "cyclus.h"
+#include "comp_converter.h"
+
+namespace cycamore {
+
+/// SpentGroups groups the spent assemblies a reactor offers on one commodity
+/// by composition, in order of each group's oldest assembly, and bids them in
+/// whole assemblies: one exclusive bid per request and group, for as many
+/// assemblies of the group as fit the request.  The offers of n assemblies of
+/// a group are shared between requests and, for as long as the groups are
+/// kept, time steps.  Owners rebuild their groups when their spent fuel
+/// changes and fill a trade with the assemblies of the offered composition;
+/// groups are not state.
+///
+///   SpentGroups g;
+///   for (int k = 0; k < mats.size(); k++) {
+///     g.Add(mats[k], 1);
+///   }
+///   g.AddBids(port, reqs, this, &bid_groups_);
+class SpentGroups {
+ public:
+  SpentGroups() : qty_(0) {}
+
+  /// adds material m, standing for n assemblies, to the group of its
+  /// composition
+  void Add(cyclus::Material::Ptr m, int n) {
+    cyclus::Composition::Ptr c = m->comp();
+    std::map<int, int>::iterator it = index_.find(c->id());
+    if (it == index_.end()) {
+      it = index_.insert(std::make_pair(c->id(), comps_.size())).first;
+      comps_.push_back(c);
+      counts_.push_back(0);
+      qtys_.push_back(0);
+    }
+    counts_[it->second] += n;
+    qtys_[it->second] += m->quantity();
+    qty_ += m->quantity();
+  }
+
+  /// @return the total quantity of all groups
+  double qty() const { return qty_; }
+
+  /// Adds the group bids of bidder for each of reqs to port and caps the bids
+  /// of each group at the quantity it holds - the portfolio's capacity alone
+  /// would let several requests be matched with more assemblies of a group
+  /// than it holds.
+  /// @param bid_groups maps each offer to the number of assemblies it stands
+  /// for
+  void AddBids(cyclus::BidPortfolio<cyclus::Material>::Ptr port,
+               std::vector<cyclus::Request<cyclus::Material>*>& reqs,
+               cyclus::Trader* bidder,
+               std::map<cyclus::Material*, int>* bid_groups) {
+    for (int j = 0; j < reqs.size(); j++) {
+      cyclus::Request<cyclus::Material>* req = reqs[j];
+      for (int c = 0; c < comps_.size(); c++) {
+        double per_assem = qtys_[c] / counts_[c];
+        int n = static_cast<int>(req->target()->quantity() / per_assem +
+                                 cyclus::eps_rsrc());
+        n = std::max(1, std::min(counts_[c], n));
+
+        cyclus::Material::Ptr& offer = offers_[std::make_pair(c, n)];
+        if (offer.get() == NULL) {
+          // a whole group is offered at exactly its capacity below
+          double qty = n == counts_[c] ? qtys_[c] : n * per_assem;
+          offer = cyclus::Material::CreateUntracked(qty, comps_[c]);
+        }
+        (*bid_groups)[offer.get()] = n;
+        port->AddBid(req, offer, bidder, true);
+      }
+    }
+
+    for (int c = 0; c < comps_.size(); c++) {
+      cyclus::Converter<cyclus::Material>::Ptr conv(
+          new CompConverter(comps_[c]));
+      port->AddConstraint(
+          cyclus::CapacityConstraint<cyclus::Material>(qtys_[c], conv));
+    }
+  }
+
+ private:
+  std::vector<cyclus::Composition::Ptr> comps_;
+  std::vector<int> counts_;
+  std::vector<double> qtys_;
+  // composition id -> group
+  std::map<int, int> index_;
+  // (group, number of assemblies) -> offer
+  std::map<std::pair<int, int>, cyclus::Material::Ptr> offers_;
+  double qty_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_SPENT_GROUPS_H_
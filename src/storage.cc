@@ -7,6 +7,10 @@ namespace cycamore {
 // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Storage::Storage(cyclus::Context* ctx)
     : cyclus::Facility(ctx),
+      ready_view_(&ready),
+      record_mode("all"),
+      record_interval(1),
+      memory_interval(0),
       latitude(0.0),
       longitude(0.0),
       coordinates(latitude, longitude) {
@@ -49,6 +53,9 @@ void Storage::InitFrom(cyclus::QueryableBackend* b) {
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Storage::EnterNotify() {
   cyclus::Facility::EnterNotify();
+  record_policy_.Init(record_mode, record_interval, &record_sums,
+                      &record_counts, &record_sum_intervals, &record_last);
+  memory_.Init(memory_interval);
   buy_policy.Init(this, &inventory, std::string("inventory"));
 
   // dummy comp, use in_recipe if provided
@@ -115,6 +122,7 @@ std::string Storage::str() {
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Storage::Tick() {
+  CYCAMORE_PERF_SCOPE("Tick");
   // Set available capacity for Buy Policy
   inventory.capacity(current_capacity());
 
@@ -124,8 +132,7 @@ void Storage::Tick() {
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Storage::Tock() {
-  using cyclus::toolkit::RecordTimeSeries;
-
+  CYCAMORE_PERF_SCOPE("Tock");
   BeginProcessing_();  // place unprocessed inventory into processing
 
   if (ready_time() >= 0 || residence_time == 0 && !inventory.empty()) {
@@ -138,12 +145,21 @@ void Storage::Tock() {
   std::vector<double>::iterator result;
   result = std::max_element(in_commod_prefs.begin(), in_commod_prefs.end());
   int maxindx = std::distance(in_commod_prefs.begin(), result);
-  cyclus::toolkit::RecordTimeSeries<double>("demand"+in_commods[maxindx], this,
-                                            current_capacity());
+  record_policy_.TimeSeries("demand"+in_commods[maxindx], this,
+                            current_capacity());
   // Multiple commodity tracking is not supported, user can only
   // provide one value for out_commods, despite it being a vector of strings.
-  cyclus::toolkit::RecordTimeSeries<double>("supply"+out_commods[0], this,
-                                            stocks.quantity());
+  record_policy_.TimeSeries("supply"+out_commods[0], this, stocks.quantity());
+
+  if (memory_.Due(context()->time())) {
+    memory_.Add("inventory", inventory);
+    memory_.Add("processing", processing);
+    memory_.Add("ready", ready);
+    memory_.Add("stocks", stocks);
+    memory_.Add("entry_times", entry_times);
+    memory_.Add("entry_counts", entry_counts);
+    memory_.Flush(this);
+  }
 }
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -166,18 +182,54 @@ void Storage::AddMat_(cyclus::Material::Ptr mat) {
 
 //- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 void Storage::BeginProcessing_() {
-  while (inventory.count() > 0) {
-    try {
-      processing.Push(inventory.Pop());
-      entry_times.push_back(context()->time());
+  if (inventory.count() == 0) {
+    return;
+  }
+  SyncEntries_();
 
-      LOG(cyclus::LEV_DEBUG2, "ComCnv")
-          << "Storage " << prototype()
-          << " added resources to processing at t= " << context()->time();
-    } catch (cyclus::Error& e) {
-      e.msg(Agent::InformErrorMsg(e.msg()));
-      throw e;
+  // without a residence time nothing has to wait, so material skips the
+  // processing buffer unless older material is still in there
+  bool direct = residence_time == 0 && processing.empty();
+
+  int n = 0;
+  try {
+    if (discrete_handling) {
+      n = inventory.count();
+      if (direct) {
+        ready_view_.Push(inventory.PopN(n));
+      } else {
+        processing.Push(inventory.PopN(n));
+      }
+    } else {
+      // batches may be combined, so everything arriving on the same time
+      // step is processed as one material
+      n = 1;
+      cyclus::Material::Ptr m =
+          inventory.Pop(inventory.quantity(), cyclus::eps_rsrc());
+      if (direct) {
+        ready_view_.Push(m);
+      } else {
+        processing.Push(m);
+      }
     }
+
+    LOG(cyclus::LEV_DEBUG2, "ComCnv")
+        << "Storage " << prototype()
+        << " added resources to processing at t= " << context()->time();
+  } catch (cyclus::Error& e) {
+    e.msg(Agent::InformErrorMsg(e.msg()));
+    throw e;
+  }
+
+  if (direct) {
+    return;
+  }
+  int t = context()->time();
+  if (!entry_times.empty() && entry_times.back() == t) {
+    entry_counts.back() += n;
+  } else {
+    entry_times.push_back(t);
+    entry_counts.push_back(n);
   }
 }
 
@@ -194,16 +246,23 @@ void Storage::ProcessMat_(double cap) {
 
       if (discrete_handling) {
         if (max_pop == ready.quantity()) {
-          stocks.Push(ready.PopN(ready.count()));
+          stocks.Push(ready_view_.PopN(ready.count()));
         } else {
-          double cap_pop = ready.Peek()->quantity();
-          while (cap_pop <= max_pop && !ready.empty()) {
-            stocks.Push(ready.Pop());
-            cap_pop += ready.empty() ? 0 : ready.Peek()->quantity();
+          // the oldest materials whose running total fits max_pop are moved
+          // as one block
+          const std::deque<Material::Ptr>& mats = ready_view_.contents();
+          int n = 0;
+          double cap_pop = 0;
+          while (n < mats.size() && cap_pop + mats[n]->quantity() <= max_pop) {
+            cap_pop += mats[n]->quantity();
+            n++;
+          }
+          if (n > 0) {
+            stocks.Push(ready_view_.PopN(n));
           }
         }
       } else {
-        stocks.Push(ready.Pop(max_pop, cyclus::eps_rsrc()));
+        stocks.Push(ready_view_.Pop(max_pop, cyclus::eps_rsrc()));
       }
 
       LOG(cyclus::LEV_INFO1, "ComCnv") << "Storage " << prototype()
@@ -221,14 +280,38 @@ void Storage::ProcessMat_(double cap) {
 void Storage::ReadyMatl_(int time) {
   using cyclus::toolkit::ResBuf;
 
+  SyncEntries_();
   int to_ready = 0;
 
   while (!entry_times.empty() && entry_times.front() <= time) {
+    to_ready += entry_counts.front();
     entry_times.pop_front();
-    ++to_ready;
+    entry_counts.pop_front();
   }
 
-  ready.Push(processing.PopN(to_ready));
+  if (to_ready > 0) {
+    ready_view_.Push(processing.PopN(to_ready));
+  }
+}
+
+//- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+void Storage::SyncEntries_() {
+  if (entry_counts.size() == entry_times.size()) {
+    return;
+  }
+
+  std::list<int> times;
+  entry_counts.clear();
+  std::list<int>::iterator it;
+  for (it = entry_times.begin(); it != entry_times.end(); ++it) {
+    if (!times.empty() && times.back() == *it) {
+      ++entry_counts.back();
+    } else {
+      times.push_back(*it);
+      entry_counts.push_back(1);
+    }
+  }
+  entry_times.swap(times);
 }
 
 void Storage::RecordPosition() {
@@ -7,7 +7,9 @@
 
 #include "cyclus.h"
 #include "cycamore_version.h"
-
+#include "perf.h"
+#include "recording.h"
+#include "res_buf_view.h"
 
 namespace cycamore {
 /// @class Storage
@@ -115,6 +117,10 @@ class Storage
   /// @param time the time of interest
   void ReadyMatl_(int time);
 
+  /// @brief regroups entry_times by time step if entry_counts is not in
+  /// step with it (i.e. entry_times has one entry per material)
+  void SyncEntries_();
+
     /* --- Storage Members --- */
 
   /// @brief current maximum amount that can be added to processing
@@ -210,20 +216,43 @@ class Storage
   #pragma cyclus var {"tooltip":"Buffer for material held for required residence_time"}
   cyclus::toolkit::ResBuf<cyclus::Material> ready;
 
-  //// list of input times for materials entering the processing buffer
+  //// list of input times for materials entering the processing buffer,
+  //// one entry per time step on which material entered
   #pragma cyclus var{"default": [],\
                       "internal": True}
   std::list<int> entry_times;
 
+  //// number of materials that entered the processing buffer at each of
+  //// entry_times
+  #pragma cyclus var{"default": [],\
+                      "internal": True}
+  std::list<int> entry_counts;
+
   #pragma cyclus var {"tooltip":"Buffer for material still waiting for required residence_time"}
   cyclus::toolkit::ResBuf<cyclus::Material> processing;
 
+  // read-only access to the ready buffer without pop/push round trips - all
+  // pushes and pops of ready go through this
+  ResBufView<cyclus::Material> ready_view_;
+
   //// A policy for requesting material
   cyclus::toolkit::MatlBuyPolicy buy_policy;
 
   //// A policy for sending material
   cyclus::toolkit::MatlSellPolicy sell_policy;
 
+  #include "record_policy.cycpp.h"
+
+  #pragma cyclus var { \
+    "default": 0, \
+    "uilabel": "Memory Report Interval", \
+    "units": "time steps", \
+    "doc": "Number of time steps between reports of the object counts and " \
+           "estimated bytes of the agent's buffers to the ArchetypeMemory " \
+           "table, or 0 for no reports.", \
+  }
+  int memory_interval;
+
   #pragma cyclus var { \
     "default": 0.0, \
     "uilabel": "Geographical latitude in degrees as a double", \
@@ -242,8 +271,19 @@ class Storage
 
   cyclus::toolkit::Position coordinates;
 
+  /// decides which time series and event rows are recorded
+  RecordPolicy record_policy_;
+
+  /// reports the buffer sizes to the ArchetypeMemory table
+  MemoryReport memory_;
+
   void RecordPosition();
 
+#ifdef CYCAMORE_PERF
+  /// time spent in each of the time step phases
+  PhaseTimers perf_;
+#endif
+
   friend class StorageTest;
 };
 
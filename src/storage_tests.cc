@@ -81,6 +81,18 @@ void StorageTest::TestCurrentCap(Storage* fac, double inv){
   EXPECT_EQ(inv, fac->current_capacity());
 }
 
+void StorageTest::TestEntries(Storage* fac, int n_buckets, int n_mats){
+
+  EXPECT_EQ(n_buckets, fac->entry_times.size());
+  EXPECT_EQ(n_buckets, fac->entry_counts.size());
+  EXPECT_EQ(n_mats, fac->processing.count());
+}
+
+void StorageTest::TestStockCount(Storage* fac, int n){
+
+  EXPECT_EQ(n, fac->stocks.count());
+}
+
 void StorageTest::TestReadyTime(Storage* fac, int t){
 
   EXPECT_EQ(t, fac->ready_time());
@@ -321,6 +333,60 @@ TEST_F(StorageTest, TwoBatchSameTime) {
   TestBuffers(src_facility_,0,0,0,0.4*cap);
 }
 
+TEST_F(StorageTest, BucketedEntries) {
+  double cap = throughput;
+  cyclus::Composition::Ptr rec = tc_.get()->GetRecipe(in_r1);
+
+  // continuous handling combines same time step arrivals
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(0.2*cap, rec));
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(0.2*cap, rec));
+  src_facility_->Tock();
+  TestEntries(src_facility_, 1, 1);
+
+  // discrete handling keeps every batch in the same time step bucket
+  discrete_handling = true;
+  SetUpStorage();
+  tc_.get()->time(1);
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(0.2*cap, rec));
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(0.2*cap, rec));
+  src_facility_->Tock();
+  TestEntries(src_facility_, 2, 3);
+  TestBuffers(src_facility_,0,0.8*cap,0,0);
+
+  // the first bucket is released on its own
+  tc_.get()->time(residence_time);
+  src_facility_->Tock();
+  TestEntries(src_facility_, 1, 2);
+  TestBuffers(src_facility_,0,0.4*cap,0,0.4*cap);
+
+  tc_.get()->time(residence_time+1);
+  src_facility_->Tock();
+  TestEntries(src_facility_, 0, 0);
+  TestBuffers(src_facility_,0,0,0,0.8*cap);
+}
+
+TEST_F(StorageTest, DiscreteRelease) {
+  // without residence time batches go straight to ready, and the oldest
+  // ones that fit the throughput are released together
+  residence_time = 0;
+  discrete_handling = true;
+  SetUpStorage();
+  cyclus::Composition::Ptr rec = tc_.get()->GetRecipe(in_r1);
+
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(6, rec));
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(8, rec));
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(10, rec));
+  src_facility_->Tock();
+  TestEntries(src_facility_, 0, 0);
+  TestBuffers(src_facility_,0,0,10,14);
+
+  tc_.get()->time(1);
+  TestAddMat(src_facility_, cyclus::Material::CreateUntracked(4, rec));
+  src_facility_->Tock();
+  TestBuffers(src_facility_,0,0,0,28);
+  TestStockCount(src_facility_, 4);
+}
+
 TEST_F(StorageTest,ChangeProcessTime){
   // Initialize process time variable and add first batch
   int proc_time1 = residence_time;
@@ -28,7 +28,9 @@ class StorageTest : public ::testing::Test {
       proc, double ready, double stocks);
   void TestStocks(cycamore::Storage* fac, cyclus::CompMap v);
   void TestReadyTime(cycamore::Storage* fac, int t);
+  void TestStockCount(cycamore::Storage* fac, int n);
   void TestCurrentCap(cycamore::Storage* fac, double inv);
+  void TestEntries(cycamore::Storage* fac, int n_buckets, int n_mats);
 
   std::vector<std::string> in_c1, out_c1;
   std::string in_r1;
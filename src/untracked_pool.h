@@ -0,0 +1,83 @@
+#ifndef CYCAMORE_SRC_UNTRACKED_POOL_H_
+#define CYCAMORE_SRC_UNTRACKED_POOL_H_
+
+#include <map>
+#include <utility>
+
+#include "cyclus.h"
+
+namespace cycamore {
+
+/// UntrackedPool hands out the untracked materials an archetype uses as
+/// request targets and bid offers.  These only carry a quantity and a
+/// composition and are never modified by the exchange, so one material can
+/// back every request or bid of the same quantity and composition - on the
+/// same time step and on the following ones.  A material that was not handed
+/// out on a time step is released on the next one, so the pool only keeps
+/// what is still in use.
+///
+/// Materials are matched by their exact quantity and composition object, so
+/// compositions should come from the context's recipes or another cache
+/// rather than being built for every call.  Code relying on distinct
+/// materials for distinct bids (e.g. keyed by the offer's address) should
+/// not use the pool.  Pools are not state.
+///
+///   Material::Ptr m = pool_.Get(context()->time(), qty, recipe);
+class UntrackedPool {
+ public:
+  UntrackedPool() : time_(-1) {}
+
+  /// @param t the current time step
+  /// @param qty the material's quantity
+  /// @param c the material's composition, a blank material is returned if
+  /// this is NULL
+  /// @return an untracked material of quantity qty and composition c
+  cyclus::Material::Ptr Get(int t, double qty,
+                            cyclus::Composition::Ptr c =
+                                cyclus::Composition::Ptr()) {
+    if (t != time_) {
+      prev_.swap(cur_);
+      cur_.clear();
+      time_ = t;
+    }
+
+    Key k(c.get(), qty);
+    std::map<Key, Entry>::iterator it = cur_.find(k);
+    if (it != cur_.end()) {
+      return it->second.mat;
+    }
+
+    Entry& e = cur_[k];
+    it = prev_.find(k);
+    if (it != prev_.end()) {
+      e = it->second;
+      prev_.erase(it);
+    } else {
+      e.comp = c;
+      e.mat = c.get() == NULL ? cyclus::NewBlankMaterial(qty) :
+              cyclus::Material::CreateUntracked(qty, c);
+    }
+    return e.mat;
+  }
+
+  /// @return the number of materials handed out on the last time step
+  int size() const { return cur_.size(); }
+
+ private:
+  typedef std::pair<const cyclus::Composition*, double> Key;
+
+  struct Entry {
+    // holds the composition so that its address is not reused while it is
+    // a key
+    cyclus::Composition::Ptr comp;
+    cyclus::Material::Ptr mat;
+  };
+
+  int time_;
+  std::map<Key, Entry> cur_;
+  std::map<Key, Entry> prev_;
+};
+
+}  // namespace cycamore
+
+#endif  // CYCAMORE_SRC_UNTRACKED_POOL_H_
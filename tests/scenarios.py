@@ -0,0 +1,338 @@
+#!/usr/bin/env python
+"""Generates cycamore scaling scenarios.
+
+Two topologies are available, each parameterized by the (approximate) number
+of facilities in the simulation:
+
+* ``recycle``: the ``input/recycle.xml`` fuel cycle - enrichment, reactors,
+  separations, fuel fabrication, a depleted uranium source and a repository -
+  with the reactor fleet and its support facilities scaled up together.
+* ``growth``: the ``input/growth/source_sink_linear.xml`` scenario - a
+  GrowthRegion with linearly growing demand met by a ManagerInst building
+  sources - with the demand scaled so that the fleet reaches the requested
+  size by the end of the simulation.
+
+Usage::
+
+    $ python scenarios.py recycle 1000 -o recycle_1000.xml
+    $ python scenarios.py growth 100 --duration 120
+"""
+from __future__ import print_function
+
+import argparse
+import sys
+
+TOPOLOGIES = ('recycle', 'growth')
+SCALES = (10, 100, 1000, 10000)
+
+# number of reactors served by each enrichment, separations and fuel
+# fabrication facility in the recycle topology
+REACTORS_PER_PLANT = 20
+
+# reactor cycle times used to keep a large fleet from refueling in lockstep
+CYCLE_TIMES = (16, 17, 18, 19)
+
+RECIPES = """
+  <recipe>
+    <name>natl_u</name>
+    <basis>mass</basis>
+    <nuclide> <id>U235</id> <comp>0.711</comp> </nuclide>
+    <nuclide> <id>U238</id> <comp>99.289</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>fresh_uox</name>
+    <basis>mass</basis>
+    <nuclide> <id>U235</id> <comp>0.04</comp> </nuclide>
+    <nuclide> <id>U238</id> <comp>0.96</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>depleted_u</name>
+    <basis>mass</basis>
+    <nuclide> <id>U235</id> <comp>0.003</comp> </nuclide>
+    <nuclide> <id>U238</id> <comp>0.997</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>fresh_mox</name>
+    <basis>mass</basis>
+    <nuclide> <id>U235</id>  <comp>0.0027381</comp> </nuclide>
+    <nuclide> <id>U238</id>  <comp>0.9099619</comp> </nuclide>
+    <nuclide> <id>Pu238</id> <comp>0.001746</comp> </nuclide>
+    <nuclide> <id>Pu239</id> <comp>0.045396</comp> </nuclide>
+    <nuclide> <id>Pu240</id> <comp>0.020952</comp> </nuclide>
+    <nuclide> <id>Pu241</id> <comp>0.013095</comp> </nuclide>
+    <nuclide> <id>Pu242</id> <comp>0.005238</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>spent_mox</name>
+    <basis>mass</basis>
+    <nuclide> <id>U235</id>  <comp>0.0017381</comp> </nuclide>
+    <nuclide> <id>U238</id>  <comp>0.90</comp> </nuclide>
+    <nuclide> <id>Pu238</id> <comp>0.001746</comp> </nuclide>
+    <nuclide> <id>Pu239</id> <comp>0.0134</comp> </nuclide>
+    <nuclide> <id>Pu240</id> <comp>0.020952</comp> </nuclide>
+    <nuclide> <id>Pu241</id> <comp>0.013095</comp> </nuclide>
+    <nuclide> <id>Pu242</id> <comp>0.005238</comp> </nuclide>
+  </recipe>
+
+  <recipe>
+    <name>spent_uox</name>
+    <basis>mass</basis>
+    <nuclide> <id>U235</id>  <comp>156.729</comp> </nuclide>
+    <nuclide> <id>U236</id>  <comp>102.103</comp> </nuclide>
+    <nuclide> <id>U238</id>  <comp>18280.324</comp> </nuclide>
+    <nuclide> <id>Np237</id> <comp>13.656</comp> </nuclide>
+    <nuclide> <id>Pu238</id> <comp>5.043</comp> </nuclide>
+    <nuclide> <id>Pu239</id> <comp>106.343</comp> </nuclide>
+    <nuclide> <id>Pu240</id> <comp>41.357</comp> </nuclide>
+    <nuclide> <id>Pu241</id> <comp>36.477</comp> </nuclide>
+    <nuclide> <id>Pu242</id> <comp>15.387</comp> </nuclide>
+    <nuclide> <id>Am241</id> <comp>1.234</comp> </nuclide>
+    <nuclide> <id>Am243</id> <comp>3.607</comp> </nuclide>
+    <nuclide> <id>Cm244</id> <comp>0.431</comp> </nuclide>
+    <nuclide> <id>Cm245</id> <comp>1.263</comp> </nuclide>
+  </recipe>
+"""
+
+
+def control(duration):
+    return """  <control>
+    <duration>{0}</duration>
+    <startmonth>1</startmonth>
+    <startyear>2000</startyear>
+  </control>
+""".format(duration)
+
+
+def archetypes(names):
+    specs = ''.join('    <spec><lib>{0}</lib><name>{1}</name></spec>\n'.format(
+                    *name.split(':')) for name in names)
+    return '  <archetypes>\n' + specs + '  </archetypes>\n'
+
+
+def facility(name, archetype, config):
+    return """
+  <facility>
+    <name>{0}</name>
+    <config>
+      <{1}>
+{2}
+      </{1}>
+    </config>
+  </facility>
+""".format(name, archetype, config.strip('\n'))
+
+
+def entries(counts):
+    return ''.join("""        <entry>
+          <prototype>{0}</prototype>
+          <number>{1}</number>
+        </entry>
+""".format(proto, n) for proto, n in counts if n > 0)
+
+
+def recycle(n, duration=600):
+    """Returns the recycle topology with about n facilities.  For every
+    REACTORS_PER_PLANT reactors there is one enrichment, separations and fuel
+    fabrication facility; there is a single repository and depleted uranium
+    source."""
+    nplants = max(1, n // (REACTORS_PER_PLANT + 3))
+    nreactors = max(1, n - 3 * nplants - 2)
+
+    facs = facility('enrichment', 'Enrichment', """
+        <feed_commod>natl_u</feed_commod>
+        <feed_recipe>natl_u</feed_recipe>
+        <product_commod>uox</product_commod>
+        <tails_assay>0.003</tails_assay>
+        <tails_commod>waste</tails_commod>
+        <swu_capacity>1e100</swu_capacity>
+        <initial_feed>1e100</initial_feed>
+""")
+    facs += facility('separations', 'Separations', """
+        <streams>
+          <item>
+            <commod>sep_stream</commod>
+            <info>
+              <buf_size>1e100</buf_size>
+              <efficiencies>
+                <item><comp>Pu</comp> <eff>.99</eff></item>
+              </efficiencies>
+            </info>
+          </item>
+        </streams>
+        <leftover_commod>waste</leftover_commod>
+        <throughput>{0}</throughput>
+        <feedbuf_size>{0}</feedbuf_size>
+        <feed_commods> <val>spent_uox</val> </feed_commods>
+        <feed_commod_prefs> <val>2.0</val> </feed_commod_prefs>
+""".format(30001 * REACTORS_PER_PLANT))
+    facs += facility('fuelfab', 'FuelFab', """
+        <fill_commods> <val>depleted_u</val> </fill_commods>
+        <fill_recipe>depleted_u</fill_recipe>
+        <fill_size>{0}</fill_size>
+        <fiss_commods> <val>sep_stream</val> </fiss_commods>
+        <fiss_size>{1}</fiss_size>
+        <spectrum>thermal</spectrum>
+        <outcommod>mox</outcommod>
+        <throughput>{0}</throughput>
+""".format(30001 * REACTORS_PER_PLANT, 15000 * REACTORS_PER_PLANT))
+    for cycle_time in CYCLE_TIMES:
+        facs += facility('reactor_{0}'.format(cycle_time), 'Reactor', """
+        <fuel_inrecipes>  <val>fresh_uox</val> <val>fresh_mox</val> </fuel_inrecipes>
+        <fuel_outrecipes> <val>spent_uox</val> <val>spent_mox</val> </fuel_outrecipes>
+        <fuel_incommods>  <val>uox</val>       <val>mox</val>       </fuel_incommods>
+        <fuel_outcommods> <val>spent_uox</val> <val>waste</val>     </fuel_outcommods>
+        <fuel_prefs>      <val>1.0</val>       <val>2.0</val>       </fuel_prefs>
+        <cycle_time>{0}</cycle_time>
+        <refuel_time>2</refuel_time>
+        <assem_size>30000</assem_size>
+        <n_assem_core>3</n_assem_core>
+        <n_assem_batch>1</n_assem_batch>
+""".format(cycle_time))
+    facs += facility('repo', 'Sink', """
+        <in_commods> <val>waste</val> </in_commods>
+        <capacity>1e100</capacity>
+""")
+    facs += facility('depleted_src', 'Source', """
+        <outcommod>depleted_u</outcommod>
+        <outrecipe>depleted_u</outrecipe>
+""")
+
+    counts = [('repo', 1), ('depleted_src', 1), ('enrichment', nplants),
+              ('separations', nplants), ('fuelfab', nplants)]
+    for i, cycle_time in enumerate(CYCLE_TIMES):
+        share = nreactors // len(CYCLE_TIMES)
+        if i < nreactors % len(CYCLE_TIMES):
+            share += 1
+        counts.append(('reactor_{0}'.format(cycle_time), share))
+
+    return """<!-- recycle topology with {n} facilities -->
+
+<simulation>
+{control}
+{archetypes}{facilities}
+  <region>
+    <name>SingleRegion</name>
+    <config><NullRegion/></config>
+    <institution>
+      <name>SingleInstitution</name>
+      <initialfacilitylist>
+{entries}      </initialfacilitylist>
+      <config><NullInst/></config>
+    </institution>
+  </region>
+{recipes}
+</simulation>
+""".format(n=n, control=control(duration),
+           archetypes=archetypes(['agents:NullInst', 'agents:NullRegion',
+                                  'cycamore:Source', 'cycamore:Sink',
+                                  'cycamore:Enrichment', 'cycamore:Reactor',
+                                  'cycamore:FuelFab', 'cycamore:Separations']),
+           facilities=facs, entries=entries(counts), recipes=RECIPES)
+
+
+def growth(n, duration=120):
+    """Returns the growth topology in which demand grows linearly to n units
+    of commodity, met by sources of unit throughput built by a ManagerInst,
+    so that the simulation ends with about n facilities."""
+    rate = float(n) / duration
+    facs = facility('Source', 'Source', """
+        <outcommod>commodity</outcommod>
+        <outrecipe>commod_recipe</outrecipe>
+        <throughput>1</throughput>
+""")
+    facs += facility('Sink', 'Sink', """
+        <in_commods> <val>commodity</val> </in_commods>
+""")
+
+    return """<!-- growth topology with {n} facilities -->
+
+<simulation>
+{control}
+{archetypes}{facilities}
+  <region>
+    <name>SingleRegion</name>
+    <config>
+      <GrowthRegion>
+        <growth>
+          <item>
+            <commod>commodity</commod>
+            <piecewise_function>
+              <piece>
+                <start>0</start>
+                <function>
+                  <type>linear</type>
+                  <params>{rate} 1</params>
+                </function>
+              </piece>
+            </piecewise_function>
+          </item>
+        </growth>
+      </GrowthRegion>
+    </config>
+    <institution>
+      <name>SingleInstitution</name>
+      <initialfacilitylist>
+{entries}      </initialfacilitylist>
+      <config>
+        <ManagerInst>
+          <prototypes>
+            <val>Sink</val>
+            <val>Source</val>
+          </prototypes>
+        </ManagerInst>
+      </config>
+    </institution>
+  </region>
+
+  <recipe>
+    <name>commod_recipe</name>
+    <basis>mass</basis>
+    <nuclide> <id>922350000</id> <comp>0.711</comp> </nuclide>
+    <nuclide> <id>922380000</id> <comp>99.289</comp> </nuclide>
+  </recipe>
+
+</simulation>
+""".format(n=n, control=control(duration),
+           archetypes=archetypes(['cycamore:Sink', 'cycamore:Source',
+                                  'cycamore:GrowthRegion',
+                                  'cycamore:ManagerInst']),
+           facilities=facs, entries=entries([('Sink', 1)]), rate=rate)
+
+
+def generate(topology, n, duration=None):
+    """Returns the input file text of the topology with about n facilities.
+    The duration (in time steps) defaults to that of the original scenario."""
+    if topology not in TOPOLOGIES:
+        raise ValueError('unknown topology {0!r}, expected one of {1}'.format(
+                         topology, ', '.join(TOPOLOGIES)))
+    if n < 1:
+        raise ValueError('number of facilities must be positive')
+    gen = recycle if topology == 'recycle' else growth
+    if duration is None:
+        return gen(n)
+    return gen(n, duration)
+
+
+def main(args=None):
+    p = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    p.add_argument('topology', choices=TOPOLOGIES)
+    p.add_argument('n', type=int, help='number of facilities')
+    p.add_argument('--duration', type=int, default=None,
+                   help='simulation duration in time steps')
+    p.add_argument('-o', '--output', default=None,
+                   help='output file, defaults to stdout')
+    ns = p.parse_args(args)
+    s = generate(ns.topology, ns.n, ns.duration)
+    if ns.output is None:
+        sys.stdout.write(s)
+    else:
+        with open(ns.output, 'w') as f:
+            f.write(s)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,63 @@
+import os
+import shutil
+import sqlite3
+import tempfile
+import xml.etree.ElementTree as ET
+
+from nose.tools import assert_equal, assert_true
+
+import scenarios
+import time_scenarios
+
+
+def initial_facilities(root):
+    return sum(int(e.find('number').text)
+               for e in root.iter('entry'))
+
+
+def check_recycle(n):
+    root = ET.fromstring(scenarios.generate('recycle', n))
+    assert_equal(n, initial_facilities(root))
+
+
+def check_growth(n):
+    root = ET.fromstring(scenarios.generate('growth', n, 100))
+    params = root.find('.//params').text.split()
+    # sources of unit throughput are built until demand reaches n
+    assert_true(abs(float(params[0]) * 100 - n) < 1e-9)
+    assert_equal('100', root.find('control/duration').text)
+
+
+def test_scenarios():
+    for n in scenarios.SCALES:
+        yield check_recycle, n
+        yield check_growth, n
+
+
+def test_rows_per_step():
+    tmp = tempfile.mkdtemp()
+    try:
+        db = os.path.join(tmp, 'out.sqlite')
+        conn = sqlite3.connect(db)
+        conn.execute('CREATE TABLE Resources (ResourceId INT, TimeCreated INT)')
+        conn.execute('CREATE TABLE TimeSeriesSupplyfuel '
+                     '(AgentId INT, Time INT, Value REAL)')
+        conn.execute('CREATE TABLE AgentEntry (AgentId INT, EnterTime INT)')
+        conn.executemany('INSERT INTO Resources VALUES (?, ?)',
+                         [(1, 0), (2, 0), (3, 1)])
+        conn.executemany('INSERT INTO TimeSeriesSupplyfuel VALUES (?, ?, ?)',
+                         [(1, 0, 1.0), (1, 1, 2.0)])
+        conn.execute('INSERT INTO AgentEntry VALUES (1, 0)')
+        conn.commit()
+        conn.close()
+
+        rows, per_step, phases = time_scenarios.table_rows(db)
+        assert_equal({'Resources': 3, 'TimeSeriesSupplyfuel': 2,
+                      'AgentEntry': 1}, rows)
+        # resources are counted by their creation time and time series
+        # tables are found by their prefix
+        assert_equal({'Resources': {0: 2, 1: 1},
+                      'TimeSeriesSupplyfuel': {0: 1, 1: 1}}, per_step)
+        assert_equal({}, phases)
+    finally:
+        shutil.rmtree(tmp)
@@ -0,0 +1,173 @@
+#!/usr/bin/env python
+"""Times cyclus runs of the scaling scenarios from scenarios.py.
+
+Each topology is generated and run at every requested scale, recording
+
+* the wall time of the run,
+* the peak resident set size of the cyclus process,
+* the size of the output database, its rows per table and the rows written
+  per time step for the time-indexed tables,
+* the seconds and calls per prototype and phase when cycamore was built with
+  CYCAMORE_PERF (the ArchetypePerf table).
+
+Results are printed as a table and, with ``--results``, appended to a JSON
+lines file together with the cyclus and cycamore versions, so that results of
+different releases can be compared.  Output databases are written as SQLite
+so that no extra Python packages are needed.
+
+Usage::
+
+    $ python time_scenarios.py
+    $ python time_scenarios.py -t recycle -n 10 100 --results timings.jsonl
+"""
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import shutil
+import sqlite3
+import subprocess
+import sys
+import tempfile
+import time
+
+import scenarios
+
+# the time column of the tables whose rows are indexed by time step, besides
+# the TimeSeries* tables, which are found by their prefix
+TIMED_TABLES = {'Transactions': 'Time', 'Resources': 'TimeCreated',
+                'ReactorEvents': 'Time', 'ReactorSideProducts': 'Time',
+                'Enrichments': 'Time', 'SeparationEvents': 'Time',
+                'ArchetypeMemory': 'Time'}
+TIME_SERIES_PREFIX = 'TimeSeries'
+
+
+def time_column(table):
+    """Returns the time column of a table, or None if its rows are not
+    indexed by time step."""
+    if table.startswith(TIME_SERIES_PREFIX):
+        return 'Time'
+    return TIMED_TABLES.get(table)
+
+
+def versions(cyclus):
+    """Returns the version lines reported by cyclus, e.g. for Cyclus and
+    Cycamore."""
+    s = subprocess.check_output([cyclus, '--version'], universal_newlines=True)
+    v = {}
+    for line in s.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0].rstrip(':') in ('Cyclus', 'Cycamore'):
+            v[parts[0].rstrip(':').lower()] = parts[1]
+    return v
+
+
+def table_rows(db):
+    """Returns the number of rows of each table, the rows written per time
+    step of the timed tables and the phase timings per prototype (if any) of
+    the SQLite output db."""
+    conn = sqlite3.connect(db)
+    try:
+        cur = conn.cursor()
+        names = [r[0] for r in cur.execute(
+                 "SELECT name FROM sqlite_master WHERE type='table'")]
+        rows = {}
+        per_step = {}
+        for name in names:
+            rows[name] = cur.execute(
+                'SELECT COUNT(*) FROM "{0}"'.format(name)).fetchone()[0]
+            col = time_column(name)
+            if col is not None:
+                per_step[name] = dict(cur.execute(
+                    'SELECT "{1}", COUNT(*) FROM "{0}" GROUP BY "{1}"'.format(
+                    name, col)))
+        phases = {}
+        if 'ArchetypePerf' in names:
+            for proto, phase, calls, secs in cur.execute(
+                    'SELECT Prototype, Phase, SUM(Calls), SUM(Seconds) '
+                    'FROM ArchetypePerf GROUP BY Prototype, Phase'):
+                phases.setdefault(proto, {})[phase] = {'calls': calls,
+                                                       'seconds': secs}
+        return rows, per_step, phases
+    finally:
+        conn.close()
+
+
+def run(cyclus, topology, n, duration=None, keep=None):
+    """Runs one scenario and returns its measurements."""
+    tmp = tempfile.mkdtemp()
+    try:
+        name = '{0}_{1}'.format(topology, n)
+        infile = os.path.join(tmp, name + '.xml')
+        outfile = os.path.join(tmp, name + '.sqlite')
+        with open(infile, 'w') as f:
+            f.write(scenarios.generate(topology, n, duration))
+
+        # the peak RSS of children is the maximum over all waited for
+        # children, so run each scenario in its own timing process
+        cmd = [sys.executable, '-c',
+               'import resource, subprocess, sys;'
+               'rtn = subprocess.call(sys.argv[1:]);'
+               'print(resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss);'
+               'sys.exit(rtn)',
+               cyclus, '-v0', '-o', outfile, infile]
+        start = time.time()
+        p = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                             universal_newlines=True)
+        out, _ = p.communicate()
+        wall = time.time() - start
+        if p.returncode != 0:
+            raise RuntimeError('cyclus failed on {0} with status {1}'.format(
+                               name, p.returncode))
+
+        # ru_maxrss is in kilobytes on linux and bytes on mac
+        maxrss = int(out.strip().splitlines()[-1])
+        if sys.platform == 'darwin':
+            maxrss //= 1024
+        rows, per_step, phases = table_rows(outfile)
+        if keep is not None:
+            shutil.copy(infile, keep)
+            shutil.copy(outfile, keep)
+        return {'topology': topology, 'n': n, 'wall_s': wall,
+                'peak_rss_kb': maxrss,
+                'output_bytes': os.path.getsize(outfile),
+                'rows': rows, 'rows_per_step': per_step, 'phases': phases}
+    finally:
+        shutil.rmtree(tmp)
+
+
+def main(args=None):
+    p = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    p.add_argument('-t', '--topologies', nargs='+',
+                   choices=scenarios.TOPOLOGIES, default=scenarios.TOPOLOGIES)
+    p.add_argument('-n', '--scales', nargs='+', type=int,
+                   default=scenarios.SCALES[:-1],
+                   help='numbers of facilities, defaults to %(default)s')
+    p.add_argument('--duration', type=int, default=None,
+                   help='simulation duration in time steps')
+    p.add_argument('--cyclus', default='cyclus', help='cyclus executable')
+    p.add_argument('--results', default=None,
+                   help='JSON lines file to append the results to')
+    p.add_argument('--keep', default=None,
+                   help='directory to keep the inputs and outputs in')
+    ns = p.parse_args(args)
+
+    info = versions(ns.cyclus)
+    info['date'] = time.strftime('%Y-%m-%dT%H:%M:%S')
+    print('{0:>8} {1:>7} {2:>10} {3:>12} {4:>12}'.format(
+          'topology', 'n', 'wall [s]', 'rss [MB]', 'output [MB]'))
+    for topology in ns.topologies:
+        for n in ns.scales:
+            r = run(ns.cyclus, topology, n, ns.duration, ns.keep)
+            print('{0:>8} {1:>7} {2:>10.2f} {3:>12.1f} {4:>12.1f}'.format(
+                  topology, n, r['wall_s'], r['peak_rss_kb'] / 1024.0,
+                  r['output_bytes'] / 1024.0 ** 2))
+            if ns.results is not None:
+                r.update(info)
+                with open(ns.results, 'a') as f:
+                    f.write(json.dumps(r, sort_keys=True) + '\n')
+
+
+if __name__ == '__main__':
+    main()